@@ -55,10 +55,16 @@ common:
 	# they can be specified here
 	ADDON_SOURCES = libs/dlib/all/source.cpp
 	ADDON_SOURCES += src/Tracker.h
+	ADDON_SOURCES += src/TrackingDistance.h
+	ADDON_SOURCES += src/TrackAssociation.h
 	ADDON_SOURCES += src/FaceTracker.cpp
 	ADDON_SOURCES += src/FaceTracker.h
 	ADDON_SOURCES += src/ObjectTracker.cpp
 	ADDON_SOURCES += src/ObjectTracker.h
+	ADDON_SOURCES += src/MultiStreamTracker.cpp
+	ADDON_SOURCES += src/MultiStreamTracker.h
+	ADDON_SOURCES += src/ImageDataset.cpp
+	ADDON_SOURCES += src/ImageDataset.h
 	ADDON_SOURCES += src/HOGtrainer.cpp
 	ADDON_SOURCES += src/HOGtrainer.h
 #	ADDON_SOURCES += src/ofxDLib.cpp
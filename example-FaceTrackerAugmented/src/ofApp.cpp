@@ -8,6 +8,7 @@ void FaceAugmented::setup(const Face & track) {
     smooth = cur;
     roi = track.rect;
     face = track;
+    all.clear();
 }
 
 void FaceAugmented::update(const Face & track) {
@@ -4,7 +4,7 @@
 #include "FaceTracker.h"
 
 namespace ofxDLib {
-    float trackingDistance(const Face& a, const Face& b) {
+    inline float trackingDistance(const Face& a, const Face& b) {
         ofVec3f aCenter = a.rect.getCenter();
         ofVec3f bCenter = b.rect.getCenter();
         return aCenter.distance(bCenter);
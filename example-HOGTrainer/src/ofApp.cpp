@@ -10,6 +10,7 @@ void ofApp::setup(){
 //--------------------------------------------------------------
 void ofApp::update(){
     ofSetWindowTitle(ofToString(ofGetFrameRate()));
+    HOG_trainer.update();
     
 }
 
@@ -22,6 +23,7 @@ void ofApp::draw(){
 void ofApp::keyPressed(int key){
     if(key == '1') HOG_trainer.nextTestImage(0);
     if(key == '2') HOG_trainer.nextTrainImage(0);
+    if(key == 'c') HOG_trainer.cancel();
 }
 
 //--------------------------------------------------------------
@@ -39,6 +39,9 @@ void ofApp::draw(){
 }
 //--------------------------------------------------------------
 void ofApp::keyPressed(int key){
+    if(key == 'c'){
+        ft.clear();
+    }
     
 }
 
@@ -68,7 +71,7 @@ void ofApp::mouseReleased(int x, int y, int button){
     endPoint = ofPoint(x,y);
     if(videoRect.inside(startPoint) == true && videoRect.inside(endPoint) == true){
         ofLog()<<"ofRectangle(startPoint,endPoint) "<<ofRectangle(startPoint,endPoint);
-        ft.setNewSelection(ofRectangle(startPoint,endPoint));
+        ft.addTarget(ofRectangle(startPoint,endPoint));
 
     }
     bSelecting = false;
@@ -8,6 +8,10 @@
 #include "../matrix.h"
 #include "../array2d.h"
 #include "../image_transforms/assign_image.h"
+#include "../pixel.h"
+#include "../array.h"
+#include <complex>
+#include <vector>
 
 
 namespace dlib
@@ -15,13 +19,35 @@ namespace dlib
 
 // ----------------------------------------------------------------------------------------
 
-    class correlation_tracker
+    template <
+        typename T
+        >
+    class basic_correlation_tracker
     {
     public:
 
-        correlation_tracker (
-        ) 
+        typedef T scalar_type;
+
+        explicit basic_correlation_tracker (
+            unsigned long filter_size = 6,
+            unsigned long num_scale_levels = 5,
+            unsigned long scale_window_size = 23
+        ) :
+            filter_size(1 << filter_size),
+            num_scale_levels(1 << num_scale_levels),
+            scale_window_size(scale_window_size)
         {
+            // make sure requires clause is not broken
+            DLIB_CASSERT(1 < filter_size && filter_size < 31 &&
+                         0 < num_scale_levels && num_scale_levels < 31 &&
+                         scale_window_size > 0,
+                "\t correlation_tracker::correlation_tracker()"
+                << "\n\t Invalid inputs were given to this function."
+                << "\n\t filter_size:       " << filter_size
+                << "\n\t num_scale_levels:  " << num_scale_levels
+                << "\n\t scale_window_size: " << scale_window_size
+            );
+
             // Create the cosine mask used for space filtering.
             mask = make_cosine_mask();
 
@@ -47,44 +73,29 @@ namespace dlib
                 << "\n\t You can't give an empty rectangle."
             );
 
-            B.set_size(0,0);
-
-            point_transform_affine tform = inv(make_chip(img, p, F));
-            for (unsigned long i = 0; i < F.size(); ++i)
-                fft_inplace(F[i]);
+            point_transform_affine tform = inv(make_chip(img, p, features));
+            fftr(features, F);
             make_target_location_image(tform(center(p)), G);
-            A.resize(F.size());
-            for (unsigned long i = 0; i < F.size(); ++i)
-            {
-                A[i] = pointwise_multiply(G, F[i]);
-                B += squared(real(F[i]))+squared(imag(F[i]));
-            }
+            train(G, F, A, B, 1);
 
             position = p;
 
             // now do the scale space stuff
             make_scale_space(img, Fs);
-            for (unsigned long i = 0; i < Fs.size(); ++i)
-                fft_inplace(Fs[i]);
+            fft_inplace(Fs);
             make_scale_target_location_image(get_num_scale_levels()/2, Gs);
-            Bs.set_size(0);
-            As.resize(Fs.size());
-            for (unsigned long i = 0; i < Fs.size(); ++i)
-            {
-                As[i] = pointwise_multiply(Gs, Fs[i]);
-                Bs += squared(real(Fs[i]))+squared(imag(Fs[i]));
-            }
+            train(Gs, Fs, As, Bs, 1);
         }
 
 
         unsigned long get_filter_size (
-        ) const { return 128/2; } // must be power of 2
+        ) const { return filter_size; }
 
         unsigned long get_num_scale_levels(
-        ) const { return 32; }  // must be power of 2
+        ) const { return num_scale_levels; }
 
         unsigned long get_scale_window_size (
-        ) const { return 23; }
+        ) const { return scale_window_size; }
 
         double get_regularizer_space (
         ) const { return 0.001; }
@@ -120,32 +131,28 @@ namespace dlib
             );
 
 
-            const point_transform_affine tform = make_chip(img, guess, F);
-            for (unsigned long i = 0; i < F.size(); ++i)
-                fft_inplace(F[i]);
+            const point_transform_affine tform = make_chip(img, guess, features);
+            fftr(features, F);
 
             // use the current filter to predict the object's location
-            G = 0; 
-            for (unsigned long i = 0; i < F.size(); ++i)
-                G += pointwise_multiply(F[i],conj(A[i]));
-            G = pointwise_multiply(G, reciprocal(B+get_regularizer_space()));
-            ifft_inplace(G);
-            const dlib::vector<double,2> pp = max_point_interpolated(real(G));
+            correlate(F, A, B, get_regularizer_space(), G);
+            ifftr(G, response);
+            const dlib::vector<double,2> pp = max_point_interpolated(response);
 
 
             // Compute the peak to side lobe ratio.
             const point p = pp;
             running_stats<double> rs;
             const rectangle peak = centered_rect(p, 8,8);
-            for (long r = 0; r < G.nr(); ++r)
+            for (long r = 0; r < response.nr(); ++r)
             {
-                for (long c = 0; c < G.nc(); ++c)
+                for (long c = 0; c < response.nc(); ++c)
                 {
                     if (!peak.contains(point(c,r)))
-                        rs.add(G(r,c).real());
+                        rs.add(response(r,c));
                 }
             }
-            const double psr = (G(p.y(),p.x()).real()-rs.mean())/rs.stddev();
+            const double psr = (response(p.y(),p.x())-rs.mean())/rs.stddev();
 
 
             // update the position of the object
@@ -153,23 +160,14 @@ namespace dlib
 
             // now update the position filters
             make_target_location_image(pp, G);
-            B *= (1-get_nu_space());
-            for (unsigned long i = 0; i < F.size(); ++i)
-            {
-                A[i] = get_nu_space()*pointwise_multiply(G, F[i]) + (1-get_nu_space())*A[i];
-                B += get_nu_space()*(squared(real(F[i]))+squared(imag(F[i])));
-            }
+            train(G, F, A, B, get_nu_space());
 
 
 
             // Now predict the scale change
             make_scale_space(img, Fs);
-            for (unsigned long i = 0; i < Fs.size(); ++i)
-                fft_inplace(Fs[i]);
-            Gs = 0;
-            for (unsigned long i = 0; i < Fs.size(); ++i)
-                Gs += pointwise_multiply(Fs[i],conj(As[i]));
-            Gs = pointwise_multiply(Gs, reciprocal(Bs+get_regularizer_scale()));
+            fft_inplace(Fs);
+            correlate(Fs, As, Bs, get_regularizer_scale(), Gs);
             ifft_inplace(Gs);
             const double pos = max_point_interpolated(real(Gs)).y();
 
@@ -180,12 +178,7 @@ namespace dlib
 
             // Now update the scale filters
             make_scale_target_location_image(pos, Gs);
-            Bs *= (1-get_nu_scale());
-            for (unsigned long i = 0; i < Fs.size(); ++i)
-            {
-                As[i] = get_nu_scale()*pointwise_multiply(Gs, Fs[i]) + (1-get_nu_scale())*As[i];
-                Bs += get_nu_scale()*(squared(real(Fs[i]))+squared(imag(Fs[i])));
-            }
+            train(Gs, Fs, As, Bs, get_nu_scale());
 
 
             return psr;
@@ -201,88 +194,259 @@ namespace dlib
 
     private:
 
+        typedef std::complex<T> ctype;
+
+        template <long NR, long NC>
+        static void correlate (
+            const std::vector<matrix<ctype,NR,NC> >& f,
+            const std::vector<matrix<ctype,NR,NC> >& a,
+            const matrix<T,NR,NC>& b,
+            const double regularizer,
+            matrix<ctype,NR,NC>& g
+        )
+        /*!
+            ensures
+                - #g == pointwise_multiply(sum of pointwise_multiply(f[i],conj(a[i])),
+                  reciprocal(b+regularizer))
+                - The complex products are written out on the interleaved real/imaginary
+                  parts so these loops vectorize and no temporaries are created.
+        !*/
+        {
+            g.set_size(b.nr(), b.nc());
+            const long n = b.size();
+            T* gp = reinterpret_cast<T*>(&g(0,0));
+            for (unsigned long i = 0; i < f.size(); ++i)
+            {
+                const T* fp = reinterpret_cast<const T*>(&f[i](0,0));
+                const T* ap = reinterpret_cast<const T*>(&a[i](0,0));
+                // The first channel initializes g rather than adding to it, so there is no
+                // zero fill and no branch in the inner loops.
+                if (i == 0)
+                {
+                    for (long k = 0; k < n; ++k)
+                    {
+                        const T fr = fp[2*k], fi = fp[2*k+1];
+                        const T ar = ap[2*k], ai = ap[2*k+1];
+                        gp[2*k]   = fr*ar + fi*ai;
+                        gp[2*k+1] = fi*ar - fr*ai;
+                    }
+                }
+                else
+                {
+                    for (long k = 0; k < n; ++k)
+                    {
+                        const T fr = fp[2*k], fi = fp[2*k+1];
+                        const T ar = ap[2*k], ai = ap[2*k+1];
+                        gp[2*k]   += fr*ar + fi*ai;
+                        gp[2*k+1] += fi*ar - fr*ai;
+                    }
+                }
+            }
+            const T* bp = &b(0,0);
+            const T reg = regularizer;
+            for (long k = 0; k < n; ++k)
+            {
+                const T s = 1/(bp[k]+reg);
+                gp[2*k]   *= s;
+                gp[2*k+1] *= s;
+            }
+        }
+
+        template <long NR, long NC>
+        static void train (
+            const matrix<ctype,NR,NC>& g,
+            const std::vector<matrix<ctype,NR,NC> >& f,
+            std::vector<matrix<ctype,NR,NC> >& a,
+            matrix<T,NR,NC>& b,
+            const double nu
+        )
+        /*!
+            ensures
+                - if (nu == 1) then
+                    - #a[i] == pointwise_multiply(g, f[i])
+                    - #b == sum of squared(real(f[i]))+squared(imag(f[i]))
+                - else
+                    - #a[i] == nu*pointwise_multiply(g, f[i]) + (1-nu)*a[i]
+                    - #b == (1-nu)*b + nu*(sum of squared(real(f[i]))+squared(imag(f[i])))
+                - Each channel is visited once and a[i] and b are updated in the same pass.
+        !*/
+        {
+            const bool reset = (nu == 1);
+            const T rate = nu;
+            const T keep = 1-nu;
+            if (reset)
+            {
+                a.resize(f.size());
+                for (unsigned long i = 0; i < a.size(); ++i)
+                    a[i].set_size(g.nr(), g.nc());
+                b.set_size(g.nr(), g.nc());
+            }
+            const long n = g.size();
+            const T* gp = reinterpret_cast<const T*>(&g(0,0));
+            T* bp = &b(0,0);
+            // Whether the filter is reset and whether this is the first channel, which
+            // initializes or decays b, are decided once per channel so each inner loop is
+            // straight line code the compiler can vectorize.
+            for (unsigned long i = 0; i < f.size(); ++i)
+            {
+                const T* fp = reinterpret_cast<const T*>(&f[i](0,0));
+                T* ap = reinterpret_cast<T*>(&a[i](0,0));
+                if (reset && i == 0)
+                {
+                    for (long k = 0; k < n; ++k)
+                    {
+                        const T fr = fp[2*k], fi = fp[2*k+1];
+                        const T gr = gp[2*k], gi = gp[2*k+1];
+                        ap[2*k]   = gr*fr - gi*fi;
+                        ap[2*k+1] = gr*fi + gi*fr;
+                        bp[k] = fr*fr + fi*fi;
+                    }
+                }
+                else if (reset)
+                {
+                    for (long k = 0; k < n; ++k)
+                    {
+                        const T fr = fp[2*k], fi = fp[2*k+1];
+                        const T gr = gp[2*k], gi = gp[2*k+1];
+                        ap[2*k]   = gr*fr - gi*fi;
+                        ap[2*k+1] = gr*fi + gi*fr;
+                        bp[k] = bp[k] + (fr*fr + fi*fi);
+                    }
+                }
+                else if (i == 0)
+                {
+                    for (long k = 0; k < n; ++k)
+                    {
+                        const T fr = fp[2*k], fi = fp[2*k+1];
+                        const T gr = gp[2*k], gi = gp[2*k+1];
+                        ap[2*k]   = rate*(gr*fr - gi*fi) + keep*ap[2*k];
+                        ap[2*k+1] = rate*(gr*fi + gi*fr) + keep*ap[2*k+1];
+                        bp[k] = bp[k]*keep + rate*(fr*fr + fi*fi);
+                    }
+                }
+                else
+                {
+                    for (long k = 0; k < n; ++k)
+                    {
+                        const T fr = fp[2*k], fi = fp[2*k+1];
+                        const T gr = gp[2*k], gi = gp[2*k+1];
+                        ap[2*k]   = rate*(gr*fr - gi*fi) + keep*ap[2*k];
+                        ap[2*k+1] = rate*(gr*fi + gi*fr) + keep*ap[2*k+1];
+                        bp[k] = bp[k] + rate*(fr*fr + fi*fi);
+                    }
+                }
+            }
+        }
+
+        template <typename pixel_type>
+        struct chip_buffers
+        {
+            array2d<pixel_type> space;
+            array2d<pixel_type> scale;
+        };
+
+        struct scratch_space
+        {
+            /*!
+                WHAT THIS OBJECT REPRESENTS
+                    The images used while computing the features of a frame.  array2d
+                    isn't copyable, and none of this is state anyway, so copying a
+                    tracker gives the copy its own empty scratch_space.
+            !*/
+            scratch_space() {}
+            scratch_space(const scratch_space&) {}
+            scratch_space& operator=(const scratch_space&) { return *this; }
+
+            dlib::array<array2d<float> > hog, scale_hog;
+            chip_buffers<unsigned char> gray_chips;
+            chip_buffers<rgb_pixel> rgb_chips;
+        };
+
+        // The common pixel types get chip buffers that live as long as the tracker so
+        // tracking a video doesn't allocate new images on every frame.
+        chip_buffers<unsigned char>& get_chip_buffers (chip_buffers<unsigned char>&) { return scratch.gray_chips; }
+        chip_buffers<rgb_pixel>& get_chip_buffers (chip_buffers<rgb_pixel>&) { return scratch.rgb_chips; }
+        template <typename pixel_type>
+        chip_buffers<pixel_type>& get_chip_buffers (chip_buffers<pixel_type>& local) { return local; }
+
         template <typename image_type>
         void make_scale_space(
             const image_type& img,
-            std::vector<matrix<std::complex<double>,0,1> >& Fs
-        ) const
+            std::vector<matrix<ctype,0,1> >& Fs
+        )
         {
             typedef typename image_traits<image_type>::pixel_type pixel_type;
+            chip_buffers<pixel_type> local;
+            array2d<pixel_type>& chip = get_chip_buffers(local).scale;
+            dlib::array<array2d<float> >& scale_hog = scratch.scale_hog;
 
-            // Make an image pyramid and put it into the chips array.
+            // Pull each level of the image pyramid into chip, extract its HOG features
+            // and copy them straight into the Fs outputs while applying the cosine
+            // windowing.
             const long chip_size = get_scale_window_size();
+            chip.set_size(chip_size, chip_size);
             drectangle ppp = position*std::pow(get_scale_pyramid_alpha(), -(double)get_num_scale_levels()/2);
-            dlib::array<array2d<pixel_type> > chips;
             std::vector<dlib::vector<double,2> > from_points, to_points;
             from_points.push_back(point(0,0));
             from_points.push_back(point(chip_size-1,0));
             from_points.push_back(point(chip_size-1,chip_size-1));
-            for (unsigned long i = 0; i < get_num_scale_levels(); ++i)
+            for (unsigned long k = 0; k < get_num_scale_levels(); ++k)
             {
-                array2d<pixel_type> chip(chip_size,chip_size);
-
                 // pull box into chip
                 to_points.clear();
                 to_points.push_back(ppp.tl_corner());
                 to_points.push_back(ppp.tr_corner());
                 to_points.push_back(ppp.br_corner());
                 transform_image(img,chip,interpolate_bilinear(),find_affine_transform(from_points, to_points));
-
-                chips.push_back(chip);
                 ppp *= get_scale_pyramid_alpha();
-            }
 
+                extract_fhog_features(chip, scale_hog, 4);
+                scale_hog.resize(32);
+                assign_image(scale_hog[31], chip);
+                assign_image(scale_hog[31], mat(scale_hog[31])/255.0);
 
-            // extract HOG for each chip
-            dlib::array<dlib::array<array2d<float> > > hogs(chips.size());
-            for (unsigned long i = 0; i < chips.size(); ++i)
-            {
-                extract_fhog_features(chips[i], hogs[i], 4);
-                hogs[i].resize(32);
-                assign_image(hogs[i][31], chips[i]);
-                assign_image(hogs[i][31], mat(hogs[i][31])/255.0);
-            }
+                if (k == 0)
+                {
+                    Fs.resize(scale_hog.size()*scale_hog[0].size());
+                    for (unsigned long i = 0; i < Fs.size(); ++i)
+                        Fs[i].set_size(get_num_scale_levels());
+                }
 
-            // Now copy the hog features into the Fs outputs and also apply the cosine
-            // windowing.
-            Fs.resize(hogs[0].size()*hogs[0][0].size());
-            unsigned long i = 0; 
-            for (long r = 0; r < hogs[0][0].nr(); ++r)
-            {
-                for (long c = 0; c < hogs[0][0].nc(); ++c)
+                unsigned long i = 0; 
+                for (long r = 0; r < scale_hog[0].nr(); ++r)
                 {
-                    for (unsigned long j = 0; j < hogs[0].size(); ++j)
+                    for (long c = 0; c < scale_hog[0].nc(); ++c)
                     {
-                        Fs[i].set_size(hogs.size());
-                        for (unsigned long k = 0; k < hogs.size(); ++k)
+                        for (unsigned long j = 0; j < scale_hog.size(); ++j)
                         {
-                            Fs[i](k) = hogs[k][j][r][c]*scale_cos_mask[k];
+                            Fs[i](k) = scale_hog[j][r][c]*scale_cos_mask[k];
+                            ++i;
                         }
-                        ++i;
                     }
-                }
-            } 
+                } 
+            }
         }
 
         template <typename image_type>
         point_transform_affine make_chip (
             const image_type& img,
             drectangle p,
-            std::vector<matrix<std::complex<double> > >& chip
-        ) const
+            std::vector<matrix<T> >& chip
+        )
         {
             typedef typename image_traits<image_type>::pixel_type pixel_type;
-            array2d<pixel_type> temp;
+            chip_buffers<pixel_type> local;
+            array2d<pixel_type>& temp = get_chip_buffers(local).space;
+            dlib::array<array2d<float> >& hog = scratch.hog;
             const double padding = 1.4;
             const chip_details details(p*padding, chip_dims(get_filter_size(), get_filter_size()));
             extract_image_chip(img, details, temp);
 
 
             chip.resize(32);
-            dlib::array<array2d<float> > hog;
             extract_fhog_features(temp, hog, 1, 3,3 );
             for (unsigned long i = 0; i < hog.size(); ++i)
-                assign_image(chip[i], pointwise_multiply(matrix_cast<double>(mat(hog[i])), mask));
+                assign_image(chip[i], pointwise_multiply(matrix_cast<T>(mat(hog[i])), mask));
 
             assign_image(chip[31], temp);
             assign_image(chip[31], pointwise_multiply(mat(chip[31]), mask)/255.0);
@@ -292,28 +456,31 @@ namespace dlib
 
         void make_target_location_image (
             const dlib::vector<double,2>& p,
-            matrix<std::complex<double> >& g
-        ) const
+            matrix<ctype>& g
+        )
         {
-            g.set_size(get_filter_size(), get_filter_size());
-            g = 0;
-            rectangle area = centered_rect(p, 21,21).intersect(get_rect(g));
+            // The target image is real so, like the features, only half of its
+            // spectrum is kept.
+            matrix<T>& temp = response;
+            temp.set_size(get_filter_size(), get_filter_size());
+            temp = 0;
+            rectangle area = centered_rect(p, 21,21).intersect(get_rect(temp));
             for (long r = area.top(); r <= area.bottom(); ++r)
             {
                 for (long c = area.left(); c <= area.right(); ++c)
                 {
                     double dist = length(point(c,r)-p);
-                    g(r,c) = std::exp(-dist/3.0);
+                    temp(r,c) = std::exp(-dist/3.0);
                 }
             }
-            fft_inplace(g);
+            fftr(temp, g);
             g = conj(g);
         }
 
 
         void make_scale_target_location_image (
             const double scale,
-            matrix<std::complex<double>,0,1>& g
+            matrix<ctype,0,1>& g
         ) const
         {
             g.set_size(get_num_scale_levels());
@@ -326,11 +493,11 @@ namespace dlib
             g = conj(g);
         }
 
-        matrix<double> make_cosine_mask (
+        matrix<T> make_cosine_mask (
         ) const
         {
             const long size = get_filter_size();
-            matrix<double> temp(size,size);
+            matrix<T> temp(size,size);
             point cent = center(get_rect(temp));
             for (long r = 0; r < temp.nr(); ++r)
             {
@@ -347,21 +514,38 @@ namespace dlib
         }
 
 
-        std::vector<matrix<std::complex<double> > > A, F;
-        matrix<double> B;
+        unsigned long filter_size;
+        unsigned long num_scale_levels;
+        unsigned long scale_window_size;
 
-        std::vector<matrix<std::complex<double>,0,1> > As, Fs;
-        matrix<double,0,1> Bs;
+        // The spatial filters hold only the non-redundant half of each spectrum since
+        // the features are real valued.  See fftr().
+        std::vector<matrix<ctype> > A, F;
+        matrix<T> B;
+
+        std::vector<matrix<ctype,0,1> > As, Fs;
+        matrix<T,0,1> Bs;
         drectangle position;
 
-        matrix<double> mask;
-        std::vector<double> scale_cos_mask;
+        matrix<T> mask;
+        std::vector<T> scale_cos_mask;
 
-        // G and Gs do not logically contribute to the state of this object.  They are
-        // here just so we can void reallocating them over and over.
-        matrix<std::complex<double> > G;
-        matrix<std::complex<double>,0,1> Gs;
+        // The rest of these variables do not logically contribute to the state of this
+        // object.  They are here just so we can avoid reallocating them over and over.
+        matrix<ctype> G;
+        matrix<ctype,0,1> Gs;
+        std::vector<matrix<T> > features;
+        matrix<T> response;
+        scratch_space scratch;
     };
+
+// ----------------------------------------------------------------------------------------
+
+    typedef basic_correlation_tracker<double> correlation_tracker;
+    typedef basic_correlation_tracker<float> correlation_tracker_float;
+
+// ----------------------------------------------------------------------------------------
+
 }
 
 #endif // DLIB_CORRELATION_TrACKER_H_
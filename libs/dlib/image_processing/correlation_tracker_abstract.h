@@ -10,9 +10,16 @@ namespace dlib
 
 // ----------------------------------------------------------------------------------------
 
-    class correlation_tracker
+    template <
+        typename T
+        >
+    class basic_correlation_tracker
     {
         /*!
+            REQUIREMENTS ON T
+                T must be float or double.  It is the precision used for the filters and
+                the FFTs done on every call to update().
+
             WHAT THIS OBJECT REPRESENTS
                 This is a tool for tracking moving objects in a video stream.  You give it
                 the bounding box of an object in the first frame and it attempts to track the
@@ -21,15 +28,57 @@ namespace dlib
                 This tool is an implementation of the method described in the following paper:
                     Danelljan, Martin, et al. "Accurate scale estimation for robust visual
                     tracking." Proceedings of the British Machine Vision Conference BMVC. 2014.
+
+                The images and filters needed by update() are kept inside this object and
+                reused from frame to frame, so tracking a video with a fixed pixel type
+                doesn't reallocate them on every call.
         !*/
 
     public:
 
-        correlation_tracker (
+        typedef T scalar_type;
+
+        basic_correlation_tracker (
+            unsigned long filter_size = 6,
+            unsigned long num_scale_levels = 5,
+            unsigned long scale_window_size = 23
         );
         /*!
+            requires
+                - 1 < filter_size < 31
+                - 0 < num_scale_levels < 31
+                - scale_window_size > 0
             ensures
                 - #get_position().is_empty() == true
+                - #get_filter_size() == pow(2,filter_size)
+                - #get_num_scale_levels() == pow(2,num_scale_levels)
+                - #get_scale_window_size() == scale_window_size
+                - Smaller filters and fewer scale levels make update() faster, which is
+                  useful for tracking many small objects, but the defaults are more
+                  accurate.
+        !*/
+
+        unsigned long get_filter_size (
+        ) const;
+        /*!
+            ensures
+                - returns the size of the square filter used to locate the object.  The
+                  object is tracked in a get_filter_size() by get_filter_size() chip around
+                  its last position.
+        !*/
+
+        unsigned long get_num_scale_levels (
+        ) const;
+        /*!
+            ensures
+                - returns the number of scales searched when estimating the object's size.
+        !*/
+
+        unsigned long get_scale_window_size (
+        ) const;
+        /*!
+            ensures
+                - returns the size of the square chips extracted at each scale level.
         !*/
 
         template <
@@ -100,6 +149,19 @@ namespace dlib
         !*/
 
     };
+
+// ----------------------------------------------------------------------------------------
+
+    typedef basic_correlation_tracker<double> correlation_tracker;
+    typedef basic_correlation_tracker<float> correlation_tracker_float;
+    /*!
+        correlation_tracker_float keeps its filters in single precision which halves the
+        memory traffic of update().  It tracks slightly differently than
+        correlation_tracker because of the rounding but is otherwise identical.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
 }
 
 #endif // DLIB_CORRELATION_TrACKER_ABSTRACT_H_
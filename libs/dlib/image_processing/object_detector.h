@@ -64,6 +64,34 @@ namespace dlib
         feature_vector_type w;
     };
 
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename image_scanner_type
+        >
+    void detect_with_weight_vectors (
+        image_scanner_type& scanner,
+        const std::vector<processed_weight_vector<image_scanner_type> >& w,
+        const std::vector<double>& thresh,
+        std::vector<std::vector<std::pair<double, rectangle> > >& dets
+    )
+    /*!
+        requires
+            - scanner.is_loaded_with_image() == true
+            - w.size() == thresh.size()
+        ensures
+            - #dets.size() == w.size()
+            - #dets[i] == the output of scanner.detect(w[i].get_detect_argument(), dets[i], thresh[i])
+            - Image scanners that can evaluate all their weight vectors at once overload
+              this function.  For example, scan_fhog_pyramid uses it to run its filter
+              banks on several threads.
+    !*/
+    {
+        dets.resize(w.size());
+        for (unsigned long i = 0; i < w.size(); ++i)
+            scanner.detect(w[i].get_detect_argument(), dets[i], thresh[i]);
+    }
+
 // ----------------------------------------------------------------------------------------
 
     template <
@@ -431,18 +459,22 @@ namespace dlib
     ) 
     {
         scanner.load(img);
-        std::vector<std::pair<double, rectangle> > dets;
+        std::vector<double> thresh(w.size());
+        for (unsigned long i = 0; i < w.size(); ++i)
+            thresh[i] = w[i].w(scanner.get_num_dimensions()) + adjust_threshold;
+        std::vector<std::vector<std::pair<double, rectangle> > > dets;
+        detect_with_weight_vectors(scanner, w, thresh, dets);
+
         std::vector<rect_detection> dets_accum;
         for (unsigned long i = 0; i < w.size(); ++i)
         {
             const double thresh = w[i].w(scanner.get_num_dimensions());
-            scanner.detect(w[i].get_detect_argument(), dets, thresh + adjust_threshold);
-            for (unsigned long j = 0; j < dets.size(); ++j)
+            for (unsigned long j = 0; j < dets[i].size(); ++j)
             {
                 rect_detection temp;
-                temp.detection_confidence = dets[j].first-thresh;
+                temp.detection_confidence = dets[i][j].first-thresh;
                 temp.weight_index = i;
-                temp.rect = dets[j].second;
+                temp.rect = dets[i][j].second;
                 dets_accum.push_back(temp);
             }
         }
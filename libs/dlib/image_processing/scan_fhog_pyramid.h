@@ -8,6 +8,10 @@
 #include "../image_transforms.h"
 #include "../array.h"
 #include "../array2d.h"
+#include "../threads.h"
+#include "../any.h"
+#include "../smart_pointers.h"
+#include <cstring>
 #include "object_detector.h"
 
 namespace dlib
@@ -92,6 +96,10 @@ namespace dlib
             const image_type& img
         );
 
+        void load (
+            const scan_fhog_pyramid& item
+        );
+
         inline bool is_loaded_with_image (
         ) const;
 
@@ -99,6 +107,26 @@ namespace dlib
             const scan_fhog_pyramid& item
         );
 
+        void set_num_threads (
+            unsigned long num
+        )
+        {
+            num_threads = num;
+        }
+
+        unsigned long get_num_threads (
+        ) const { return num_threads; }
+
+        void set_loads_incrementally (
+            bool enabled
+        )
+        {
+            incremental = enabled;
+        }
+
+        bool loads_incrementally (
+        ) const { return incremental; }
+
         void set_detection_window_size (
             unsigned long width,
             unsigned long height
@@ -290,6 +318,12 @@ namespace dlib
             const double thresh
         ) const;
 
+        void detect (
+            const std::vector<const fhog_filterbank*>& w,
+            const std::vector<double>& thresh,
+            std::vector<std::vector<std::pair<double, rectangle> > >& dets
+        );
+
 
         void get_feature_vector (
             const full_object_detection& obj,
@@ -393,6 +427,59 @@ namespace dlib
         unsigned long min_pyramid_layer_width;
         unsigned long min_pyramid_layer_height;
         double nuclear_norm_regularization_strength;
+        unsigned long num_threads;
+        bool incremental;
+
+        // feats_version counts the changes to feats.  If feats_partly_changed then the
+        // last one only touched feats_changes[l] of each level l, otherwise everything
+        // could have changed.
+        unsigned long feats_version;
+        bool feats_partly_changed;
+        std::vector<std::vector<rectangle> > feats_changes;
+
+        void feats_changed (
+        )
+        {
+            ++feats_version;
+            feats_partly_changed = false;
+        }
+
+        // only used when loading incrementally.  The saliency images of the filter banks
+        // the multi filter bank detect() was last called with, so only the parts the
+        // last load() changed need to be filtered again.
+        struct cached_saliency
+        {
+            fhog_filterbank w;
+            unsigned long feats_version;
+            array<array2d<float> > saliency;
+            std::vector<rectangle> area;
+        };
+        std::vector<shared_ptr<cached_saliency> > saliency_cache;
+        array<array2d<float> > saliency_crop;
+        array2d<float> saliency_crop_out;
+
+        void detect_incrementally (
+            const std::vector<const fhog_filterbank*>& w,
+            const std::vector<double>& thresh,
+            std::vector<std::vector<std::pair<double, rectangle> > >& dets
+        );
+
+        // only used when num_threads > 1 or when loading incrementally.  scratch holds the
+        // downsampled images of the last load() so they don't need to be allocated again
+        // for the next one, or compared against when loading incrementally.  The multi
+        // filter bank detect() gives each thread its own saliency and filter buffers.
+        scoped_ptr<thread_pool> tp;
+        any scratch;
+        array<array2d<float> > detect_saliency;
+        array<array2d<float> > detect_scratch;
+
+        thread_pool& get_thread_pool (
+        )
+        {
+            if (!tp || tp->num_threads_in_pool() != num_threads)
+                tp.reset(new thread_pool(num_threads));
+            return *tp;
+        }
 
         void init()
         {
@@ -404,6 +491,10 @@ namespace dlib
             min_pyramid_layer_width = 64;
             min_pyramid_layer_height = 64;
             nuclear_norm_regularization_strength = 0;
+            num_threads = 1;
+            incremental = false;
+            feats_version = 0;
+            feats_partly_changed = false;
         }
 
     };
@@ -416,7 +507,8 @@ namespace dlib
         rectangle apply_filters_to_fhog (
             const fhog_filterbank& w,
             const array<array2d<float> >& feats,
-            array2d<float>& saliency_image
+            array2d<float>& saliency_image,
+            array2d<float>& scratch
         )
         {
             const unsigned long num_separable_filters = w.num_separable_filters();
@@ -435,7 +527,6 @@ namespace dlib
             else
             {
                 saliency_image.clear();
-                array2d<float> scratch;
 
                 // find the first filter to apply
                 unsigned long i = 0;
@@ -460,6 +551,86 @@ namespace dlib
             }
             return area;
         }
+
+        template <typename fhog_filterbank>
+        rectangle apply_filters_to_fhog (
+            const fhog_filterbank& w,
+            const array<array2d<float> >& feats,
+            array2d<float>& saliency_image
+        )
+        {
+            array2d<float> scratch;
+            return apply_filters_to_fhog(w, feats, saliency_image, scratch);
+        }
+
+        template <typename fhog_filterbank>
+        void update_filtered_fhog (
+            const fhog_filterbank& w,
+            const array<array2d<float> >& feats,
+            const rectangle& changed,
+            array2d<float>& saliency_image,
+            array<array2d<float> >& crop,
+            array2d<float>& crop_saliency,
+            array2d<float>& scratch
+        )
+        /*!
+            requires
+                - saliency_image was made by apply_filters_to_fhog(w, feats, ...) before
+                  the features in the changed rectangle of feats changed.
+            ensures
+                - #saliency_image == what apply_filters_to_fhog() gives for the current
+                  feats, to the bit.  Only the saliency around changed is filtered again,
+                  using crop, crop_saliency and scratch as buffers.
+        !*/
+        {
+            const long filter_nr = w.filters[0].nr();
+            const long filter_nc = w.filters[0].nc();
+            const long nr = feats[0].nr();
+            const long nc = feats[0].nc();
+            const long first_row = filter_nr/2;
+            const long first_col = filter_nc/2;
+            const long last_row = nr - ((filter_nr-1)/2);
+            const long last_col = nc - ((filter_nc-1)/2);
+
+            // the saliency whose filter windows overlap changed
+            const rectangle area = rectangle(first_col, first_row, last_col-1, last_row-1).intersect(
+                rectangle(changed.left()-filter_nc+1+first_col, changed.top()-filter_nr+1+first_row,
+                          changed.right()+first_col, changed.bottom()+first_row));
+            if (area.is_empty())
+                return;
+            if (area == rectangle(first_col, first_row, last_col-1, last_row-1))
+            {
+                apply_filters_to_fhog(w, feats, saliency_image, scratch);
+                return;
+            }
+
+            // The filters process 8 columns at a time starting at first_col and do the
+            // columns left over on the right one at a time, which sums in another order.
+            // So the crop starts on one of those groups of 8, and either goes to the right
+            // edge of the image or ends on a group before the leftover columns.
+            long leftover = first_col;
+            while (leftover < last_col-7)
+                leftover += 8;
+            const long left = (area.left()-first_col)/8*8;
+            long right = nc;
+            if (area.right() < leftover)
+                right = first_col + left + (area.right()+1-first_col-left+7)/8*8 + (filter_nc-1)/2;
+            const long top = area.top()-first_row;
+            const long bottom = area.bottom()-first_row+filter_nr;
+
+            if (crop.max_size() < feats.size())
+                crop.set_max_size(feats.size());
+            crop.set_size(feats.size());
+            for (unsigned long i = 0; i < feats.size(); ++i)
+                assign_image(crop[i], sub_image(feats[i], rectangle(left, top, right-1, bottom-1)));
+
+            apply_filters_to_fhog(w, crop, crop_saliency, scratch);
+            for (long r = area.top(); r <= area.bottom(); ++r)
+            {
+                for (long c = area.left(); c <= area.right(); ++c)
+                    saliency_image[r][c] = crop_saliency[r-top][c-left];
+            }
+        }
     }
 
 // ----------------------------------------------------------------------------------------
@@ -508,6 +679,7 @@ namespace dlib
         deserialize(item.min_pyramid_layer_width, in);
         deserialize(item.min_pyramid_layer_height, in);
         deserialize(item.nuclear_norm_regularization_strength, in);
+        item.feats_changed();
 
         // When developing some feature extractor, it's easy to accidentally change its
         // number of dimensions and then try to deserialize data from an older version of
@@ -555,6 +727,157 @@ namespace dlib
 
     namespace impl
     {
+        template <
+            typename pixel_type
+            >
+        struct streamed_fhog_level
+        {
+            /*!
+                WHAT THIS OBJECT REPRESENTS
+                    A pyramid level that is downsampled from the level above it one row at
+                    a time, by the same bilinear resize_image() pyramid_down<N> uses, and
+                    whose rows go straight into the fHOG extraction.
+            !*/
+            impl_fhog::fhog_row_stream<pixel_type, array<array2d<float> > > stream;
+            long in_nr, in_nc;
+            long out_nr, out_nc;
+            double x_scale, y_scale;
+            // the input row position of the last output row
+            double y;
+        };
+
+        template <
+            typename pixel_type,
+            typename mm
+            >
+        void stream_fhog_level_rows (
+            const array2d<pixel_type,mm>& img,
+            array<streamed_fhog_level<pixel_type> >& levels,
+            unsigned long i,
+            long j
+        )
+        /*!
+            requires
+                - row j of the input of levels[i] was just produced, rows are produced in
+                  order.
+            ensures
+                - produces all rows of levels[i] that only depend on input rows up to j,
+                  and the rows of the levels below that depend on them.  Since pyramid
+                  levels shrink, these only need input rows j-1 and j, so each level only
+                  has to keep its last 3 rows around.
+        !*/
+        {
+            streamed_fhog_level<pixel_type>& l = levels[i];
+            while (l.stream.num_rows_received() < l.out_nr)
+            {
+                const double y = l.y + l.y_scale;
+                const long top    = static_cast<long>(std::floor(y));
+                const long bottom = std::min(top+1, l.in_nr-1);
+                if (bottom > j)
+                    break;
+                l.y = y;
+
+                const pixel_type* top_row = (i == 0) ? &img[top][0] : levels[i-1].stream.row(top);
+                const pixel_type* bottom_row = (i == 0) ? &img[bottom][0] : levels[i-1].stream.row(bottom);
+                dlib::impl::resize_row_bilinear(top_row, bottom_row, l.in_nc, l.stream.next_row(),
+                    l.out_nc, l.x_scale, y - top);
+                l.stream.push_row();
+
+                if (i+1 < levels.size())
+                    stream_fhog_level_rows(img, levels, i+1, l.stream.num_rows_received()-1);
+            }
+        }
+
+        template <
+            typename pyramid_type,
+            typename image_type,
+            typename feature_extractor_type
+            >
+        bool stream_fhog_pyramid_levels (
+            const pyramid_type&,
+            const image_type& ,
+            const feature_extractor_type& ,
+            array<array<array2d<float> > >& ,
+            int ,
+            int ,
+            int 
+        )
+        {
+            // Other pyramids, image and pixel types or feature extractors make their levels
+            // the regular way.
+            return false;
+        }
+
+        template <
+            unsigned int N,
+            typename pixel_type,
+            typename mm
+            >
+        typename enable_if_c<(N > 3) && (pixel_traits<pixel_type>::rgb || pixel_traits<pixel_type>::grayscale), bool>::type
+        stream_fhog_pyramid_levels (
+            const pyramid_down<N>&,
+            const array2d<pixel_type,mm>& img,
+            const default_fhog_feature_extractor& ,
+            array<array<array2d<float> > >& feats,
+            int cell_size,
+            int filter_rows_padding,
+            int filter_cols_padding
+        )
+        /*!
+            ensures
+                - if possible, computes the features of pyramid levels 1 to feats.size()-1
+                  without making the level images, and returns true.  The features are
+                  the same as extracting them from the images pyramid_down<N> makes, but
+                  each level is downsampled into a 3 row ring buffer the fHOG binning
+                  reads from, instead of being written out and read back in full.
+                - returns false and doesn't touch feats otherwise.
+        !*/
+        {
+            // the cell_size 1 extractor works on whole images
+            if (cell_size == 1)
+                return false;
+
+            array<streamed_fhog_level<pixel_type> > levels;
+            levels.set_max_size(feats.size()-1);
+            levels.set_size(feats.size()-1);
+            long nr = img.nr();
+            long nc = img.nc();
+            for (unsigned long i = 0; i < levels.size(); ++i)
+            {
+                streamed_fhog_level<pixel_type>& l = levels[i];
+                l.in_nr = nr;
+                l.in_nc = nc;
+                l.out_nr = nr = ((N-1)*nr)/N;
+                l.out_nc = nc = ((N-1)*nc)/N;
+                // resize_image() just zeros levels this small
+                if (l.out_nr <= 1 || l.out_nc <= 1)
+                    return false;
+                l.x_scale = (l.in_nc-1)/(double)std::max<long>((l.out_nc-1),1);
+                l.y_scale = (l.in_nr-1)/(double)std::max<long>((l.out_nr-1),1);
+                l.y = -l.y_scale;
+            }
+
+            for (unsigned long i = 0; i < levels.size(); ++i)
+            {
+                levels[i].stream.setup(levels[i].out_nr, levels[i].out_nc, feats[i+1], cell_size,
+                    filter_rows_padding, filter_cols_padding);
+            }
+
+            for (long j = 0; j < img.nr(); ++j)
+                stream_fhog_level_rows(img, levels, 0, j);
+
+            for (unsigned long i = 0; i < levels.size(); ++i)
+            {
+                levels[i].stream.finish();
+                // the same empty planes extract_fhog_features() outputs for tiny images
+                if (feats[i+1].size() == 0)
+                    feats[i+1].resize(31);
+            }
+            return true;
+        }
+
+    // ------------------------------------------------------------------------------------
+
         template <
             typename pyramid_type,
             typename image_type,
@@ -596,7 +919,8 @@ namespace dlib
                 "Invalid feature extractor used with dlib::scan_fhog_pyramid.  The output does not have the \n"
                 "indicated number of planes.");
 
-            if (feats.size() > 1)
+            if (feats.size() > 1 && !stream_fhog_pyramid_levels(pyr, img, fe, feats, cell_size,
+                    filter_rows_padding, filter_cols_padding))
             {
                 typedef typename image_traits<image_type>::pixel_type pixel_type;
                 array2d<pixel_type> temp1, temp2;
@@ -612,6 +936,478 @@ namespace dlib
                 }
             }
         }
+
+    // ------------------------------------------------------------------------------------
+
+        template <
+            typename feature_extractor_type,
+            typename image_type
+            >
+        class fhog_level_task
+        {
+            /*!
+                WHAT THIS OBJECT REPRESENTS
+                    The thread_pool task that extracts the features of one pyramid level.
+            !*/
+        public:
+            fhog_level_task (
+                const feature_extractor_type& fe_,
+                const image_type& img_,
+                array<array2d<float> >& hog_,
+                int cell_size_,
+                int filter_rows_padding_,
+                int filter_cols_padding_
+            ) : fe(fe_), img(img_), hog(hog_), cell_size(cell_size_),
+                filter_rows_padding(filter_rows_padding_), filter_cols_padding(filter_cols_padding_) {}
+
+            void operator() (
+            ) const
+            {
+                fe(img, hog, cell_size, filter_rows_padding, filter_cols_padding);
+            }
+
+        private:
+            const feature_extractor_type& fe;
+            const image_type& img;
+            array<array2d<float> >& hog;
+            int cell_size;
+            int filter_rows_padding;
+            int filter_cols_padding;
+        };
+
+        template <
+            typename image_type
+            >
+        class fhog_rows_task
+        {
+            /*!
+                WHAT THIS OBJECT REPRESENTS
+                    The thread_pool task that extracts the rows [row_begin, row_end) of
+                    the features of one pyramid level, so big levels can be split over
+                    several threads.
+            !*/
+        public:
+            fhog_rows_task (
+                const image_type& img_,
+                array<array2d<float> >& hog_,
+                int cell_size_,
+                int filter_rows_padding_,
+                int filter_cols_padding_,
+                long row_begin_,
+                long row_end_
+            ) : img(img_), hog(hog_), cell_size(cell_size_), filter_rows_padding(filter_rows_padding_),
+                filter_cols_padding(filter_cols_padding_), row_begin(row_begin_), row_end(row_end_) {}
+
+            void operator() (
+            ) const
+            {
+                impl_fhog::impl_extract_fhog_rows(img, hog, cell_size, filter_rows_padding,
+                    filter_cols_padding, row_begin, row_end);
+            }
+
+        private:
+            const image_type& img;
+            array<array2d<float> >& hog;
+            int cell_size;
+            int filter_rows_padding;
+            int filter_cols_padding;
+            long row_begin;
+            long row_end;
+        };
+
+        template <
+            typename feature_extractor_type,
+            typename image_type
+            >
+        void add_fhog_level_tasks (
+            thread_pool& tp,
+            const feature_extractor_type& fe,
+            const image_type& img,
+            array<array2d<float> >& hog,
+            int cell_size,
+            int filter_rows_padding,
+            int filter_cols_padding,
+            unsigned long 
+        )
+        {
+            // A custom feature extractor can only process whole images.
+            tp.add_task_by_value(fhog_level_task<feature_extractor_type,image_type>(fe, img, hog,
+                    cell_size, filter_rows_padding, filter_cols_padding));
+        }
+
+        template <
+            typename image_type
+            >
+        void add_fhog_level_tasks (
+            thread_pool& tp,
+            const default_fhog_feature_extractor& fe,
+            const image_type& img,
+            array<array2d<float> >& hog,
+            int cell_size,
+            int filter_rows_padding,
+            int filter_cols_padding,
+            unsigned long num_tiles
+        )
+        {
+            if (num_tiles <= 1 || cell_size == 1)
+            {
+                tp.add_task_by_value(fhog_level_task<default_fhog_feature_extractor,image_type>(fe, img, hog,
+                        cell_size, filter_rows_padding, filter_cols_padding));
+                return;
+            }
+
+            const long rows = impl_fhog::init_fhog_rows(img, hog, cell_size, filter_rows_padding, filter_cols_padding);
+            if (rows == 0)
+            {
+                // the same empty planes extract_fhog_features() outputs for tiny images
+                hog.resize(31);
+                return;
+            }
+            num_tiles = std::min<unsigned long>(num_tiles, rows);
+            for (unsigned long i = 0; i < num_tiles; ++i)
+            {
+                tp.add_task_by_value(fhog_rows_task<image_type>(img, hog, cell_size, filter_rows_padding,
+                        filter_cols_padding, rows*i/num_tiles, rows*(i+1)/num_tiles));
+            }
+        }
+
+        template <
+            typename pyramid_type,
+            typename image_type,
+            typename feature_extractor_type
+            >
+        void create_fhog_pyramid (
+            const image_type& img,
+            const feature_extractor_type& fe,
+            array<array<array2d<float> > >& feats,
+            int cell_size,
+            int filter_rows_padding,
+            int filter_cols_padding,
+            unsigned long min_pyramid_layer_width,
+            unsigned long min_pyramid_layer_height,
+            unsigned long max_pyramid_levels,
+            thread_pool& tp,
+            array<array2d<typename image_traits<image_type>::pixel_type> >& levels
+        )
+        /*!
+            ensures
+                - computes the same feats as the single threaded create_fhog_pyramid().
+                  The calling thread downsamples the image while the threads in tp extract
+                  the features of the levels that are already done.  Levels bigger than a
+                  share of the work are split into row tiles.
+                - #levels holds the downsampled images, levels[i-1] is pyramid level i.
+        !*/
+        {
+            // figure out how many pyramid levels we should be using based on the image
+            // size, exactly like the single threaded version
+            pyramid_type pyr;
+            std::vector<rectangle> rects(1, get_rect(img));
+            rectangle rect = rects[0];
+            do
+            {
+                rect = pyr.rect_down(rect);
+                rects.push_back(rect);
+            } while (rect.width() >= min_pyramid_layer_width && rect.height() >= min_pyramid_layer_height &&
+                rects.size()-1 < max_pyramid_levels);
+            const unsigned long num_levels = rects.size()-1;
+
+            if (feats.max_size() < num_levels)
+                feats.set_max_size(num_levels);
+            feats.set_size(num_levels);
+            if (levels.max_size() < num_levels-1)
+                levels.set_max_size(num_levels-1);
+            levels.set_size(num_levels-1);
+
+            // Aim for a few tasks per thread so the levels' work evens out.
+            double total_area = 0;
+            for (unsigned long i = 0; i < num_levels; ++i)
+                total_area += rects[i].area();
+            const double tile_area = std::max(1.0, total_area/(4*std::max<unsigned long>(1, tp.num_threads_in_pool())));
+
+            add_fhog_level_tasks(tp, fe, img, feats[0], cell_size, filter_rows_padding, filter_cols_padding,
+                (unsigned long)(rects[0].area()/tile_area + 0.5));
+            for (unsigned long i = 1; i < num_levels; ++i)
+            {
+                if (i == 1)
+                    pyr(img, levels[0]);
+                else
+                    pyr(levels[i-2], levels[i-1]);
+                add_fhog_level_tasks(tp, fe, levels[i-1], feats[i], cell_size, filter_rows_padding,
+                    filter_cols_padding, (unsigned long)(rects[i].area()/tile_area + 0.5));
+            }
+            tp.wait_for_all_tasks();
+
+            DLIB_ASSERT(feats[0].size() == fe.get_num_planes(), 
+                "Invalid feature extractor used with dlib::scan_fhog_pyramid.  The output does not have the \n"
+                "indicated number of planes.");
+        }
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    namespace impl
+    {
+        template <
+            typename pixel_type
+            >
+        struct incremental_fhog_pyramid
+        {
+            /*!
+                WHAT THIS OBJECT REPRESENTS
+                    What an incremental load() keeps of the last image: the image itself,
+                    its downsampled pyramid levels (levels[i-1] is level i) and the
+                    settings its features were made with.
+            !*/
+            incremental_fhog_pyramid() : feats_version(0), cell_size(0) {}
+
+            array2d<pixel_type> img;
+            array<array2d<pixel_type> > levels;
+            array2d<pixel_type> temp;
+            array2d<unsigned char> changed;
+            unsigned long feats_version;
+            int cell_size;
+            int filter_rows_padding;
+            int filter_cols_padding;
+            unsigned long min_pyramid_layer_width;
+            unsigned long min_pyramid_layer_height;
+            unsigned long max_pyramid_levels;
+        };
+
+        template <
+            typename image_type,
+            typename pixel_type
+            >
+        bool find_changed_tiles (
+            const image_type& img_,
+            array2d<pixel_type>& prev,
+            const long tile_size,
+            array2d<unsigned char>& changed
+        )
+        /*!
+            requires
+                - img_ and prev have the same size
+            ensures
+                - #changed[r][c] == true if any pixel of the tile_size by tile_size tile at
+                  (r,c) differs between img_ and prev.  Those pixels are copied into prev.
+                - returns true if any tile changed.
+        !*/
+        {
+            const_image_view<image_type> img(img_);
+            changed.set_size((img.nr()+tile_size-1)/tile_size, (img.nc()+tile_size-1)/tile_size);
+            assign_all_pixels(changed, 0);
+            bool any_changed = false;
+            for (long r = 0; r < img.nr(); ++r)
+            {
+                const pixel_type* a = &img[r][0];
+                pixel_type* b = &prev[r][0];
+                // most rows of a static scene are the same
+                if (std::memcmp(a, b, img.nc()*sizeof(pixel_type)) == 0)
+                    continue;
+                for (long tc = 0; tc < changed.nc(); ++tc)
+                {
+                    const long c = tc*tile_size;
+                    const long n = std::min(tile_size, img.nc()-c);
+                    if (std::memcmp(a+c, b+c, n*sizeof(pixel_type)) != 0)
+                    {
+                        changed[r/tile_size][tc] = 1;
+                        std::memcpy(b+c, a+c, n*sizeof(pixel_type));
+                        any_changed = true;
+                    }
+                }
+            }
+            return any_changed;
+        }
+
+        inline void find_changed_fhog_rects (
+            const array2d<unsigned char>& changed,
+            const long hog_nr,
+            const long hog_nc,
+            std::vector<rectangle>& rects
+        )
+        /*!
+            requires
+                - changed comes from find_changed_tiles() with tile_size == the fHOG cell
+                  size, which is > 1.
+            ensures
+                - #rects covers all the features of the hog_nr by hog_nc fHOG image whose
+                  values depend on a changed tile.  The gradients of the pixels of cell row
+                  ty and its neighbouring pixels vote into the cell rows ty-1 to ty+1, and
+                  feature row y is made of the cells in rows y to y+2.  So feature rows
+                  ty-3 to ty+1 can change, and the same goes for columns.
+                - runs of changed feature rows become a rectangle per run of changed
+                  columns in them.
+        !*/
+        {
+            rects.clear();
+            array2d<unsigned char> mask(hog_nr, hog_nc);
+            assign_all_pixels(mask, 0);
+            const rectangle all(0, 0, hog_nc-1, hog_nr-1);
+            for (long ty = 0; ty < changed.nr(); ++ty)
+            {
+                for (long tx = 0; tx < changed.nc(); ++tx)
+                {
+                    if (!changed[ty][tx])
+                        continue;
+                    const rectangle rect = all.intersect(rectangle(tx-3, ty-3, tx+1, ty+1));
+                    for (long r = rect.top(); r <= rect.bottom(); ++r)
+                        for (long c = rect.left(); c <= rect.right(); ++c)
+                            mask[r][c] = 1;
+                }
+            }
+
+            std::vector<unsigned char> cols(hog_nc);
+            long r = 0;
+            while (r < hog_nr)
+            {
+                // find the next run of rows with changes and the columns changed in it
+                std::fill(cols.begin(), cols.end(), 0);
+                const long top = r;
+                for (; r < hog_nr; ++r)
+                {
+                    bool row_changed = false;
+                    for (long c = 0; c < hog_nc; ++c)
+                    {
+                        if (mask[r][c])
+                        {
+                            cols[c] = 1;
+                            row_changed = true;
+                        }
+                    }
+                    if (!row_changed)
+                        break;
+                }
+                const long bottom = r-1;
+                ++r;
+                if (bottom < top)
+                    continue;
+
+                for (long c = 0; c < hog_nc; ++c)
+                {
+                    if (!cols[c])
+                        continue;
+                    const long left = c;
+                    while (c < hog_nc && cols[c])
+                        ++c;
+                    rects.push_back(rectangle(left, top, c-1, bottom));
+                }
+            }
+        }
+
+        template <
+            typename pyramid_type,
+            typename image_type
+            >
+        bool update_fhog_pyramid (
+            const image_type& img,
+            array<array<array2d<float> > >& feats,
+            int cell_size,
+            int filter_rows_padding,
+            int filter_cols_padding,
+            unsigned long min_pyramid_layer_width,
+            unsigned long min_pyramid_layer_height,
+            unsigned long max_pyramid_levels,
+            unsigned long feats_version,
+            incremental_fhog_pyramid<typename image_traits<image_type>::pixel_type>& state,
+            std::vector<std::vector<rectangle> >& changes
+        )
+        /*!
+            requires
+                - feats was made by the default fHOG feature extractor with cell_size > 1
+            ensures
+                - if feats and state hold the pyramid of an image of the same size made
+                  with the same settings, and feats hasn't changed since (i.e. it's at
+                  feats_version == state.feats_version), then:
+                    - updates feats to the pyramid of img by only extracting the features
+                      around the cells whose pixels changed, in the image or in any
+                      downsampled level, and updates state to img.
+                    - #changes[l] == the rectangles of feats[l] this changed.
+                    - returns true
+                - else returns false and doesn't change anything.
+        !*/
+        {
+            if (state.cell_size != cell_size ||
+                state.filter_rows_padding != filter_rows_padding ||
+                state.filter_cols_padding != filter_cols_padding ||
+                state.min_pyramid_layer_width != min_pyramid_layer_width ||
+                state.min_pyramid_layer_height != min_pyramid_layer_height ||
+                state.max_pyramid_levels != max_pyramid_levels ||
+                state.feats_version != feats_version ||
+                num_rows(img) != state.img.nr() || num_columns(img) != state.img.nc() ||
+                state.img.size() == 0 || feats.size() != state.levels.size()+1)
+            {
+                return false;
+            }
+
+            changes.assign(feats.size(), std::vector<rectangle>());
+            pyramid_type pyr;
+            const int padding_rows_offset = (filter_rows_padding-1)/2;
+            const int padding_cols_offset = (filter_cols_padding-1)/2;
+            // Each level is only downsampled again if the one above it changed, and then
+            // compared with what it was to find the changes it got.
+            bool level_changed = find_changed_tiles(img, state.img, cell_size, state.changed);
+            for (unsigned long l = 0; l < feats.size() && level_changed; ++l)
+            {
+                if (l != 0)
+                {
+                    pyr(l == 1 ? state.img : state.levels[l-2], state.temp);
+                    level_changed = find_changed_tiles(state.temp, state.levels[l-1], cell_size, state.changed);
+                    if (!level_changed)
+                        break;
+                }
+
+                if (feats[l].size() == 0 || feats[l][0].size() == 0)
+                    continue;
+                const long hog_nr = feats[l][0].nr()-filter_rows_padding+1;
+                const long hog_nc = feats[l][0].nc()-filter_cols_padding+1;
+                std::vector<rectangle> rects;
+                find_changed_fhog_rects(state.changed, hog_nr, hog_nc, rects);
+                for (unsigned long i = 0; i < rects.size(); ++i)
+                {
+                    const rectangle& rect = rects[i];
+                    if (l == 0)
+                    {
+                        impl_fhog::impl_extract_fhog_rect(state.img, feats[l], cell_size, filter_rows_padding,
+                            filter_cols_padding, rect.top(), rect.bottom()+1, rect.left(), rect.right()+1);
+                    }
+                    else
+                    {
+                        impl_fhog::impl_extract_fhog_rect(state.levels[l-1], feats[l], cell_size, filter_rows_padding,
+                            filter_cols_padding, rect.top(), rect.bottom()+1, rect.left(), rect.right()+1);
+                    }
+                    changes[l].push_back(translate_rect(rect, padding_cols_offset, padding_rows_offset));
+                }
+            }
+            return true;
+        }
+
+        template <
+            typename image_type
+            >
+        void remember_fhog_pyramid (
+            const image_type& img,
+            int cell_size,
+            int filter_rows_padding,
+            int filter_cols_padding,
+            unsigned long min_pyramid_layer_width,
+            unsigned long min_pyramid_layer_height,
+            unsigned long max_pyramid_levels,
+            incremental_fhog_pyramid<typename image_traits<image_type>::pixel_type>& state
+        )
+        /*!
+            requires
+                - state.levels holds the levels create_fhog_pyramid() just made of img
+            ensures
+                - sets up state so the next update_fhog_pyramid() can start from img.
+        !*/
+        {
+            assign_image(state.img, img);
+            state.cell_size = cell_size;
+            state.filter_rows_padding = filter_rows_padding;
+            state.filter_cols_padding = filter_cols_padding;
+            state.min_pyramid_layer_width = min_pyramid_layer_width;
+            state.min_pyramid_layer_height = min_pyramid_layer_height;
+            state.max_pyramid_levels = max_pyramid_levels;
+        }
     }
 
 // ----------------------------------------------------------------------------------------
@@ -630,9 +1426,88 @@ namespace dlib
     {
         unsigned long width, height;
         compute_fhog_window_size(width,height);
-        impl::create_fhog_pyramid<Pyramid_type>(img, fe, feats, cell_size, height,
-            width, min_pyramid_layer_width, min_pyramid_layer_height,
-            max_pyramid_levels);
+        const unsigned long prev_feats_version = feats_version;
+        feats_changed();
+        if (incremental && cell_size > 1 &&
+            is_same_type<feature_extractor_type,default_fhog_feature_extractor>::value)
+        {
+            typedef impl::incremental_fhog_pyramid<typename image_traits<image_type>::pixel_type> state_type;
+            shared_ptr<state_type>& state = scratch.get<shared_ptr<state_type> >();
+            if (!state)
+                state.reset(new state_type);
+            feats_partly_changed = impl::update_fhog_pyramid<Pyramid_type>(img, feats, cell_size,
+                height, width, min_pyramid_layer_width, min_pyramid_layer_height,
+                max_pyramid_levels, prev_feats_version, *state, feats_changes);
+            if (!feats_partly_changed)
+            {
+                impl::create_fhog_pyramid<Pyramid_type>(img, fe, feats, cell_size, height,
+                    width, min_pyramid_layer_width, min_pyramid_layer_height,
+                    max_pyramid_levels, get_thread_pool(), state->levels);
+                impl::remember_fhog_pyramid(img, cell_size, height, width, min_pyramid_layer_width,
+                    min_pyramid_layer_height, max_pyramid_levels, *state);
+            }
+            state->feats_version = feats_version;
+        }
+        else if (num_threads > 1)
+        {
+            // any needs something copyable, so scratch holds a pointer to the levels
+            typedef array<array2d<typename image_traits<image_type>::pixel_type> > levels_type;
+            shared_ptr<levels_type>& levels = scratch.get<shared_ptr<levels_type> >();
+            if (!levels)
+                levels.reset(new levels_type);
+            impl::create_fhog_pyramid<Pyramid_type>(img, fe, feats, cell_size, height,
+                width, min_pyramid_layer_width, min_pyramid_layer_height,
+                max_pyramid_levels, get_thread_pool(), *levels);
+        }
+        else
+        {
+            impl::create_fhog_pyramid<Pyramid_type>(img, fe, feats, cell_size, height,
+                width, min_pyramid_layer_width, min_pyramid_layer_height,
+                max_pyramid_levels);
+        }
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename Pyramid_type,
+        typename feature_extractor_type
+        >
+    void scan_fhog_pyramid<Pyramid_type,feature_extractor_type>::
+    load (
+        const scan_fhog_pyramid& item
+    )
+    {
+        // make sure requires clause is not broken
+        DLIB_ASSERT(item.is_loaded_with_image() &&
+                    item.cell_size == cell_size && item.padding == padding &&
+                    item.window_width == window_width && item.window_height == window_height &&
+                    item.max_pyramid_levels == max_pyramid_levels &&
+                    item.min_pyramid_layer_width == min_pyramid_layer_width &&
+                    item.min_pyramid_layer_height == min_pyramid_layer_height,
+            "\t void scan_fhog_pyramid::load(item)"
+            << "\n\t item must be loaded with an image and use the same feature pyramid settings as this object."
+            << "\n\t item.is_loaded_with_image(): " << item.is_loaded_with_image()
+            << "\n\t this: " << this
+            );
+
+        if (this == &item)
+            return;
+
+        feats_changed();
+        // Copying the already computed pyramid is much cheaper than running the
+        // feature extractor over the image again.
+        if (feats.max_size() < item.feats.size())
+            feats.set_max_size(item.feats.size());
+        feats.set_size(item.feats.size());
+        for (unsigned long i = 0; i < feats.size(); ++i)
+        {
+            if (feats[i].max_size() < item.feats[i].size())
+                feats[i].set_max_size(item.feats[i].size());
+            feats[i].set_size(item.feats[i].size());
+            for (unsigned long j = 0; j < feats[i].size(); ++j)
+                assign_image(feats[i][j], item.feats[i][j]);
+        }
     }
 
 // ----------------------------------------------------------------------------------------
@@ -667,6 +1542,8 @@ namespace dlib
         min_pyramid_layer_width = item.min_pyramid_layer_width;
         min_pyramid_layer_height = item.min_pyramid_layer_height;
         nuclear_norm_regularization_strength = item.nuclear_norm_regularization_strength;
+        num_threads = item.num_threads;
+        incremental = item.incremental;
         fe = item.fe;
     }
 
@@ -758,6 +1635,80 @@ namespace dlib
             return a.first < b.first;
         }
 
+        template <typename T>
+        bool same_filters (
+            const std::vector<T>& a,
+            const std::vector<T>& b
+        )
+        {
+            if (a.size() != b.size())
+                return false;
+            for (unsigned long i = 0; i < a.size(); ++i)
+            {
+                if (a[i].nr() != b[i].nr() || a[i].nc() != b[i].nc() || a[i] != b[i])
+                    return false;
+            }
+            return true;
+        }
+
+        template <typename fhog_filterbank>
+        bool same_filterbank (
+            const fhog_filterbank& a,
+            const fhog_filterbank& b
+        )
+        {
+            if (!same_filters(a.filters, b.filters) || a.row_filters.size() != b.row_filters.size())
+                return false;
+            for (unsigned long i = 0; i < a.row_filters.size(); ++i)
+            {
+                if (!same_filters(a.row_filters[i], b.row_filters[i]) ||
+                    !same_filters(a.col_filters[i], b.col_filters[i]))
+                    return false;
+            }
+            return true;
+        }
+
+        template <
+            typename pyramid_type,
+            typename feature_extractor_type
+            >
+        void find_fhog_detections (
+            const array2d<float>& saliency_image,
+            const rectangle& area,
+            const unsigned long level,
+            const feature_extractor_type& fe,
+            const double thresh,
+            const unsigned long det_box_height,
+            const unsigned long det_box_width,
+            const int cell_size,
+            const int filter_rows_padding,
+            const int filter_cols_padding,
+            std::vector<std::pair<double, rectangle> >& dets
+        )
+        /*!
+            ensures
+                - appends the detections in area of the saliency image of the given pyramid
+                  level to dets, in image coordinates.
+        !*/
+        {
+            pyramid_type pyr;
+            // now search the saliency image for any detections
+            for (long r = area.top(); r <= area.bottom(); ++r)
+            {
+                for (long c = area.left(); c <= area.right(); ++c)
+                {
+                    // if we found a detection
+                    if (saliency_image[r][c] >= thresh)
+                    {
+                        rectangle rect = fe.feats_to_image(centered_rect(point(c,r),det_box_width,det_box_height), 
+                            cell_size, filter_rows_padding, filter_cols_padding);
+                        rect = pyr.rect_up(rect, level);
+                        dets.push_back(std::make_pair(saliency_image[r][c], rect));
+                    }
+                }
+            }
+        }
+
         template <
             typename pyramid_type,
             typename feature_extractor_type,
@@ -779,32 +1730,139 @@ namespace dlib
             dets.clear();
 
             array2d<float> saliency_image;
-            pyramid_type pyr;
 
             // for all pyramid levels
             for (unsigned long l = 0; l < feats.size(); ++l)
             {
                 const rectangle area = apply_filters_to_fhog(w, feats[l], saliency_image);
+                find_fhog_detections<pyramid_type>(saliency_image, area, l, fe, thresh, det_box_height,
+                    det_box_width, cell_size, filter_rows_padding, filter_cols_padding, dets);
+            }
+
+            std::sort(dets.rbegin(), dets.rend(), compare_pair_rect);
+        }
 
-                // now search the saliency image for any detections
-                for (long r = area.top(); r <= area.bottom(); ++r)
+    // ------------------------------------------------------------------------------------
+
+        template <
+            typename pyramid_type,
+            typename feature_extractor_type,
+            typename fhog_filterbank
+            >
+        class fhog_detect_jobs
+        {
+            /*!
+                WHAT THIS OBJECT REPRESENTS
+                    The work of running several filter banks over a feature pyramid, split
+                    into one job per (filter bank, pyramid level) pair.  Any number of
+                    threads can call run() at the same time, each with its own buffers.
+                    Job l*w.size()+i applies filter bank i to pyramid level l, so the jobs
+                    on the biggest levels are handed out first.
+            !*/
+        public:
+            fhog_detect_jobs (
+                const array<array<array2d<float> > >& feats_,
+                const feature_extractor_type& fe_,
+                const std::vector<const fhog_filterbank*>& w_,
+                const std::vector<double>& thresh_,
+                const unsigned long det_box_height_,
+                const unsigned long det_box_width_,
+                const int cell_size_,
+                const int filter_rows_padding_,
+                const int filter_cols_padding_
+            ) : feats(feats_), fe(fe_), w(w_), thresh(thresh_), det_box_height(det_box_height_),
+                det_box_width(det_box_width_), cell_size(cell_size_), filter_rows_padding(filter_rows_padding_),
+                filter_cols_padding(filter_cols_padding_), next_job(0), dets(w.size()*feats.size()) {}
+
+            unsigned long num_jobs (
+            ) const { return dets.size(); }
+
+            void run (
+                array2d<float>& saliency_image,
+                array2d<float>& scratch
+            )
+            {
+                while (true)
                 {
-                    for (long c = area.left(); c <= area.right(); ++c)
+                    unsigned long job;
                     {
-                        // if we found a detection
-                        if (saliency_image[r][c] >= thresh)
-                        {
-                            rectangle rect = fe.feats_to_image(centered_rect(point(c,r),det_box_width,det_box_height), 
-                                cell_size, filter_rows_padding, filter_cols_padding);
-                            rect = pyr.rect_up(rect, l);
-                            dets.push_back(std::make_pair(saliency_image[r][c], rect));
-                        }
+                        auto_mutex lock(m);
+                        if (next_job == dets.size())
+                            return;
+                        job = next_job++;
                     }
+
+                    const unsigned long i = job%w.size();
+                    const unsigned long l = job/w.size();
+                    const rectangle area = apply_filters_to_fhog(*w[i], feats[l], saliency_image, scratch);
+                    find_fhog_detections<pyramid_type>(saliency_image, area, l, fe, thresh[i], det_box_height,
+                        det_box_width, cell_size, filter_rows_padding, filter_cols_padding, dets[job]);
                 }
             }
 
-            std::sort(dets.rbegin(), dets.rend(), compare_pair_rect);
-        }
+            void get_detections (
+                unsigned long i,
+                std::vector<std::pair<double, rectangle> >& out
+            ) const
+            /*!
+                ensures
+                    - #out == the output of detect_from_fhog_pyramid() for filter bank i,
+                      in the same order.
+            !*/
+            {
+                out.clear();
+                for (unsigned long l = 0; l < feats.size(); ++l)
+                {
+                    const std::vector<std::pair<double, rectangle> >& d = dets[l*w.size()+i];
+                    out.insert(out.end(), d.begin(), d.end());
+                }
+                std::sort(out.rbegin(), out.rend(), compare_pair_rect);
+            }
+
+        private:
+            const array<array<array2d<float> > >& feats;
+            const feature_extractor_type& fe;
+            const std::vector<const fhog_filterbank*>& w;
+            const std::vector<double>& thresh;
+            const unsigned long det_box_height;
+            const unsigned long det_box_width;
+            const int cell_size;
+            const int filter_rows_padding;
+            const int filter_cols_padding;
+
+            mutex m;
+            unsigned long next_job;
+            std::vector<std::vector<std::pair<double, rectangle> > > dets;
+        };
+
+        template <
+            typename jobs_type
+            >
+        class fhog_detect_task
+        {
+            /*!
+                WHAT THIS OBJECT REPRESENTS
+                    The thread_pool task that works through the jobs of a fhog_detect_jobs
+                    object with one thread's buffers.
+            !*/
+        public:
+            fhog_detect_task (
+                jobs_type& jobs_,
+                array2d<float>& saliency_image_,
+                array2d<float>& scratch_
+            ) : jobs(jobs_), saliency_image(saliency_image_), scratch(scratch_) {}
+
+            void operator() (
+            ) const
+            {
+                jobs.run(saliency_image, scratch);
+            }
+
+        private:
+            jobs_type& jobs;
+            array2d<float>& saliency_image;
+            array2d<float>& scratch;
+        };
 
         inline bool overlaps_any_box (
             const test_box_overlap& tester,
@@ -855,6 +1913,157 @@ namespace dlib
             height-2*padding, width-2*padding, cell_size, height, width, dets);
     }
 
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename Pyramid_type,
+        typename feature_extractor_type
+        >
+    void scan_fhog_pyramid<Pyramid_type,feature_extractor_type>::
+    detect (
+        const std::vector<const fhog_filterbank*>& w,
+        const std::vector<double>& thresh,
+        std::vector<std::vector<std::pair<double, rectangle> > >& dets
+    ) 
+    {
+        // make sure requires clause is not broken
+        DLIB_ASSERT(is_loaded_with_image() && w.size() == thresh.size(), 
+            "\t void scan_fhog_pyramid::detect()"
+            << "\n\t Invalid inputs were given to this function "
+            << "\n\t is_loaded_with_image(): " << is_loaded_with_image()
+            << "\n\t w.size():               " << w.size()
+            << "\n\t thresh.size():          " << thresh.size()
+            << "\n\t this: " << this
+            );
+#ifdef ENABLE_ASSERTS
+        for (unsigned long i = 0; i < w.size(); ++i)
+        {
+            DLIB_ASSERT(w[i]->get_num_dimensions() == get_num_dimensions(), 
+                "\t void scan_fhog_pyramid::detect()"
+                << "\n\t Invalid inputs were given to this function "
+                << "\n\t w[i]->get_num_dimensions(): " << w[i]->get_num_dimensions()
+                << "\n\t get_num_dimensions():       " << get_num_dimensions()
+                << "\n\t i: " << i
+                << "\n\t this: " << this
+                );
+        }
+#endif
+
+        dets.resize(w.size());
+        if (incremental)
+        {
+            detect_incrementally(w, thresh, dets);
+            return;
+        }
+        if (num_threads <= 1 || w.size()*feats.size() <= 1)
+        {
+            for (unsigned long i = 0; i < w.size(); ++i)
+                detect(*w[i], dets[i], thresh[i]);
+            return;
+        }
+
+        unsigned long width, height;
+        compute_fhog_window_size(width,height);
+
+        typedef impl::fhog_detect_jobs<pyramid_type,feature_extractor_type,fhog_filterbank> jobs_type;
+        jobs_type jobs(feats, fe, w, thresh, height-2*padding, width-2*padding, cell_size, height, width);
+
+        const unsigned long num_tasks = std::min(num_threads, jobs.num_jobs());
+        if (detect_saliency.max_size() < num_tasks)
+        {
+            detect_saliency.set_max_size(num_tasks);
+            detect_scratch.set_max_size(num_tasks);
+        }
+        detect_saliency.set_size(num_tasks);
+        detect_scratch.set_size(num_tasks);
+
+        thread_pool& pool = get_thread_pool();
+        for (unsigned long t = 0; t < num_tasks; ++t)
+            pool.add_task_by_value(impl::fhog_detect_task<jobs_type>(jobs, detect_saliency[t], detect_scratch[t]));
+        pool.wait_for_all_tasks();
+
+        for (unsigned long i = 0; i < w.size(); ++i)
+            jobs.get_detections(i, dets[i]);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename Pyramid_type,
+        typename feature_extractor_type
+        >
+    void scan_fhog_pyramid<Pyramid_type,feature_extractor_type>::
+    detect_incrementally (
+        const std::vector<const fhog_filterbank*>& w,
+        const std::vector<double>& thresh,
+        std::vector<std::vector<std::pair<double, rectangle> > >& dets
+    ) 
+    {
+        unsigned long width, height;
+        compute_fhog_window_size(width,height);
+
+        // Pick the saliency images made with the same filter banks out of the cache.
+        // Comparing the filters costs next to nothing compared to running them.
+        std::vector<shared_ptr<cached_saliency> > cache(w.size());
+        for (unsigned long i = 0; i < w.size(); ++i)
+        {
+            for (unsigned long j = 0; j < saliency_cache.size(); ++j)
+            {
+                if (saliency_cache[j] && impl::same_filterbank(saliency_cache[j]->w, *w[i]))
+                {
+                    cache[i].swap(saliency_cache[j]);
+                    break;
+                }
+            }
+            if (!cache[i])
+            {
+                cache[i].reset(new cached_saliency);
+                cache[i]->w = *w[i];
+                cache[i]->feats_version = feats_version-1;
+            }
+        }
+
+        array2d<float> scratch;
+        for (unsigned long i = 0; i < w.size(); ++i)
+        {
+            cached_saliency& item = *cache[i];
+            if (item.feats_version != feats_version)
+            {
+                if (feats_partly_changed && item.feats_version+1 == feats_version &&
+                    item.saliency.size() == feats.size())
+                {
+                    for (unsigned long l = 0; l < feats.size(); ++l)
+                    {
+                        for (unsigned long j = 0; j < feats_changes[l].size(); ++j)
+                        {
+                            impl::update_filtered_fhog(*w[i], feats[l], feats_changes[l][j], item.saliency[l],
+                                saliency_crop, saliency_crop_out, scratch);
+                        }
+                    }
+                }
+                else
+                {
+                    if (item.saliency.max_size() < feats.size())
+                        item.saliency.set_max_size(feats.size());
+                    item.saliency.set_size(feats.size());
+                    item.area.resize(feats.size());
+                    for (unsigned long l = 0; l < feats.size(); ++l)
+                        item.area[l] = impl::apply_filters_to_fhog(*w[i], feats[l], item.saliency[l], scratch);
+                }
+                item.feats_version = feats_version;
+            }
+
+            dets[i].clear();
+            for (unsigned long l = 0; l < feats.size(); ++l)
+            {
+                impl::find_fhog_detections<pyramid_type>(item.saliency[l], item.area[l], l, fe, thresh[i],
+                    height-2*padding, width-2*padding, cell_size, height, width, dets[i]);
+            }
+            std::sort(dets[i].rbegin(), dets[i].rend(), impl::compare_pair_rect);
+        }
+        saliency_cache.swap(cache);
+    }
+
 // ----------------------------------------------------------------------------------------
 
     template <
@@ -1213,6 +2422,26 @@ namespace dlib
 
     };
 
+    template <
+        typename Pyramid_type,
+        typename feature_extractor_type
+        >
+    void detect_with_weight_vectors (
+        scan_fhog_pyramid<Pyramid_type,feature_extractor_type>& scanner,
+        const std::vector<processed_weight_vector<scan_fhog_pyramid<Pyramid_type,feature_extractor_type> > >& w,
+        const std::vector<double>& thresh,
+        std::vector<std::vector<std::pair<double, rectangle> > >& dets
+    )
+    {
+        // hand all the filter banks to the scanner at once so it can spread them over its
+        // threads
+        typedef typename scan_fhog_pyramid<Pyramid_type,feature_extractor_type>::fhog_filterbank fhog_filterbank;
+        std::vector<const fhog_filterbank*> banks(w.size());
+        for (unsigned long i = 0; i < w.size(); ++i)
+            banks[i] = &w[i].get_detect_argument();
+        scanner.detect(banks, thresh, dets);
+    }
+
 // ----------------------------------------------------------------------------------------
 // ----------------------------------------------------------------------------------------
 
@@ -276,6 +276,31 @@ namespace dlib
                 - #is_loaded_with_image() == true
                 - This object is ready to run a classifier over img to detect object
                   locations.  Call detect() to do this.
+                - With a single thread, pyramid_down<N> for N > 3, the default feature
+                  extractor, cell sizes above 1 and an array2d of grayscale or RGB pixels,
+                  the downsampled pyramid levels are never stored.  Their rows go straight
+                  into the fHOG extraction instead, which gives the same features.
+        !*/
+
+        void load (
+            const scan_fhog_pyramid& item
+        );
+        /*!
+            requires
+                - item.is_loaded_with_image() == true
+                - item uses the same cell size, padding, detection window size and
+                  pyramid layer settings as *this.
+            ensures
+                - #is_loaded_with_image() == true
+                - Copies the feature pyramid item computed for its image into *this, so
+                  this object is ready to run a classifier over that image.  The rest of
+                  this object's configuration (e.g. the nuclear norm regularization
+                  strength) is left untouched.
+                - Since scanners load their images through load(), an array of loaded
+                  scanners can be handed to structural_object_detection_trainer,
+                  test_object_detection_function() or object_detector in place of the
+                  images.  This way the feature pyramids are computed once and then reused
+                  by many training runs.
         !*/
 
         const feature_extractor_type& get_feature_extractor(
@@ -307,6 +332,66 @@ namespace dlib
                     S2.load(img);
         !*/
 
+        void set_num_threads (
+            unsigned long num
+        );
+        /*!
+            ensures
+                - #get_num_threads() == num
+        !*/
+
+        unsigned long get_num_threads (
+        ) const;
+        /*!
+            ensures
+                - returns the number of threads load(img) uses to build the feature pyramid.
+                  When it is bigger than 1 the calling thread downsamples the image while a
+                  thread pool of this size owned by this object extracts the features of
+                  the levels that are already done, with big levels split into tiles of
+                  rows.  The feature pyramid is identical to the single threaded one.  The
+                  downsampled images are kept between calls to load(img), so loading images
+                  of the same size doesn't allocate them again.
+                - The detect() that takes several filter banks uses the same thread pool
+                  to run them over all the pyramid levels at once.  object_detector uses
+                  it, so a detector whose scanner has more than one thread also runs its
+                  filters in parallel.
+                - The default is 1.  Objects that are loaded in parallel with each other,
+                  like the scanners of structural_object_detection_trainer, get this value
+                  through copy_configuration() as well, so it should usually stay at 1 for
+                  training.
+        !*/
+
+        void set_loads_incrementally (
+            bool enabled
+        );
+        /*!
+            ensures
+                - #loads_incrementally() == enabled
+        !*/
+
+        bool loads_incrementally (
+        ) const;
+        /*!
+            ensures
+                - returns true if load(img) reuses the work of the previous call.  This is
+                  meant for video from a static camera, where most of each frame is the
+                  same as the one before.  When it's true, load(img) keeps a copy of the
+                  image and of every downsampled level, compares the new ones with them in
+                  tiles, and only extracts the HOG cells near the tiles that changed.  The
+                  detect() that takes several filter banks in turn keeps the saliency
+                  images of each filter bank and only refilters the parts that depend on
+                  the changed cells.  The results are identical to loading and scanning
+                  the whole image.
+                - Only the default feature extractor with a cell size bigger than 1 is
+                  updated this way.  Other configurations, and images of a different size
+                  than the previous one, do a normal load.
+                - The incremental detect() runs on the calling thread.  When most of the
+                  image changes it costs about as much as a normal one.
+                - This needs roughly two more copies of the image pyramid and one saliency
+                  pyramid per filter bank, so it is off by default.  It is copied by
+                  copy_configuration().
+        !*/
+
         void set_detection_window_size (
             unsigned long window_width,
             unsigned long window_height
@@ -578,6 +663,28 @@ namespace dlib
                   then it is reported in #dets.
         !*/
 
+        void detect (
+            const std::vector<const fhog_filterbank*>& w,
+            const std::vector<double>& thresh,
+            std::vector<std::vector<std::pair<double, rectangle> > >& dets
+        );
+        /*!
+            requires
+                - w.size() == thresh.size()
+                - for all valid i: w[i]->get_num_dimensions() == get_num_dimensions()
+                - is_loaded_with_image() == true
+            ensures
+                - #dets.size() == w.size()
+                - for all valid i: #dets[i] == the output of detect(*w[i], dets[i], thresh[i])
+                - When get_num_threads() > 1 every (filter bank, pyramid level) pair is
+                  a separate job for the thread pool, and each thread filters into its own
+                  saliency image, which is kept for the next call.  The output is the same
+                  as the single threaded one.
+                - Unlike the other detect() functions this one modifies the thread pool and
+                  buffers of this object, so it must not be called on the same object from
+                  several threads at once.
+        !*/
+
         void detect (
             const feature_vector_type& w,
             std::vector<std::pair<double, rectangle> >& dets,
@@ -13,6 +13,8 @@
 #include "interpolation.h"
 #include "../simd/simd4i.h"
 #include "../simd/simd4f.h"
+#include "../simd/simd8i.h"
+#include "../simd/simd8f.h"
 
 namespace dlib
 {
@@ -192,6 +194,337 @@ namespace dlib
             len = (grad_x*grad_x + grad_y*grad_y);
         }
 
+    // ------------------------------------------------------------------------------------
+
+        template <typename pixel_type>
+        inline void load_rgb_pixels (
+            const pixel_type* p,
+            simd8i& red,
+            simd8i& green,
+            simd8i& blue
+        )
+        {
+            red = simd8i(p[0].red, p[1].red, p[2].red, p[3].red,
+                         p[4].red, p[5].red, p[6].red, p[7].red);
+            green = simd8i(p[0].green, p[1].green, p[2].green, p[3].green,
+                           p[4].green, p[5].green, p[6].green, p[7].green);
+            blue = simd8i(p[0].blue, p[1].blue, p[2].blue, p[3].blue,
+                          p[4].blue, p[5].blue, p[6].blue, p[7].blue);
+        }
+
+        template <typename pixel_type>
+        inline void load_gray_pixels (
+            const pixel_type* p,
+            simd8i& gray
+        )
+        {
+            gray = simd8i((int)get_pixel_intensity(p[0]), (int)get_pixel_intensity(p[1]),
+                          (int)get_pixel_intensity(p[2]), (int)get_pixel_intensity(p[3]),
+                          (int)get_pixel_intensity(p[4]), (int)get_pixel_intensity(p[5]),
+                          (int)get_pixel_intensity(p[6]), (int)get_pixel_intensity(p[7]));
+        }
+
+#ifdef DLIB_HAVE_AVX2
+        inline void deinterleave_8_pixels (
+            const unsigned char* p,
+            simd8i& c0,
+            simd8i& c1,
+            simd8i& c2
+        )
+        {
+            // 8 interleaved 3 byte pixels are 24 bytes.  Load exactly those, so the last
+            // pixels of an image are safe to read, and pick each channel out with byte
+            // shuffles.  Bytes 0-15 come from lo and bytes 16-23 from hi.
+            const __m128i lo = _mm_loadu_si128((const __m128i*)p);
+            const __m128i hi = _mm_loadl_epi64((const __m128i*)(p+16));
+            const char z = -128;
+            c0 = _mm256_cvtepu8_epi32(_mm_or_si128(
+                    _mm_shuffle_epi8(lo, _mm_setr_epi8(0,3,6,9,12,15,z,z, z,z,z,z,z,z,z,z)),
+                    _mm_shuffle_epi8(hi, _mm_setr_epi8(z,z,z,z,z,z,2,5, z,z,z,z,z,z,z,z))));
+            c1 = _mm256_cvtepu8_epi32(_mm_or_si128(
+                    _mm_shuffle_epi8(lo, _mm_setr_epi8(1,4,7,10,13,z,z,z, z,z,z,z,z,z,z,z)),
+                    _mm_shuffle_epi8(hi, _mm_setr_epi8(z,z,z,z,z,0,3,6, z,z,z,z,z,z,z,z))));
+            c2 = _mm256_cvtepu8_epi32(_mm_or_si128(
+                    _mm_shuffle_epi8(lo, _mm_setr_epi8(2,5,8,11,14,z,z,z, z,z,z,z,z,z,z,z)),
+                    _mm_shuffle_epi8(hi, _mm_setr_epi8(z,z,z,z,z,1,4,7, z,z,z,z,z,z,z,z))));
+        }
+
+        inline void load_rgb_pixels (
+            const rgb_pixel* p,
+            simd8i& red,
+            simd8i& green,
+            simd8i& blue
+        )
+        {
+            COMPILE_TIME_ASSERT(sizeof(rgb_pixel) == 3);
+            deinterleave_8_pixels((const unsigned char*)p, red, green, blue);
+        }
+
+        inline void load_rgb_pixels (
+            const bgr_pixel* p,
+            simd8i& red,
+            simd8i& green,
+            simd8i& blue
+        )
+        {
+            COMPILE_TIME_ASSERT(sizeof(bgr_pixel) == 3);
+            deinterleave_8_pixels((const unsigned char*)p, blue, green, red);
+        }
+
+        inline void load_gray_pixels (
+            const unsigned char* p,
+            simd8i& gray
+        )
+        {
+            gray = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)p));
+        }
+#endif
+
+        template <typename image_type>
+        inline typename dlib::enable_if_c<pixel_traits<typename image_type::pixel_type>::rgb>::type get_gradient (
+            const int r,
+            const int c,
+            const image_type& img,
+            simd8f& grad_x,
+            simd8f& grad_y,
+            simd8f& len
+        )
+        {
+            simd8i rleft, gleft, bleft;
+            simd8i rright, gright, bright;
+            simd8i rtop, gtop, btop;
+            simd8i rbottom, gbottom, bbottom;
+            load_rgb_pixels(&img[r][c-1], rleft, gleft, bleft);
+            load_rgb_pixels(&img[r][c+1], rright, gright, bright);
+            load_rgb_pixels(&img[r-1][c], rtop, gtop, btop);
+            load_rgb_pixels(&img[r+1][c], rbottom, gbottom, bbottom);
+
+            simd8i grad_x_red   = rright-rleft;
+            simd8i grad_y_red   = rbottom-rtop;
+            simd8i grad_x_green = gright-gleft;
+            simd8i grad_y_green = gbottom-gtop;
+            simd8i grad_x_blue  = bright-bleft;
+            simd8i grad_y_blue  = bbottom-btop;
+
+            simd8i rlen = grad_x_red*grad_x_red + grad_y_red*grad_y_red;
+            simd8i glen = grad_x_green*grad_x_green + grad_y_green*grad_y_green;
+            simd8i blen = grad_x_blue*grad_x_blue + grad_y_blue*grad_y_blue;
+
+            simd8i cmp = rlen>glen;
+            simd8i tgrad_x = select(cmp,grad_x_red,grad_x_green);
+            simd8i tgrad_y = select(cmp,grad_y_red,grad_y_green);
+            simd8i tlen = select(cmp,rlen,glen);
+
+            cmp = tlen>blen;
+            grad_x = select(cmp,tgrad_x,grad_x_blue);
+            grad_y = select(cmp,tgrad_y,grad_y_blue);
+            len = select(cmp,tlen,blen);
+        }
+
+        template <typename image_type>
+        inline typename dlib::disable_if_c<pixel_traits<typename image_type::pixel_type>::rgb>::type get_gradient (
+            const int r,
+            const int c,
+            const image_type& img,
+            simd8f& grad_x,
+            simd8f& grad_y,
+            simd8f& len
+        )
+        {
+            simd8i left, right, top, bottom;
+            load_gray_pixels(&img[r][c-1], left);
+            load_gray_pixels(&img[r][c+1], right);
+            load_gray_pixels(&img[r-1][c], top);
+            load_gray_pixels(&img[r+1][c], bottom);
+
+            grad_x = right-left;
+            grad_y = bottom-top;
+
+            len = (grad_x*grad_x + grad_y*grad_y);
+        }
+
+    // ------------------------------------------------------------------------------------
+
+        template <typename simd_type> struct simd_types;
+        template <> struct simd_types<simd4f> { typedef simd4i int_type; typedef simd4f_bool bool_type; };
+        template <> struct simd_types<simd8f> { typedef simd8i int_type; typedef simd8f_bool bool_type; };
+
+        template <typename simd_type>
+        inline void snap_to_orientation (
+            const simd_type& grad_x,
+            const simd_type& grad_y,
+            const matrix<double,2,1> (&directions)[9],
+            int32* best_orientation
+        )
+        /*!
+            ensures
+                - stores the index of the closest of the 18 orientations to each gradient
+                  into best_orientation[0] through best_orientation[grad_x.size()-1].
+        !*/
+        {
+            typedef typename simd_types<simd_type>::bool_type bool_type;
+            typedef typename simd_types<simd_type>::int_type int_type;
+            simd_type best_dot = 0;
+            simd_type best_o = 0;
+            for (int o = 0; o < 9; o++) 
+            {
+                simd_type dot = grad_x*directions[o](0) + grad_y*directions[o](1);
+                bool_type cmp = dot>best_dot;
+                best_dot = select(cmp,dot,best_dot); 
+                dot *= -1;
+                best_o = select(cmp,o,best_o);
+
+                cmp = dot>best_dot;
+                best_dot = select(cmp,dot,best_dot);
+                best_o = select(cmp,o+9,best_o);
+            }
+            int_type(best_o).store(best_orientation);
+        }
+
+        template <typename simd_type, typename image_type>
+        inline void snap_gradients (
+            const int y,
+            const int x,
+            const image_type& img,
+            const matrix<double,2,1> (&directions)[9],
+            array2d<float>& norm,
+            array2d<unsigned char>& angle
+        )
+        /*!
+            ensures
+                - stores the squared gradient length and orientation of the pixels
+                  x through x+simd_type::size()-1 of row y into norm and angle.
+        !*/
+        {
+            const unsigned long n = sizeof(simd_type)/sizeof(float);
+            // v will be the length of the gradient vectors.
+            simd_type grad_x, grad_y, v;
+            get_gradient(y,x,img,grad_x,grad_y,v);
+            v.store(&norm[y][x]);
+
+            int32 best_o[8];
+            snap_to_orientation(grad_x, grad_y, directions, best_o);
+            for (unsigned long i = 0; i < n; ++i)
+                angle[y][x+i] = best_o[i];
+        }
+
+        template <typename simd_type, typename image_type>
+        inline void bin_gradients (
+            const int y,
+            const int x,
+            const image_type& img,
+            const int cell_size,
+            const matrix<double,2,1> (&directions)[9],
+            const double vy0,
+            const double vy1,
+            matrix<float,18,1>* hist_row0,
+            matrix<float,18,1>* hist_row1
+        )
+        /*!
+            ensures
+                - adds the gradients of the pixels x through x+simd_type::size()-1 of row
+                  y to the histograms of the cells around them, hist_row0 and hist_row1
+                  being the histogram rows above and below the pixels.
+        !*/
+        {
+            typedef typename simd_types<simd_type>::int_type int_type;
+            const unsigned long n = sizeof(simd_type)/sizeof(float);
+            float _xx[8];
+            for (unsigned long i = 0; i < n; ++i)
+                _xx[i] = x+i;
+            simd_type xx;
+            xx.load(_xx);
+            // v will be the length of the gradient vectors.
+            simd_type grad_x, grad_y, v;
+            get_gradient(y,x,img,grad_x,grad_y,v);
+
+            // We will use bilinear interpolation to add into the histogram bins.
+            // So first we precompute the values needed to determine how much each
+            // pixel votes into each bin.
+            simd_type xp = (xx+0.5)/(float)cell_size + 0.5;
+            int_type ixp = int_type(xp);
+            simd_type vx0 = xp-simd_type(ixp);
+            simd_type vx1 = 1.0f-vx0;
+
+            v = sqrt(v);
+
+            // Now snap the gradient to one of 18 orientations
+            int32 _best_o[8];
+            snap_to_orientation(grad_x, grad_y, directions, _best_o);
+
+            // Add the gradient magnitude, v, to 4 histograms around pixel using
+            // bilinear interpolation.
+            vx1 *= v;
+            vx0 *= v;
+            // The amounts for each bin
+            simd_type v11 = vy1*vx1;
+            simd_type v01 = vy0*vx1;
+            simd_type v10 = vy1*vx0;
+            simd_type v00 = vy0*vx0;
+
+            int32 _ixp[8];    ixp.store(_ixp);
+            float _v11[8];    v11.store(_v11);
+            float _v01[8];    v01.store(_v01);
+            float _v10[8];    v10.store(_v10);
+            float _v00[8];    v00.store(_v00);
+
+            // The bins different pixels vote into can collide, so this part stays scalar.
+            for (unsigned long i = 0; i < n; ++i)
+            {
+                hist_row0[_ixp[i]  ](_best_o[i]) += _v11[i];
+                hist_row1[_ixp[i]  ](_best_o[i]) += _v01[i];
+                hist_row0[_ixp[i]+1](_best_o[i]) += _v10[i];
+                hist_row1[_ixp[i]+1](_best_o[i]) += _v00[i];
+            }
+        }
+
+    // ------------------------------------------------------------------------------------
+
+        inline void compute_block_normalizers (
+            const array2d<float>& norm,
+            array2d<float>& block_nn,
+            array2d<float>& block_n
+        )
+        /*!
+            requires
+                - norm.nr() > 1 && norm.nc() > 1
+            ensures
+                - #block_nn[y][x] == the clipping value of the 2x2 block of cells whose top
+                  left cell is norm[y][x], and #block_n[y][x] the factor features
+                  normalized by that block are scaled by.  Every feature cell is normalized
+                  by 4 overlapping blocks, so this does the work once per block instead of
+                  once per cell.  The sums are taken in the order the per cell version
+                  uses, so the results are the same to the bit.
+                - #block_nn.nr() == #block_n.nr() == norm.nr()-1
+                - #block_nn.nc() == #block_n.nc() == norm.nc()-1
+        !*/
+        {
+            const float eps = 0.0001;
+            block_nn.set_size(norm.nr()-1, norm.nc()-1);
+            block_n.set_size(norm.nr()-1, norm.nc()-1);
+            for (long y = 0; y < block_nn.nr(); ++y)
+            {
+                long x = 0;
+                for (; x+8 <= block_nn.nc(); x += 8)
+                {
+                    simd8f tl, tr, bl, br;
+                    tl.load(&norm[y][x]);
+                    tr.load(&norm[y][x+1]);
+                    bl.load(&norm[y+1][x]);
+                    br.load(&norm[y+1][x+1]);
+                    const simd8f nn = 0.2f*sqrt(tl+tr+bl+br+eps);
+                    nn.store(&block_nn[y][x]);
+                    (0.1f/nn).store(&block_n[y][x]);
+                }
+                for (; x < block_nn.nc(); ++x)
+                {
+                    const float nn = 0.2f*std::sqrt(norm[y][x]+norm[y][x+1]+norm[y+1][x]+norm[y+1][x+1]+eps);
+                    block_nn[y][x] = nn;
+                    block_n[y][x] = 0.1f/nn;
+                }
+            }
+        }
+
     // ------------------------------------------------------------------------------------
 
         template <typename T, typename mm1, typename mm2>
@@ -376,44 +709,10 @@ namespace dlib
             for (int y = 1; y < visible_nr; y++) 
             {
                 int x;
-                for (x = 1; x < visible_nc-3; x+=4) 
-                {
-                    // v will be the length of the gradient vectors.
-                    simd4f grad_x, grad_y, v;
-                    get_gradient(y,x,img,grad_x,grad_y,v);
-
-                    float _vv[4];
-                    v.store(_vv);
-
-                    // Now snap the gradient to one of 18 orientations
-                    simd4f best_dot = 0;
-                    simd4f best_o = 0;
-                    for (int o = 0; o < 9; o++) 
-                    {
-                        simd4f dot = grad_x*directions[o](0) + grad_y*directions[o](1);
-                        simd4f_bool cmp = dot>best_dot;
-                        best_dot = select(cmp,dot,best_dot); 
-                        dot *= -1;
-                        best_o = select(cmp,o,best_o);
-
-                        cmp = dot>best_dot;
-                        best_dot = select(cmp,dot,best_dot);
-                        best_o = select(cmp,o+9,best_o);
-                    }
-
-                    int32 _best_o[4]; simd4i(best_o).store(_best_o);
-
-                    norm[y][x+0] = _vv[0];
-                    norm[y][x+1] = _vv[1];
-                    norm[y][x+2] = _vv[2];
-                    norm[y][x+3] = _vv[3];
-
-                    angle[y][x+0] = _best_o[0];
-                    angle[y][x+1] = _best_o[1];
-                    angle[y][x+2] = _best_o[2];
-                    angle[y][x+3] = _best_o[3];
-
-                }
+                for (x = 1; x < visible_nc-7; x+=8) 
+                    snap_gradients<simd8f>(y,x,img,directions,norm,angle);
+                for (; x < visible_nc-3; x+=4) 
+                    snap_gradients<simd4f>(y,x,img,directions,norm,angle);
                 // Now process the right columns that don't fit into simd registers.
                 for (; x < visible_nc; x++) 
                 {
@@ -445,6 +744,7 @@ namespace dlib
             }
 
             const double eps = 0.0001;
+
             // compute features
             for (int y = 0; y < hog_nr; y++) 
             {
@@ -504,75 +804,68 @@ namespace dlib
 
     // ------------------------------------------------------------------------------------
 
+        template <
+            typename out_type
+            >
+        long init_fhog_rows(
+            long nr,
+            long nc,
+            out_type& hog, 
+            int cell_size,
+            int filter_rows_padding,
+            int filter_cols_padding
+        ) 
+        /*!
+            ensures
+                - init_fhog_rows() below for an nr by nc image
+        !*/
+        {
+            const int cells_nr = (int)((double)nr/(double)cell_size + 0.5);
+            const int cells_nc = (int)((double)nc/(double)cell_size + 0.5);
+            const int hog_nr = std::max(cells_nr-2, 0);
+            const int hog_nc = std::max(cells_nc-2, 0);
+            if (hog_nr == 0 || hog_nc == 0)
+            {
+                hog.clear();
+                return 0;
+            }
+            init_hog(hog, hog_nr, hog_nc, filter_rows_padding, filter_cols_padding);
+            return hog_nr;
+        }
+
         template <
             typename image_type, 
             typename out_type
             >
-        void impl_extract_fhog_features(
+        long init_fhog_rows(
             const image_type& img_, 
             out_type& hog, 
             int cell_size,
             int filter_rows_padding,
             int filter_cols_padding
         ) 
+        /*!
+            requires
+                - cell_size > 1
+            ensures
+                - sizes hog for the features of img and zeros its padding, like
+                  impl_extract_fhog_features() does, and returns the number of feature rows
+                  impl_extract_fhog_rows() fills in.
+                - if img is too small to have any features then hog is cleared and 0 is
+                  returned.
+        !*/
         {
             const_image_view<image_type> img(img_);
-            // make sure requires clause is not broken
-            DLIB_ASSERT( cell_size > 0 &&
-                         filter_rows_padding > 0 &&
-                         filter_cols_padding > 0 ,
-                "\t void extract_fhog_features()"
-                << "\n\t Invalid inputs were given to this function. "
-                << "\n\t cell_size: " << cell_size 
-                << "\n\t filter_rows_padding: " << filter_rows_padding 
-                << "\n\t filter_cols_padding: " << filter_cols_padding 
-                );
-
-            /*
-                This function implements the HOG feature extraction method described in 
-                the paper:
-                    P. Felzenszwalb, R. Girshick, D. McAllester, D. Ramanan
-                    Object Detection with Discriminatively Trained Part Based Models
-                    IEEE Transactions on Pattern Analysis and Machine Intelligence, Vol. 32, No. 9, Sep. 2010
-
-                Moreover, this function is derived from the HOG feature extraction code
-                from the features.cc file in the voc-releaseX code (see
-                http://people.cs.uchicago.edu/~rbg/latent/) which is has the following
-                license (note that the code has been modified to work with grayscale and
-                color as well as planar and interlaced input and output formats):
-
-                Copyright (C) 2011, 2012 Ross Girshick, Pedro Felzenszwalb
-                Copyright (C) 2008, 2009, 2010 Pedro Felzenszwalb, Ross Girshick
-                Copyright (C) 2007 Pedro Felzenszwalb, Deva Ramanan
-
-                Permission is hereby granted, free of charge, to any person obtaining
-                a copy of this software and associated documentation files (the
-                "Software"), to deal in the Software without restriction, including
-                without limitation the rights to use, copy, modify, merge, publish,
-                distribute, sublicense, and/or sell copies of the Software, and to
-                permit persons to whom the Software is furnished to do so, subject to
-                the following conditions:
-
-                The above copyright notice and this permission notice shall be
-                included in all copies or substantial portions of the Software.
-
-                THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
-                EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
-                MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
-                NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
-                LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
-                OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
-                WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
-            */
+            return init_fhog_rows(img.nr(), img.nc(), hog, cell_size, filter_rows_padding, filter_cols_padding);
+        }
 
-            if (cell_size == 1)
-            {
-                impl_extract_fhog_features_cell_size_1(img_,hog,filter_rows_padding,filter_cols_padding);
-                return;
-            }
+    // ------------------------------------------------------------------------------------
 
+        inline void init_fhog_directions (
+            matrix<double,2,1> (&directions)[9]
+        )
+        {
             // unit vectors used to compute gradient orientation
-            matrix<double,2,1> directions[9];
             directions[0] =  1.0000, 0.0000; 
             directions[1] =  0.9397, 0.3420;
             directions[2] =  0.7660, 0.6428;
@@ -582,220 +875,155 @@ namespace dlib
             directions[6] = -0.5000, 0.8660;
             directions[7] = -0.7660, 0.6428;
             directions[8] = -0.9397, 0.3420;
+        }
 
-
-
-            // First we allocate memory for caching orientation histograms & their norms.
-            const int cells_nr = (int)((double)img.nr()/(double)cell_size + 0.5);
-            const int cells_nc = (int)((double)img.nc()/(double)cell_size + 0.5);
-
-            if (cells_nr == 0 || cells_nc == 0)
-            {
-                hog.clear();
-                return;
-            }
-
-            // We give hist extra padding around the edges (1 cell all the way around the
-            // edge) so we can avoid needing to do boundary checks when indexing into it
-            // later on.  So some statements assign to the boundary but those values are
-            // never used.
-            array2d<matrix<float,18,1> > hist(cells_nr+2, cells_nc+2);
-            for (long r = 0; r < hist.nr(); ++r)
+        template <
+            typename image_type
+            >
+        void bin_fhog_row (
+            const image_type& img,
+            const int y,
+            const int visible_nc,
+            const int cell_size,
+            const matrix<double,2,1> (&directions)[9],
+            const double vy0,
+            const double vy1,
+            matrix<float,18,1>* hist_row0,
+            matrix<float,18,1>* hist_row1,
+            const int x_begin = 1,
+            const int x_end = std::numeric_limits<int>::max()
+        )
+        /*!
+            requires
+                - img[r] is a pointer to the pixels of row r of the image for r in
+                  [y-1, y+1]
+            ensures
+                - adds the gradients of pixel row y to the histograms of the cells around
+                  them, hist_row0 and hist_row1 being the histogram rows above and below.
+                - Only the pixels in columns [x_begin, x_end) are needed, but they are
+                  processed in the same groups as for the whole row, so every histogram
+                  they vote into gets the same sums to the bit.  The groups at either end
+                  may vote into cells a few pixels beyond the range.
+        !*/
+        {
+            int x = 1 + std::max(x_begin-1, 0)/8*8;
+            for (; x < visible_nc-7 && x < x_end; x+=8) 
+                bin_gradients<simd8f>(y,x,img,cell_size,directions,vy0,vy1,hist_row0,hist_row1);
+            for (; x < visible_nc-3 && x < x_end; x+=4) 
+                bin_gradients<simd4f>(y,x,img,cell_size,directions,vy0,vy1,hist_row0,hist_row1);
+            // Now process the right columns that don't fit into simd registers.
+            for (; x < visible_nc && x < x_end; x++) 
             {
-                for (long c = 0; c < hist.nc(); ++c)
+                matrix<double,2,1> grad;
+                double v;
+                get_gradient(y,x,img,grad,v);
+
+                // snap to one of 18 orientations
+                double best_dot = 0;
+                int best_o = 0;
+                for (int o = 0; o < 9; o++) 
                 {
-                    hist[r][c] = 0;
+                    const double dot = dlib::dot(directions[o], grad); 
+                    if (dot > best_dot) 
+                    {
+                        best_dot = dot;
+                        best_o = o;
+                    } 
+                    else if (-dot > best_dot) 
+                    {
+                        best_dot = -dot;
+                        best_o = o+9;
+                    }
                 }
+
+                v = std::sqrt(v);
+                // add to 4 histograms around pixel using bilinear interpolation
+                const double xp = ((double)x+0.5)/(double)cell_size - 0.5;
+                const int ixp = (int)std::floor(xp);
+                const double vx0 = xp-ixp;
+                const double vx1 = 1.0-vx0;
+
+                hist_row0[ixp+1](best_o) += vy1*vx1*v;
+                hist_row1[ixp+1](best_o) += vy0*vx1*v;
+                hist_row0[ixp+1+1](best_o) += vy1*vx0*v;
+                hist_row1[ixp+1+1](best_o) += vy0*vx0*v;
             }
+        }
 
-            array2d<float> norm(cells_nr, cells_nc);
+        template <
+            typename out_type
+            >
+        void fhog_features_from_hist (
+            const array2d<matrix<float,18,1> >& hist,
+            out_type& hog, 
+            int filter_rows_padding,
+            int filter_cols_padding,
+            long row_begin,
+            long row_end,
+            long col_begin,
+            long col_end
+        )
+        /*!
+            requires
+                - hist holds the cell histograms (with their 1 cell border) feature rows
+                  [row_begin,row_end) depend on, starting at the histogram row of feature
+                  row row_begin.  So hist.nr() >= row_end-row_begin+3.  Its columns cover
+                  the whole image.
+            ensures
+                - normalizes the histograms and writes the features in rows
+                  [row_begin,row_end) and columns [col_begin,col_end) of hog.
+        !*/
+        {
+            // Feature column x depends on the cell columns x to x+2.
+            array2d<float> norm(row_end-row_begin+2, col_end-col_begin+2);
             assign_all_pixels(norm, 0);
 
-            // memory for HOG features
-            const int hog_nr = std::max(cells_nr-2, 0);
-            const int hog_nc = std::max(cells_nc-2, 0);
-            if (hog_nr == 0 || hog_nc == 0)
-            {
-                hog.clear();
-                return;
-            }
             const int padding_rows_offset = (filter_rows_padding-1)/2;
             const int padding_cols_offset = (filter_cols_padding-1)/2;
-            init_hog(hog, hog_nr, hog_nc, filter_rows_padding, filter_cols_padding);
-
-            const int visible_nr = std::min((long)cells_nr*cell_size,img.nr())-1;
-            const int visible_nc = std::min((long)cells_nc*cell_size,img.nc())-1;
-
-            // First populate the gradient histograms
-            for (int y = 1; y < visible_nr; y++) 
-            {
-                const double yp = ((double)y+0.5)/(double)cell_size - 0.5;
-                const int iyp = (int)std::floor(yp);
-                const double vy0 = yp-iyp;
-                const double vy1 = 1.0-vy0;
-                int x;
-                for (x = 1; x < visible_nc-3; x+=4) 
-                {
-                    simd4f xx(x,x+1,x+2,x+3);
-                    // v will be the length of the gradient vectors.
-                    simd4f grad_x, grad_y, v;
-                    get_gradient(y,x,img,grad_x,grad_y,v);
-
-                    // We will use bilinear interpolation to add into the histogram bins.
-                    // So first we precompute the values needed to determine how much each
-                    // pixel votes into each bin.
-                    simd4f xp = (xx+0.5)/(float)cell_size + 0.5;
-                    simd4i ixp = simd4i(xp);
-                    simd4f vx0 = xp-ixp;
-                    simd4f vx1 = 1.0f-vx0;
-
-                    v = sqrt(v);
-
-                    // Now snap the gradient to one of 18 orientations
-                    simd4f best_dot = 0;
-                    simd4f best_o = 0;
-                    for (int o = 0; o < 9; o++) 
-                    {
-                        simd4f dot = grad_x*directions[o](0) + grad_y*directions[o](1);
-                        simd4f_bool cmp = dot>best_dot;
-                        best_dot = select(cmp,dot,best_dot); 
-                        dot *= -1;
-                        best_o = select(cmp,o,best_o);
-
-                        cmp = dot>best_dot;
-                        best_dot = select(cmp,dot,best_dot);
-                        best_o = select(cmp,o+9,best_o);
-                    }
-
-
-                    // Add the gradient magnitude, v, to 4 histograms around pixel using
-                    // bilinear interpolation.
-                    vx1 *= v;
-                    vx0 *= v;
-                    // The amounts for each bin
-                    simd4f v11 = vy1*vx1;
-                    simd4f v01 = vy0*vx1;
-                    simd4f v10 = vy1*vx0;
-                    simd4f v00 = vy0*vx0;
-
-                    int32 _best_o[4]; simd4i(best_o).store(_best_o);
-                    int32 _ixp[4];    ixp.store(_ixp);
-                    float _v11[4];    v11.store(_v11);
-                    float _v01[4];    v01.store(_v01);
-                    float _v10[4];    v10.store(_v10);
-                    float _v00[4];    v00.store(_v00);
-
-                    hist[iyp+1]  [_ixp[0]  ](_best_o[0]) += _v11[0];
-                    hist[iyp+1+1][_ixp[0]  ](_best_o[0]) += _v01[0];
-                    hist[iyp+1]  [_ixp[0]+1](_best_o[0]) += _v10[0];
-                    hist[iyp+1+1][_ixp[0]+1](_best_o[0]) += _v00[0];
-
-                    hist[iyp+1]  [_ixp[1]  ](_best_o[1]) += _v11[1];
-                    hist[iyp+1+1][_ixp[1]  ](_best_o[1]) += _v01[1];
-                    hist[iyp+1]  [_ixp[1]+1](_best_o[1]) += _v10[1];
-                    hist[iyp+1+1][_ixp[1]+1](_best_o[1]) += _v00[1];
-
-                    hist[iyp+1]  [_ixp[2]  ](_best_o[2]) += _v11[2];
-                    hist[iyp+1+1][_ixp[2]  ](_best_o[2]) += _v01[2];
-                    hist[iyp+1]  [_ixp[2]+1](_best_o[2]) += _v10[2];
-                    hist[iyp+1+1][_ixp[2]+1](_best_o[2]) += _v00[2];
-
-                    hist[iyp+1]  [_ixp[3]  ](_best_o[3]) += _v11[3];
-                    hist[iyp+1+1][_ixp[3]  ](_best_o[3]) += _v01[3];
-                    hist[iyp+1]  [_ixp[3]+1](_best_o[3]) += _v10[3];
-                    hist[iyp+1+1][_ixp[3]+1](_best_o[3]) += _v00[3];
-                }
-                // Now process the right columns that don't fit into simd registers.
-                for (; x < visible_nc; x++) 
-                {
-                    matrix<double,2,1> grad;
-                    double v;
-                    get_gradient(y,x,img,grad,v);
-
-                    // snap to one of 18 orientations
-                    double best_dot = 0;
-                    int best_o = 0;
-                    for (int o = 0; o < 9; o++) 
-                    {
-                        const double dot = dlib::dot(directions[o], grad); 
-                        if (dot > best_dot) 
-                        {
-                            best_dot = dot;
-                            best_o = o;
-                        } 
-                        else if (-dot > best_dot) 
-                        {
-                            best_dot = -dot;
-                            best_o = o+9;
-                        }
-                    }
-
-                    v = std::sqrt(v);
-                    // add to 4 histograms around pixel using bilinear interpolation
-                    const double xp = ((double)x+0.5)/(double)cell_size - 0.5;
-                    const int ixp = (int)std::floor(xp);
-                    const double vx0 = xp-ixp;
-                    const double vx1 = 1.0-vx0;
-
-                    hist[iyp+1][ixp+1](best_o) += vy1*vx1*v;
-                    hist[iyp+1+1][ixp+1](best_o) += vy0*vx1*v;
-                    hist[iyp+1][ixp+1+1](best_o) += vy1*vx0*v;
-                    hist[iyp+1+1][ixp+1+1](best_o) += vy0*vx0*v;
-                }
-            }
 
             // compute energy in each block by summing over orientations
-            for (int r = 0; r < cells_nr; ++r)
+            for (int r = 0; r < norm.nr(); ++r)
             {
-                for (int c = 0; c < cells_nc; ++c)
+                for (int c = 0; c < norm.nc(); ++c)
                 {
+                    const matrix<float,18,1>& h = hist[r+1][c+col_begin+1];
                     for (int o = 0; o < 9; o++) 
                     {
-                        norm[r][c] += (hist[r+1][c+1](o) + hist[r+1][c+1](o+9)) * (hist[r+1][c+1](o) + hist[r+1][c+1](o+9));
+                        norm[r][c] += (h(o) + h(o+9)) * (h(o) + h(o+9));
                     }
                 }
             }
 
-            const double eps = 0.0001;
+            array2d<float> block_nn, block_n;
+            compute_block_normalizers(norm, block_nn, block_n);
+
             // compute features
-            for (int y = 0; y < hog_nr; y++) 
+            for (int y = 0; y < row_end-row_begin; y++) 
             {
-                const int yy = y+padding_rows_offset; 
-                for (int x = 0; x < hog_nc; x++) 
+                const int yy = y+row_begin+padding_rows_offset; 
+                for (int x = 0; x < col_end-col_begin; x++) 
                 {
-                    const simd4f z1(norm[y+1][x+1],
-                                    norm[y][x+1], 
-                                    norm[y+1][x],  
-                                    norm[y][x]);
-
-                    const simd4f z2(norm[y+1][x+2],
-                                    norm[y][x+2],
-                                    norm[y+1][x+1],
-                                    norm[y][x+1]);
-
-                    const simd4f z3(norm[y+2][x+1],
-                                    norm[y+1][x+1],
-                                    norm[y+2][x],
-                                    norm[y+1][x]);
-
-                    const simd4f z4(norm[y+2][x+2],
-                                    norm[y+1][x+2],
-                                    norm[y+2][x+1],
-                                    norm[y+1][x+1]);
-
-                    const simd4f nn = 0.2*sqrt(z1+z2+z3+z4+eps);
-                    const simd4f n = 0.1/nn;
+                    // the 4 blocks this cell is in
+                    const simd4f nn(block_nn[y+1][x+1],
+                                    block_nn[y][x+1], 
+                                    block_nn[y+1][x],  
+                                    block_nn[y][x]);
+                    const simd4f n(block_n[y+1][x+1],
+                                   block_n[y][x+1], 
+                                   block_n[y+1][x],  
+                                   block_n[y][x]);
 
                     simd4f t = 0;
 
-                    const int xx = x+padding_cols_offset; 
+                    const int xx = x+col_begin+padding_cols_offset; 
+                    const matrix<float,18,1>& h = hist[y+1+1][x+col_begin+1+1];
 
                     // contrast-sensitive features
                     for (int o = 0; o < 18; o+=3) 
                     {
-                        simd4f temp0(hist[y+1+1][x+1+1](o));
-                        simd4f temp1(hist[y+1+1][x+1+1](o+1));
-                        simd4f temp2(hist[y+1+1][x+1+1](o+2));
+                        simd4f temp0(h(o));
+                        simd4f temp1(h(o+1));
+                        simd4f temp2(h(o+2));
                         simd4f h0 = min(temp0,nn)*n;
                         simd4f h1 = min(temp1,nn)*n;
                         simd4f h2 = min(temp2,nn)*n;
@@ -810,9 +1038,9 @@ namespace dlib
                     // contrast-insensitive features
                     for (int o = 0; o < 9; o+=3) 
                     {
-                        simd4f temp0 = hist[y+1+1][x+1+1](o)   + hist[y+1+1][x+1+1](o+9);
-                        simd4f temp1 = hist[y+1+1][x+1+1](o+1) + hist[y+1+1][x+1+1](o+9+1);
-                        simd4f temp2 = hist[y+1+1][x+1+1](o+2) + hist[y+1+1][x+1+1](o+9+2);
+                        simd4f temp0 = h(o)   + h(o+9);
+                        simd4f temp1 = h(o+1) + h(o+9+1);
+                        simd4f temp2 = h(o+2) + h(o+9+2);
                         simd4f h0 = min(temp0,nn)*n;
                         simd4f h1 = min(temp1,nn)*n;
                         simd4f h2 = min(temp2,nn)*n;
@@ -834,6 +1062,351 @@ namespace dlib
             }
         }
 
+    // ------------------------------------------------------------------------------------
+
+        template <
+            typename image_type, 
+            typename out_type
+            >
+        void impl_extract_fhog_rect(
+            const image_type& img_, 
+            out_type& hog, 
+            int cell_size,
+            int filter_rows_padding,
+            int filter_cols_padding,
+            long row_begin,
+            long row_end,
+            long col_begin,
+            long col_end
+        ) 
+        /*!
+            requires
+                - hog was set up by init_fhog_rows(img_,hog,cell_size,...) which returned N
+                  rows of M features
+                - 0 <= row_begin <= row_end <= N
+                - 0 <= col_begin <= col_end <= M
+            ensures
+                - computes the features in rows [row_begin,row_end) and columns
+                  [col_begin,col_end) of hog, exactly as impl_extract_fhog_features()
+                  would, and doesn't touch any other features.  So disjoint parts can be
+                  computed in parallel, and the parts of an image that changed can be
+                  updated on their own.
+        !*/
+        {
+            const_image_view<image_type> img(img_);
+
+            matrix<double,2,1> directions[9];
+            init_fhog_directions(directions);
+
+            // Feature row y depends on the histograms of cell rows y to y+2, which are rows
+            // y+1 to y+3 of hist since it has a 1 cell border.  Pixels vote into 2 adjacent
+            // rows, so hist only keeps rows [row_begin, row_end+4) and the first
+            // hist_offset rows are left out.
+            const int cells_nr = (int)((double)img.nr()/(double)cell_size + 0.5);
+            const int cells_nc = (int)((double)img.nc()/(double)cell_size + 0.5);
+            const int hist_offset = row_begin;
+
+            // We give hist extra padding around the edges (1 cell all the way around the
+            // edge) so we can avoid needing to do boundary checks when indexing into it
+            // later on.  So some statements assign to the boundary but those values are
+            // never used.
+            array2d<matrix<float,18,1> > hist(row_end-row_begin+4, cells_nc+2);
+            for (long r = 0; r < hist.nr(); ++r)
+            {
+                for (long c = 0; c < hist.nc(); ++c)
+                {
+                    hist[r][c] = 0;
+                }
+            }
+
+            const int visible_nr = std::min((long)cells_nr*cell_size,img.nr())-1;
+            const int visible_nc = std::min((long)cells_nc*cell_size,img.nc())-1;
+
+            // Cell column c gets votes from the pixels in the columns from (c-0.5)*cell_size
+            // to (c+1.5)*cell_size, and the features need the cell columns col_begin to
+            // col_end+1.
+            const int x_begin = (col_begin-1)*cell_size;
+            const int x_end = (col_end+3)*cell_size;
+
+            // First populate the gradient histograms.  Only pixels that vote into the
+            // histograms the requested features depend on are looked at.
+            for (int y = 1; y < visible_nr; y++) 
+            {
+                const double yp = ((double)y+0.5)/(double)cell_size - 0.5;
+                const int iyp = (int)std::floor(yp);
+                const int hiyp = iyp - hist_offset;
+                if (hiyp+1 < 0)
+                    continue;
+                if (hiyp+1 >= hist.nr()-1)
+                    break;
+                const double vy0 = yp-iyp;
+                const double vy1 = 1.0-vy0;
+                bin_fhog_row(img, y, visible_nc, cell_size, directions, vy0, vy1,
+                    &hist[hiyp+1][0], &hist[hiyp+1+1][0], x_begin, x_end);
+            }
+
+            fhog_features_from_hist(hist, hog, filter_rows_padding, filter_cols_padding,
+                row_begin, row_end, col_begin, col_end);
+        }
+
+        template <
+            typename image_type, 
+            typename out_type
+            >
+        void impl_extract_fhog_rows(
+            const image_type& img_, 
+            out_type& hog, 
+            int cell_size,
+            int filter_rows_padding,
+            int filter_cols_padding,
+            long row_begin,
+            long row_end
+        ) 
+        /*!
+            requires
+                - hog was set up by init_fhog_rows(img_,hog,cell_size,...) which returned N
+                - 0 <= row_begin <= row_end <= N
+            ensures
+                - computes the feature rows [row_begin,row_end) of hog, exactly as
+                  impl_extract_fhog_features() would, and doesn't touch any other rows.
+                  So disjoint row ranges can be computed in parallel.
+        !*/
+        {
+            const long cells_nc = (long)((double)num_columns(img_)/(double)cell_size + 0.5);
+            impl_extract_fhog_rect(img_, hog, cell_size, filter_rows_padding, filter_cols_padding,
+                row_begin, row_end, 0, std::max(cells_nc-2, 0L));
+        }
+
+    // ------------------------------------------------------------------------------------
+
+        template <
+            typename pixel_type_
+            >
+        class fhog_row_ring
+        {
+            /*!
+                WHAT THIS OBJECT REPRESENTS
+                    The last 3 rows of an image that is produced one row at a time.  Row r
+                    is kept in slot r%3 and operator[] takes image row numbers, so the
+                    gradient code reads it like a whole image.
+            !*/
+        public:
+            typedef pixel_type_ pixel_type;
+
+            void set_size (long nc) { rows.set_size(3, nc); }
+            const pixel_type* operator[] (long r) const { return &rows[r%3][0]; }
+            pixel_type* operator[] (long r) { return &rows[r%3][0]; }
+
+        private:
+            array2d<pixel_type> rows;
+        };
+
+        template <
+            typename pixel_type_,
+            typename out_type
+            >
+        class fhog_row_stream
+        {
+            /*!
+                WHAT THIS OBJECT REPRESENTS
+                    Extracts the fHOG features of an nr by nc image whose rows arrive one
+                    at a time from the top, while keeping only the last 3 of them.  The
+                    features are the same as extract_fhog_features() gives for the whole
+                    image.  Rows are written straight into this object's ring buffer, so a
+                    downsampler can produce them without a full image in between.
+            !*/
+        public:
+            typedef pixel_type_ pixel_type;
+
+            long setup (
+                long nr_,
+                long nc_,
+                out_type& hog_,
+                int cell_size_,
+                int filter_rows_padding_,
+                int filter_cols_padding_
+            )
+            /*!
+                requires
+                    - nr_ > 1 && nc_ > 1
+                    - cell_size_ > 1
+                ensures
+                    - sizes hog_ like init_fhog_rows() and returns its number of rows.
+                      The features are written into hog_ by finish().
+            !*/
+            {
+                hog = &hog_;
+                cell_size = cell_size_;
+                filter_rows_padding = filter_rows_padding_;
+                filter_cols_padding = filter_cols_padding_;
+                rows_received = 0;
+                init_fhog_directions(directions);
+                ring.set_size(nc_);
+
+                hog_nr = init_fhog_rows(nr_, nc_, hog_, cell_size, filter_rows_padding, filter_cols_padding);
+                if (hog_nr == 0)
+                    return 0;
+
+                const int cells_nr = (int)((double)nr_/(double)cell_size + 0.5);
+                const int cells_nc = (int)((double)nc_/(double)cell_size + 0.5);
+                visible_nr = std::min((long)cells_nr*cell_size,nr_)-1;
+                visible_nc = std::min((long)cells_nc*cell_size,nc_)-1;
+                hist.set_size(hog_nr+4, cells_nc+2);
+                for (long r = 0; r < hist.nr(); ++r)
+                {
+                    for (long c = 0; c < hist.nc(); ++c)
+                    {
+                        hist[r][c] = 0;
+                    }
+                }
+                return hog_nr;
+            }
+
+            pixel_type* next_row (
+            ) 
+            /*!
+                ensures
+                    - returns the buffer row number num_rows_received() goes into
+            !*/
+            { return ring[rows_received]; }
+
+            void push_row (
+            )
+            /*!
+                requires
+                    - next_row() was filled in
+                ensures
+                    - #num_rows_received() == num_rows_received()+1 
+                    - bins the gradients of the row before it, which now has both of its
+                      neighbours.
+            !*/
+            {
+                const int y = rows_received++ - 1;
+                if (hog_nr == 0 || y < 1 || y >= visible_nr)
+                    return;
+
+                const double yp = ((double)y+0.5)/(double)cell_size - 0.5;
+                const int iyp = (int)std::floor(yp);
+                const double vy0 = yp-iyp;
+                const double vy1 = 1.0-vy0;
+                bin_fhog_row(ring, y, visible_nc, cell_size, directions, vy0, vy1,
+                    &hist[iyp+1][0], &hist[iyp+1+1][0]);
+            }
+
+            long num_rows_received (
+            ) const { return rows_received; }
+
+            const pixel_type* row (
+                long r
+            ) const 
+            /*!
+                requires
+                    - num_rows_received()-3 <= r < num_rows_received()
+            !*/
+            { return ring[r]; }
+
+            void finish (
+            )
+            /*!
+                requires
+                    - all nr rows were pushed
+                ensures
+                    - writes the features into the hog given to setup()
+            !*/
+            {
+                if (hog_nr != 0)
+                    fhog_features_from_hist(hist, *hog, filter_rows_padding, filter_cols_padding,
+                        0, hog_nr, 0, hist.nc()-4);
+            }
+
+        private:
+            out_type* hog;
+            int cell_size;
+            int filter_rows_padding;
+            int filter_cols_padding;
+            long hog_nr;
+            int visible_nr;
+            int visible_nc;
+            long rows_received;
+            matrix<double,2,1> directions[9];
+            fhog_row_ring<pixel_type> ring;
+            array2d<matrix<float,18,1> > hist;
+        };
+
+    // ------------------------------------------------------------------------------------
+
+        template <
+            typename image_type, 
+            typename out_type
+            >
+        void impl_extract_fhog_features(
+            const image_type& img_, 
+            out_type& hog, 
+            int cell_size,
+            int filter_rows_padding,
+            int filter_cols_padding
+        ) 
+        {
+            const_image_view<image_type> img(img_);
+            // make sure requires clause is not broken
+            DLIB_ASSERT( cell_size > 0 &&
+                         filter_rows_padding > 0 &&
+                         filter_cols_padding > 0 ,
+                "\t void extract_fhog_features()"
+                << "\n\t Invalid inputs were given to this function. "
+                << "\n\t cell_size: " << cell_size 
+                << "\n\t filter_rows_padding: " << filter_rows_padding 
+                << "\n\t filter_cols_padding: " << filter_cols_padding 
+                );
+
+            /*
+                This function implements the HOG feature extraction method described in 
+                the paper:
+                    P. Felzenszwalb, R. Girshick, D. McAllester, D. Ramanan
+                    Object Detection with Discriminatively Trained Part Based Models
+                    IEEE Transactions on Pattern Analysis and Machine Intelligence, Vol. 32, No. 9, Sep. 2010
+
+                Moreover, this function is derived from the HOG feature extraction code
+                from the features.cc file in the voc-releaseX code (see
+                http://people.cs.uchicago.edu/~rbg/latent/) which is has the following
+                license (note that the code has been modified to work with grayscale and
+                color as well as planar and interlaced input and output formats):
+
+                Copyright (C) 2011, 2012 Ross Girshick, Pedro Felzenszwalb
+                Copyright (C) 2008, 2009, 2010 Pedro Felzenszwalb, Ross Girshick
+                Copyright (C) 2007 Pedro Felzenszwalb, Deva Ramanan
+
+                Permission is hereby granted, free of charge, to any person obtaining
+                a copy of this software and associated documentation files (the
+                "Software"), to deal in the Software without restriction, including
+                without limitation the rights to use, copy, modify, merge, publish,
+                distribute, sublicense, and/or sell copies of the Software, and to
+                permit persons to whom the Software is furnished to do so, subject to
+                the following conditions:
+
+                The above copyright notice and this permission notice shall be
+                included in all copies or substantial portions of the Software.
+
+                THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+                EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+                MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+                NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+                LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+                OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+                WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+            */
+
+            if (cell_size == 1)
+            {
+                impl_extract_fhog_features_cell_size_1(img_,hog,filter_rows_padding,filter_cols_padding);
+                return;
+            }
+
+            const long hog_nr = init_fhog_rows(img_, hog, cell_size, filter_rows_padding, filter_cols_padding);
+            if (hog_nr != 0)
+                impl_extract_fhog_rows(img_, hog, cell_size, filter_rows_padding, filter_cols_padding, 0, hog_nr);
+        }
+
     // ------------------------------------------------------------------------------------
 
         inline void create_fhog_bar_images (
@@ -749,41 +749,26 @@ namespace dlib
 
 // ----------------------------------------------------------------------------------------
 
-    template <
-        typename image_type
-        >
-    typename enable_if<is_grayscale_image<image_type> >::type resize_image (
-        const image_type& in_img_,
-        image_type& out_img_,
-        interpolate_bilinear
-    )
+    namespace impl
     {
-        // make sure requires clause is not broken
-        DLIB_ASSERT( is_same_object(in_img_, out_img_) == false ,
-            "\t void resize_image()"
-            << "\n\t Invalid inputs were given to this function."
-            << "\n\t is_same_object(in_img_, out_img_):  " << is_same_object(in_img_, out_img_)
-            );
-
-        const_image_view<image_type> in_img(in_img_);
-        image_view<image_type> out_img(out_img_);
-
-        if (out_img.nr() <= 1 || out_img.nc() <= 1)
-        {
-            assign_all_pixels(out_img, 0);
-            return;
-        }
-
-        typedef typename image_traits<image_type>::pixel_type T;
-        const double x_scale = (in_img.nc()-1)/(double)std::max<long>((out_img.nc()-1),1);
-        const double y_scale = (in_img.nr()-1)/(double)std::max<long>((out_img.nr()-1),1);
-        double y = -y_scale;
-        for (long r = 0; r < out_img.nr(); ++r)
+        template <typename T>
+        typename enable_if_c<pixel_traits<T>::grayscale>::type resize_row_bilinear (
+            const T* top_row,
+            const T* bottom_row,
+            const long in_nc,
+            T* out_row,
+            const long out_nc,
+            const double x_scale,
+            const double tb_frac
+        )
+        /*!
+            ensures
+                - computes one row of the bilinear resize_image() below from the two input
+                  rows it interpolates between.  tb_frac is how far the row is from
+                  top_row towards bottom_row.  Lets image pyramids produce their levels
+                  one row at a time.
+        !*/
         {
-            y += y_scale;
-            const long top    = static_cast<long>(std::floor(y));
-            const long bottom = std::min(top+1, in_img.nr()-1);
-            const double tb_frac = y - top;
             double x = -4*x_scale;
 
             const simd4f _tb_frac = tb_frac;
@@ -810,83 +795,55 @@ namespace dlib
                 left.store(fleft);
                 right.store(fright);
 
-                if (fright[3] >= in_img.nc())
+                if (fright[3] >= in_nc)
                     break;
-                simd4f tl(in_img[top][fleft[0]],     in_img[top][fleft[1]],     in_img[top][fleft[2]],     in_img[top][fleft[3]]);
-                simd4f tr(in_img[top][fright[0]],    in_img[top][fright[1]],    in_img[top][fright[2]],    in_img[top][fright[3]]);
-                simd4f bl(in_img[bottom][fleft[0]],  in_img[bottom][fleft[1]],  in_img[bottom][fleft[2]],  in_img[bottom][fleft[3]]);
-                simd4f br(in_img[bottom][fright[0]], in_img[bottom][fright[1]], in_img[bottom][fright[2]], in_img[bottom][fright[3]]);
+                simd4f tl(top_row[fleft[0]],     top_row[fleft[1]],     top_row[fleft[2]],     top_row[fleft[3]]);
+                simd4f tr(top_row[fright[0]],    top_row[fright[1]],    top_row[fright[2]],    top_row[fright[3]]);
+                simd4f bl(bottom_row[fleft[0]],  bottom_row[fleft[1]],  bottom_row[fleft[2]],  bottom_row[fleft[3]]);
+                simd4f br(bottom_row[fright[0]], bottom_row[fright[1]], bottom_row[fright[2]], bottom_row[fright[3]]);
 
                 simd4i out = simd4i(tlf*tl + trf*tr + blf*bl + brf*br);
                 int32 fout[4];
                 out.store(fout);
 
-                out_img[r][c]   = static_cast<T>(fout[0]);
-                out_img[r][c+1] = static_cast<T>(fout[1]);
-                out_img[r][c+2] = static_cast<T>(fout[2]);
-                out_img[r][c+3] = static_cast<T>(fout[3]);
+                out_row[c]   = static_cast<T>(fout[0]);
+                out_row[c+1] = static_cast<T>(fout[1]);
+                out_row[c+2] = static_cast<T>(fout[2]);
+                out_row[c+3] = static_cast<T>(fout[3]);
             }
             x = -x_scale + c*x_scale;
-            for (; c < out_img.nc(); ++c)
+            for (; c < out_nc; ++c)
             {
                 x += x_scale;
                 const long left   = static_cast<long>(std::floor(x));
-                const long right  = std::min(left+1, in_img.nc()-1);
+                const long right  = std::min(left+1, in_nc-1);
                 const float lr_frac = x - left;
 
                 float tl = 0, tr = 0, bl = 0, br = 0;
 
-                assign_pixel(tl, in_img[top][left]);
-                assign_pixel(tr, in_img[top][right]);
-                assign_pixel(bl, in_img[bottom][left]);
-                assign_pixel(br, in_img[bottom][right]);
+                assign_pixel(tl, top_row[left]);
+                assign_pixel(tr, top_row[right]);
+                assign_pixel(bl, bottom_row[left]);
+                assign_pixel(br, bottom_row[right]);
 
                 float temp = (1-tb_frac)*((1-lr_frac)*tl + lr_frac*tr) + 
                     tb_frac*((1-lr_frac)*bl + lr_frac*br);
 
-                assign_pixel(out_img[r][c], temp);
+                assign_pixel(out_row[c], temp);
             }
         }
-    }
-
-// ----------------------------------------------------------------------------------------
-
-    template <
-        typename image_type
-        >
-    typename enable_if<is_rgb_image<image_type> >::type resize_image (
-        const image_type& in_img_,
-        image_type& out_img_,
-        interpolate_bilinear
-    )
-    {
-        // make sure requires clause is not broken
-        DLIB_ASSERT( is_same_object(in_img_, out_img_) == false ,
-            "\t void resize_image()"
-            << "\n\t Invalid inputs were given to this function."
-            << "\n\t is_same_object(in_img_, out_img_):  " << is_same_object(in_img_, out_img_)
-            );
-
-        const_image_view<image_type> in_img(in_img_);
-        image_view<image_type> out_img(out_img_);
-
-        if (out_img.nr() <= 1 || out_img.nc() <= 1)
-        {
-            assign_all_pixels(out_img, 0);
-            return;
-        }
-
 
-        typedef typename image_traits<image_type>::pixel_type T;
-        const double x_scale = (in_img.nc()-1)/(double)std::max<long>((out_img.nc()-1),1);
-        const double y_scale = (in_img.nr()-1)/(double)std::max<long>((out_img.nr()-1),1);
-        double y = -y_scale;
-        for (long r = 0; r < out_img.nr(); ++r)
+        template <typename T>
+        typename enable_if_c<pixel_traits<T>::rgb>::type resize_row_bilinear (
+            const T* top_row,
+            const T* bottom_row,
+            const long in_nc,
+            T* out_row,
+            const long out_nc,
+            const double x_scale,
+            const double tb_frac
+        )
         {
-            y += y_scale;
-            const long top    = static_cast<long>(std::floor(y));
-            const long bottom = std::min(top+1, in_img.nr()-1);
-            const double tb_frac = y - top;
             double x = -4*x_scale;
 
             const simd4f _tb_frac = tb_frac;
@@ -912,69 +869,161 @@ namespace dlib
                 left.store(fleft);
                 right.store(fright);
 
-                if (fright[3] >= in_img.nc())
+                if (fright[3] >= in_nc)
                     break;
-                simd4f tl(in_img[top][fleft[0]].red,     in_img[top][fleft[1]].red,     in_img[top][fleft[2]].red,     in_img[top][fleft[3]].red);
-                simd4f tr(in_img[top][fright[0]].red,    in_img[top][fright[1]].red,    in_img[top][fright[2]].red,    in_img[top][fright[3]].red);
-                simd4f bl(in_img[bottom][fleft[0]].red,  in_img[bottom][fleft[1]].red,  in_img[bottom][fleft[2]].red,  in_img[bottom][fleft[3]].red);
-                simd4f br(in_img[bottom][fright[0]].red, in_img[bottom][fright[1]].red, in_img[bottom][fright[2]].red, in_img[bottom][fright[3]].red);
+                simd4f tl(top_row[fleft[0]].red,     top_row[fleft[1]].red,     top_row[fleft[2]].red,     top_row[fleft[3]].red);
+                simd4f tr(top_row[fright[0]].red,    top_row[fright[1]].red,    top_row[fright[2]].red,    top_row[fright[3]].red);
+                simd4f bl(bottom_row[fleft[0]].red,  bottom_row[fleft[1]].red,  bottom_row[fleft[2]].red,  bottom_row[fleft[3]].red);
+                simd4f br(bottom_row[fright[0]].red, bottom_row[fright[1]].red, bottom_row[fright[2]].red, bottom_row[fright[3]].red);
 
                 simd4i out = simd4i(tlf*tl + trf*tr + blf*bl + brf*br);
                 int32 fout[4];
                 out.store(fout);
 
-                out_img[r][c].red   = static_cast<unsigned char>(fout[0]);
-                out_img[r][c+1].red = static_cast<unsigned char>(fout[1]);
-                out_img[r][c+2].red = static_cast<unsigned char>(fout[2]);
-                out_img[r][c+3].red = static_cast<unsigned char>(fout[3]);
+                out_row[c].red   = static_cast<unsigned char>(fout[0]);
+                out_row[c+1].red = static_cast<unsigned char>(fout[1]);
+                out_row[c+2].red = static_cast<unsigned char>(fout[2]);
+                out_row[c+3].red = static_cast<unsigned char>(fout[3]);
 
 
-                tl = simd4f(in_img[top][fleft[0]].green,    in_img[top][fleft[1]].green,    in_img[top][fleft[2]].green,    in_img[top][fleft[3]].green);
-                tr = simd4f(in_img[top][fright[0]].green,   in_img[top][fright[1]].green,   in_img[top][fright[2]].green,   in_img[top][fright[3]].green);
-                bl = simd4f(in_img[bottom][fleft[0]].green, in_img[bottom][fleft[1]].green, in_img[bottom][fleft[2]].green, in_img[bottom][fleft[3]].green);
-                br = simd4f(in_img[bottom][fright[0]].green, in_img[bottom][fright[1]].green, in_img[bottom][fright[2]].green, in_img[bottom][fright[3]].green);
+                tl = simd4f(top_row[fleft[0]].green,    top_row[fleft[1]].green,    top_row[fleft[2]].green,    top_row[fleft[3]].green);
+                tr = simd4f(top_row[fright[0]].green,   top_row[fright[1]].green,   top_row[fright[2]].green,   top_row[fright[3]].green);
+                bl = simd4f(bottom_row[fleft[0]].green, bottom_row[fleft[1]].green, bottom_row[fleft[2]].green, bottom_row[fleft[3]].green);
+                br = simd4f(bottom_row[fright[0]].green, bottom_row[fright[1]].green, bottom_row[fright[2]].green, bottom_row[fright[3]].green);
                 out = simd4i(tlf*tl + trf*tr + blf*bl + brf*br);
                 out.store(fout);
-                out_img[r][c].green   = static_cast<unsigned char>(fout[0]);
-                out_img[r][c+1].green = static_cast<unsigned char>(fout[1]);
-                out_img[r][c+2].green = static_cast<unsigned char>(fout[2]);
-                out_img[r][c+3].green = static_cast<unsigned char>(fout[3]);
+                out_row[c].green   = static_cast<unsigned char>(fout[0]);
+                out_row[c+1].green = static_cast<unsigned char>(fout[1]);
+                out_row[c+2].green = static_cast<unsigned char>(fout[2]);
+                out_row[c+3].green = static_cast<unsigned char>(fout[3]);
 
 
-                tl = simd4f(in_img[top][fleft[0]].blue,     in_img[top][fleft[1]].blue,     in_img[top][fleft[2]].blue,     in_img[top][fleft[3]].blue);
-                tr = simd4f(in_img[top][fright[0]].blue,    in_img[top][fright[1]].blue,    in_img[top][fright[2]].blue,    in_img[top][fright[3]].blue);
-                bl = simd4f(in_img[bottom][fleft[0]].blue,  in_img[bottom][fleft[1]].blue,  in_img[bottom][fleft[2]].blue,  in_img[bottom][fleft[3]].blue);
-                br = simd4f(in_img[bottom][fright[0]].blue, in_img[bottom][fright[1]].blue, in_img[bottom][fright[2]].blue, in_img[bottom][fright[3]].blue);
+                tl = simd4f(top_row[fleft[0]].blue,     top_row[fleft[1]].blue,     top_row[fleft[2]].blue,     top_row[fleft[3]].blue);
+                tr = simd4f(top_row[fright[0]].blue,    top_row[fright[1]].blue,    top_row[fright[2]].blue,    top_row[fright[3]].blue);
+                bl = simd4f(bottom_row[fleft[0]].blue,  bottom_row[fleft[1]].blue,  bottom_row[fleft[2]].blue,  bottom_row[fleft[3]].blue);
+                br = simd4f(bottom_row[fright[0]].blue, bottom_row[fright[1]].blue, bottom_row[fright[2]].blue, bottom_row[fright[3]].blue);
                 out = simd4i(tlf*tl + trf*tr + blf*bl + brf*br);
                 out.store(fout);
-                out_img[r][c].blue   = static_cast<unsigned char>(fout[0]);
-                out_img[r][c+1].blue = static_cast<unsigned char>(fout[1]);
-                out_img[r][c+2].blue = static_cast<unsigned char>(fout[2]);
-                out_img[r][c+3].blue = static_cast<unsigned char>(fout[3]);
+                out_row[c].blue   = static_cast<unsigned char>(fout[0]);
+                out_row[c+1].blue = static_cast<unsigned char>(fout[1]);
+                out_row[c+2].blue = static_cast<unsigned char>(fout[2]);
+                out_row[c+3].blue = static_cast<unsigned char>(fout[3]);
             }
             x = -x_scale + c*x_scale;
-            for (; c < out_img.nc(); ++c)
+            for (; c < out_nc; ++c)
             {
                 x += x_scale;
                 const long left   = static_cast<long>(std::floor(x));
-                const long right  = std::min(left+1, in_img.nc()-1);
+                const long right  = std::min(left+1, in_nc-1);
                 const double lr_frac = x - left;
 
-                const T tl = in_img[top][left];
-                const T tr = in_img[top][right];
-                const T bl = in_img[bottom][left];
-                const T br = in_img[bottom][right];
+                const T tl = top_row[left];
+                const T tr = top_row[right];
+                const T bl = bottom_row[left];
+                const T br = bottom_row[right];
 
                 T temp;
                 assign_pixel(temp, 0);
                 vector_to_pixel(temp, 
                     (1-tb_frac)*((1-lr_frac)*pixel_to_vector<double>(tl) + lr_frac*pixel_to_vector<double>(tr)) + 
                     tb_frac*((1-lr_frac)*pixel_to_vector<double>(bl) + lr_frac*pixel_to_vector<double>(br)));
-                assign_pixel(out_img[r][c], temp);
+                assign_pixel(out_row[c], temp);
             }
         }
     }
 
+// ----------------------------------------------------------------------------------------
+
+    // Only the pixel types have to match, so image views and other generic images get the
+    // same results as array2d instead of going through the slower general version.
+    template <typename image_type1, typename image_type2>
+    struct is_same_grayscale_image { const static bool value = 
+        is_grayscale_image<image_type1>::value && is_grayscale_image<image_type2>::value &&
+        is_same_type<typename image_traits<image_type1>::pixel_type,
+                     typename image_traits<image_type2>::pixel_type>::value; };
+
+    template <
+        typename image_type1,
+        typename image_type2
+        >
+    typename enable_if<is_same_grayscale_image<image_type1,image_type2> >::type resize_image (
+        const image_type1& in_img_,
+        image_type2& out_img_,
+        interpolate_bilinear
+    )
+    {
+        // make sure requires clause is not broken
+        DLIB_ASSERT( is_same_object(in_img_, out_img_) == false ,
+            "\t void resize_image()"
+            << "\n\t Invalid inputs were given to this function."
+            << "\n\t is_same_object(in_img_, out_img_):  " << is_same_object(in_img_, out_img_)
+            );
+
+        const_image_view<image_type1> in_img(in_img_);
+        image_view<image_type2> out_img(out_img_);
+
+        if (out_img.nr() <= 1 || out_img.nc() <= 1)
+        {
+            assign_all_pixels(out_img, 0);
+            return;
+        }
+
+        const double x_scale = (in_img.nc()-1)/(double)std::max<long>((out_img.nc()-1),1);
+        const double y_scale = (in_img.nr()-1)/(double)std::max<long>((out_img.nr()-1),1);
+        double y = -y_scale;
+        for (long r = 0; r < out_img.nr(); ++r)
+        {
+            y += y_scale;
+            const long top    = static_cast<long>(std::floor(y));
+            const long bottom = std::min(top+1, in_img.nr()-1);
+            const double tb_frac = y - top;
+            impl::resize_row_bilinear(&in_img[top][0], &in_img[bottom][0], in_img.nc(),
+                &out_img[r][0], out_img.nc(), x_scale, tb_frac);
+        }
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename image_type
+        >
+    typename enable_if<is_rgb_image<image_type> >::type resize_image (
+        const image_type& in_img_,
+        image_type& out_img_,
+        interpolate_bilinear
+    )
+    {
+        // make sure requires clause is not broken
+        DLIB_ASSERT( is_same_object(in_img_, out_img_) == false ,
+            "\t void resize_image()"
+            << "\n\t Invalid inputs were given to this function."
+            << "\n\t is_same_object(in_img_, out_img_):  " << is_same_object(in_img_, out_img_)
+            );
+
+        const_image_view<image_type> in_img(in_img_);
+        image_view<image_type> out_img(out_img_);
+
+        if (out_img.nr() <= 1 || out_img.nc() <= 1)
+        {
+            assign_all_pixels(out_img, 0);
+            return;
+        }
+
+
+        const double x_scale = (in_img.nc()-1)/(double)std::max<long>((out_img.nc()-1),1);
+        const double y_scale = (in_img.nr()-1)/(double)std::max<long>((out_img.nr()-1),1);
+        double y = -y_scale;
+        for (long r = 0; r < out_img.nr(); ++r)
+        {
+            y += y_scale;
+            const long top    = static_cast<long>(std::floor(y));
+            const long bottom = std::min(top+1, in_img.nr()-1);
+            const double tb_frac = y - top;
+            impl::resize_row_bilinear(&in_img[top][0], &in_img[bottom][0], in_img.nc(),
+                &out_img[r][0], out_img.nc(), x_scale, tb_frac);
+        }
+    }
+
 // ----------------------------------------------------------------------------------------
 
     template <
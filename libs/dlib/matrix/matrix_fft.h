@@ -7,6 +7,17 @@
 #include "matrix_utilities.h"
 #include "../hash.h"
 #include "../algs.h"
+#include "../simd/simd_check.h"
+#include <complex>
+#include <vector>
+
+// The twiddle tables are shared between threads when std::mutex is available.  Otherwise
+// each transform computes its own, which is what dlib always did.  Using dlib::mutex here
+// would make matrix.h depend on the compiled part of dlib.
+#if __cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1800)
+#include <mutex>
+#define DLIB_FFT_SHARED_TWIDDLES
+#endif
 
 
 // No using FFTW until it becomes thread safe!
@@ -97,6 +108,123 @@ namespace dlib
             }
         }
 
+    // ------------------------------------------------------------------------------------
+
+        template <typename T>
+        void compute_twiddles (
+            int p,
+            std::vector<std::complex<T> >& table
+        )
+        /*!
+            requires
+                - 0 <= p < 64
+            ensures
+                - #table == the twiddle factors needed by R8TX if nxtlt == 2^p
+        !*/
+        {
+            const int nxtlt = 0x1 << p;
+            table.clear();
+            table.reserve(nxtlt*7);
+            // The factors are always computed in double precision so the float
+            // transforms don't accumulate rounding error from the products below.
+            const double twopi = 6.2831853071795865; /* 2.0 * pi */
+            const double scale = twopi/(nxtlt*8.0);
+            std::complex<double> cs[7];
+            for (int j = 0; j < nxtlt; ++j)
+            {
+                const double arg = j*scale;
+                cs[0] = std::complex<double>(std::cos(arg),std::sin(arg));
+                cs[1] = cs[0]*cs[0];
+                cs[2] = cs[1]*cs[0];
+                cs[3] = cs[1]*cs[1];
+                cs[4] = cs[2]*cs[1];
+                cs[5] = cs[2]*cs[2];
+                cs[6] = cs[3]*cs[2];
+                for (int i = 0; i < 7; ++i)
+                    table.push_back(std::complex<T>(cs[i]));
+            }
+        }
+
+        template <typename T>
+        void compute_real_twiddles (
+            int p,
+            std::vector<std::complex<T> >& table
+        )
+        /*!
+            requires
+                - 1 <= p < 64
+            ensures
+                - #table == the 2^(p-1) values exp(-2*pi*i*k/2^p) used to split and merge
+                  the spectra of real valued signals of length 2^p.
+        !*/
+        {
+            const long n = 1L << p;
+            table.resize(n/2);
+            const double twopi = 6.2831853071795865; /* 2.0 * pi */
+            for (long k = 0; k < n/2; ++k)
+            {
+                const double arg = -twopi*k/n;
+                table[k] = std::complex<T>(std::cos(arg), std::sin(arg));
+            }
+        }
+
+    // ------------------------------------------------------------------------------------
+
+#ifdef DLIB_FFT_SHARED_TWIDDLES
+        template <typename T>
+        class twiddle_cache
+        {
+            /*!
+                WHAT THIS OBJECT REPRESENTS
+                    This is a process wide cache of the twiddle tables, one per transform
+                    size.  A table is computed the first time some thread asks for it and
+                    never changes after that, so the returned pointers stay valid and can
+                    be read without locking.
+            !*/
+        public:
+
+            static const std::complex<T>* get_twiddles (int p) { return get(p, tables(), compute_twiddles<T>); }
+            static const std::complex<T>* get_real_twiddles (int p) { return get(p, real_tables(), compute_real_twiddles<T>); }
+
+        private:
+
+            typedef std::vector<std::vector<std::complex<T> > > table_list;
+
+            static const std::complex<T>* get (
+                int p,
+                table_list& list,
+                void (*compute)(int, std::vector<std::complex<T> >&)
+            )
+            {
+                std::lock_guard<std::mutex> lock(global_mutex());
+                if (list[p].size() == 0)
+                    compute(p, list[p]);
+                return &list[p][0];
+            }
+
+            static std::mutex& global_mutex (
+            )
+            {
+                static std::mutex lock;
+                return lock;
+            }
+
+            static table_list& tables (
+            )
+            {
+                static table_list data(64);
+                return data;
+            }
+
+            static table_list& real_tables (
+            )
+            {
+                static table_list data(64);
+                return data;
+            }
+        };
+#endif // DLIB_FFT_SHARED_TWIDDLES
+
     // ------------------------------------------------------------------------------------
 
         template <typename T>
@@ -104,13 +232,21 @@ namespace dlib
         {
             /*!
                 The point of this object is to cache the twiddle values so we don't
-                recompute them over and over inside R8TX().
+                recompute them over and over inside R8TX().  When
+                DLIB_FFT_SHARED_TWIDDLES is defined the tables live in the twiddle_cache
+                and this object just remembers the pointers, so the cache's mutex is only
+                touched the first time each table is used.
             !*/
         public:
 
-            twiddles()
+            twiddles() : use_simd(true)
             {
-                data.resize(64);
+                data.resize(64, 0);
+                real_data.resize(64, 0);
+#ifndef DLIB_FFT_SHARED_TWIDDLES
+                own.resize(64);
+                real_own.resize(64);
+#endif
             }
             
             const std::complex<T>* get_twiddles (
@@ -123,34 +259,49 @@ namespace dlib
                     - returns a pointer to the twiddle factors needed by R8TX if nxtlt == 2^p
             !*/
             {
-                // Compute the twiddle factors for this p value if we haven't done so
-                // already.
-                if (data[p].size() == 0)
+                if (data[p] == 0)
                 {
-                    const int nxtlt = 0x1 << p;
-                    data[p].reserve(nxtlt*7);
-                    const T twopi = 6.2831853071795865; /* 2.0 * pi */
-                    const T scale = twopi/(nxtlt*8.0);
-                    std::complex<T> cs[7];
-                    for (int j = 0; j < nxtlt; ++j)
-                    {
-                        const T arg = j*scale;
-                        cs[0] = std::complex<T>(std::cos(arg),std::sin(arg));
-                        cs[1] = cs[0]*cs[0];
-                        cs[2] = cs[1]*cs[0];
-                        cs[3] = cs[1]*cs[1];
-                        cs[4] = cs[2]*cs[1];
-                        cs[5] = cs[2]*cs[2];
-                        cs[6] = cs[3]*cs[2];
-                        data[p].insert(data[p].end(), cs, cs+7);
-                    }
+#ifdef DLIB_FFT_SHARED_TWIDDLES
+                    data[p] = twiddle_cache<T>::get_twiddles(p);
+#else
+                    compute_twiddles(p, own[p]);
+                    data[p] = &own[p][0];
+#endif
                 }
+                return data[p];
+            }
 
-                return &data[p][0];
+            const std::complex<T>* get_real_twiddles (
+                int p 
+            ) 
+            /*!
+                requires
+                    - 1 <= p <= 64
+                ensures
+                    - returns compute_real_twiddles(p)
+            !*/
+            {
+                if (real_data[p] == 0)
+                {
+#ifdef DLIB_FFT_SHARED_TWIDDLES
+                    real_data[p] = twiddle_cache<T>::get_real_twiddles(p);
+#else
+                    compute_real_twiddles(p, real_own[p]);
+                    real_data[p] = &real_own[p][0];
+#endif
+                }
+                return real_data[p];
             }
 
+            // If false then fft1d_inplace() uses the plain C++ butterflies even when SIMD
+            // versions are available.  This is mainly here so the two can be compared.
+            bool use_simd;
+
         private:
-            std::vector<std::vector<std::complex<T> > > data;
+            std::vector<const std::complex<T>*> data, real_data;
+#ifndef DLIB_FFT_SHARED_TWIDDLES
+            std::vector<std::vector<std::complex<T> > > own, real_own;
+#endif
         };
 
     // ----------------------------------------------------------------------------------------
@@ -218,12 +369,274 @@ namespace dlib
 
     // ------------------------------------------------------------------------------------
 
-        template <typename T, long NR, long NC, typename MM, typename layout>
-        void fft1d_inplace(matrix<std::complex<T>,NR,NC,MM,layout>& data, bool do_backward_fft, twiddles<T>& cs)
+#ifdef DLIB_HAVE_SSE2
+
+        /*
+            The following are SIMD versions of R8TX().  Each fft_pack object holds
+            one or more complex numbers in a register with their real and imaginary parts
+            interleaved, just like they are laid out in memory.  R8TX_simd() then does the
+            same arithmetic as R8TX() on width consecutive values of j at once.  The
+            operations are arranged so the results are the same as the scalar code's.
+        */
+
+        struct fft_pack_f
+        {
+            // Holds 2 complex<float> values.
+            typedef std::complex<float> complex_type;
+            static const int width = 2;
+
+            fft_pack_f() {}
+            fft_pack_f(__m128 x) : v(x) {}
+
+            static fft_pack_f load (const complex_type* p) { return _mm_loadu_ps((const float*)p); }
+            void store (complex_type* p) const { _mm_storeu_ps((float*)p, v); }
+            static fft_pack_f broadcast (float s) { return _mm_set1_ps(s); }
+
+            // loads p[0] and p[stride]
+            static fft_pack_f load_strided (const complex_type* p, int stride) 
+            { 
+                __m128 x = _mm_setzero_ps();
+                x = _mm_loadl_pi(x, (const __m64*)p);
+                return _mm_loadh_pi(x, (const __m64*)(p+stride));
+            }
+
+            // returns i*a
+            friend fft_pack_f mul_i (const fft_pack_f& a)
+            {
+                const __m128 sign = _mm_castsi128_ps(_mm_set_epi32(0, 0x80000000, 0, 0x80000000));
+                return _mm_xor_ps(_mm_shuffle_ps(a.v,a.v,_MM_SHUFFLE(2,3,0,1)), sign);
+            }
+
+            friend fft_pack_f cmul (const fft_pack_f& a, const fft_pack_f& b)
+            {
+                const __m128 bre = _mm_shuffle_ps(b.v,b.v,_MM_SHUFFLE(2,2,0,0));
+                const __m128 bim = _mm_shuffle_ps(b.v,b.v,_MM_SHUFFLE(3,3,1,1));
+                const __m128 asw = _mm_shuffle_ps(a.v,a.v,_MM_SHUFFLE(2,3,0,1));
+#ifdef DLIB_HAVE_SSE3
+                return _mm_addsub_ps(_mm_mul_ps(a.v,bre), _mm_mul_ps(asw,bim));
+#else
+                const __m128 sign = _mm_castsi128_ps(_mm_set_epi32(0, 0x80000000, 0, 0x80000000));
+                return _mm_add_ps(_mm_mul_ps(a.v,bre), _mm_xor_ps(_mm_mul_ps(asw,bim), sign));
+#endif
+            }
+
+            friend fft_pack_f operator+ (const fft_pack_f& a, const fft_pack_f& b) { return _mm_add_ps(a.v,b.v); }
+            friend fft_pack_f operator- (const fft_pack_f& a, const fft_pack_f& b) { return _mm_sub_ps(a.v,b.v); }
+            friend fft_pack_f operator* (const fft_pack_f& a, const fft_pack_f& b) { return _mm_mul_ps(a.v,b.v); }
+
+            __m128 v;
+        };
+
+        struct fft_pack_d
+        {
+            // Holds 1 complex<double> value.
+            typedef std::complex<double> complex_type;
+            static const int width = 1;
+
+            fft_pack_d() {}
+            fft_pack_d(__m128d x) : v(x) {}
+
+            static fft_pack_d load (const complex_type* p) { return _mm_loadu_pd((const double*)p); }
+            void store (complex_type* p) const { _mm_storeu_pd((double*)p, v); }
+            static fft_pack_d broadcast (double s) { return _mm_set1_pd(s); }
+            static fft_pack_d load_strided (const complex_type* p, int) { return load(p); }
+
+            friend fft_pack_d mul_i (const fft_pack_d& a)
+            {
+                const __m128d sign = _mm_castsi128_pd(_mm_set_epi32(0, 0, 0x80000000, 0));
+                return _mm_xor_pd(_mm_shuffle_pd(a.v,a.v,1), sign);
+            }
+
+            friend fft_pack_d cmul (const fft_pack_d& a, const fft_pack_d& b)
+            {
+                const __m128d bre = _mm_shuffle_pd(b.v,b.v,0);
+                const __m128d bim = _mm_shuffle_pd(b.v,b.v,3);
+                const __m128d asw = _mm_shuffle_pd(a.v,a.v,1);
+#ifdef DLIB_HAVE_SSE3
+                return _mm_addsub_pd(_mm_mul_pd(a.v,bre), _mm_mul_pd(asw,bim));
+#else
+                const __m128d sign = _mm_castsi128_pd(_mm_set_epi32(0, 0, 0x80000000, 0));
+                return _mm_add_pd(_mm_mul_pd(a.v,bre), _mm_xor_pd(_mm_mul_pd(asw,bim), sign));
+#endif
+            }
+
+            friend fft_pack_d operator+ (const fft_pack_d& a, const fft_pack_d& b) { return _mm_add_pd(a.v,b.v); }
+            friend fft_pack_d operator- (const fft_pack_d& a, const fft_pack_d& b) { return _mm_sub_pd(a.v,b.v); }
+            friend fft_pack_d operator* (const fft_pack_d& a, const fft_pack_d& b) { return _mm_mul_pd(a.v,b.v); }
+
+            __m128d v;
+        };
+
+#ifdef DLIB_HAVE_AVX
+        struct fft_pack_d2
+        {
+            // Holds 2 complex<double> values.
+            typedef std::complex<double> complex_type;
+            static const int width = 2;
+
+            fft_pack_d2() {}
+            fft_pack_d2(__m256d x) : v(x) {}
+
+            static fft_pack_d2 load (const complex_type* p) { return _mm256_loadu_pd((const double*)p); }
+            void store (complex_type* p) const { _mm256_storeu_pd((double*)p, v); }
+            static fft_pack_d2 broadcast (double s) { return _mm256_set1_pd(s); }
+            static fft_pack_d2 load_strided (const complex_type* p, int stride) 
+            { 
+                return _mm256_insertf128_pd(_mm256_castpd128_pd256(_mm_loadu_pd((const double*)p)),
+                                            _mm_loadu_pd((const double*)(p+stride)), 1);
+            }
+
+            friend fft_pack_d2 mul_i (const fft_pack_d2& a)
+            {
+                const __m256d sign = _mm256_set_pd(0.0, -0.0, 0.0, -0.0);
+                return _mm256_xor_pd(_mm256_permute_pd(a.v,0x5), sign);
+            }
+
+            friend fft_pack_d2 cmul (const fft_pack_d2& a, const fft_pack_d2& b)
+            {
+                const __m256d bre = _mm256_movedup_pd(b.v);
+                const __m256d bim = _mm256_permute_pd(b.v,0xF);
+                const __m256d asw = _mm256_permute_pd(a.v,0x5);
+                return _mm256_addsub_pd(_mm256_mul_pd(a.v,bre), _mm256_mul_pd(asw,bim));
+            }
+
+            friend fft_pack_d2 operator+ (const fft_pack_d2& a, const fft_pack_d2& b) { return _mm256_add_pd(a.v,b.v); }
+            friend fft_pack_d2 operator- (const fft_pack_d2& a, const fft_pack_d2& b) { return _mm256_sub_pd(a.v,b.v); }
+            friend fft_pack_d2 operator* (const fft_pack_d2& a, const fft_pack_d2& b) { return _mm256_mul_pd(a.v,b.v); }
+
+            __m256d v;
+        };
+#endif // DLIB_HAVE_AVX
+
+    // ------------------------------------------------------------------------------------
+
+        template <typename P>
+        void R8TX_simd(int nxtlt, int nthpo, int length, const typename P::complex_type* cs,
+            typename P::complex_type *cc0, typename P::complex_type *cc1, typename P::complex_type *cc2, 
+            typename P::complex_type *cc3, typename P::complex_type *cc4, typename P::complex_type *cc5, 
+            typename P::complex_type *cc6, typename P::complex_type *cc7)
         /*!
             requires
-                - is_vector(data) == true
-                - is_power_of_two(data.size()) == true
+                - nxtlt % P::width == 0
+            ensures
+                - performs R8TX(nxtlt, nthpo, length, cs, cc0, ..., cc7)
+        !*/
+        {
+            const P irt2 = P::broadcast(0.707106781186548);  /* 1.0/sqrt(2.0) */
+
+            for(int j=0; j<nxtlt; j+=P::width) 
+            {
+                // The twiddle factors for j are all 1 so a pack that only holds j==0
+                // can skip them.
+                const bool rotate = (j != 0 || P::width != 1);
+                P t0, t1, t2, t3, t4, t5, t6;
+                if (rotate)
+                {
+                    t0 = P::load_strided(cs+0, 7);
+                    t1 = P::load_strided(cs+1, 7);
+                    t2 = P::load_strided(cs+2, 7);
+                    t3 = P::load_strided(cs+3, 7);
+                    t4 = P::load_strided(cs+4, 7);
+                    t5 = P::load_strided(cs+5, 7);
+                    t6 = P::load_strided(cs+6, 7);
+                }
+
+                for(int k=j;k<nthpo;k+=length) 
+                {
+                    const P x0 = P::load(cc0+k);
+                    const P x1 = P::load(cc1+k);
+                    const P x2 = P::load(cc2+k);
+                    const P x3 = P::load(cc3+k);
+                    const P x4 = P::load(cc4+k);
+                    const P x5 = P::load(cc5+k);
+                    const P x6 = P::load(cc6+k);
+                    const P x7 = P::load(cc7+k);
+
+                    const P a0 = x0 + x4;
+                    const P a1 = x1 + x5;
+                    const P a2 = x2 + x6;
+                    const P a3 = x3 + x7;
+                    const P a4 = x0 - x4;
+                    const P a5 = x1 - x5;
+                    const P a6 = mul_i(x2 - x6);
+                    const P a7 = mul_i(x3 - x7);
+
+                    const P b0 = a0 + a2;
+                    const P b1 = a1 + a3;
+                    const P b2 = a0 - a2;
+                    const P b3 = a1 - a3;
+                    const P b4 = a4 + a6;
+                    const P b5 = a5 + a7;
+                    const P b6 = a4 - a6;
+                    const P b7 = a5 - a7;
+
+                    const P tmp0 = mul_i(b3);
+                    const P tmp1 = irt2*(b5 + mul_i(b5));
+                    const P tmp2 = irt2*(mul_i(b7) - b7);
+
+                    (b0 + b1).store(cc0+k);
+                    if (rotate)
+                    {
+                        cmul(b0 - b1, t3).store(cc1+k);
+                        cmul(b2 + tmp0, t1).store(cc2+k);
+                        cmul(b2 - tmp0, t5).store(cc3+k);
+                        cmul(b4 + tmp1, t0).store(cc4+k);
+                        cmul(b4 - tmp1, t4).store(cc5+k);
+                        cmul(b6 + tmp2, t2).store(cc6+k);
+                        cmul(b6 - tmp2, t6).store(cc7+k);
+                    }
+                    else
+                    {
+                        (b0 - b1).store(cc1+k);
+                        (b2 + tmp0).store(cc2+k);
+                        (b2 - tmp0).store(cc3+k);
+                        (b4 + tmp1).store(cc4+k);
+                        (b4 - tmp1).store(cc5+k);
+                        (b6 + tmp2).store(cc6+k);
+                        (b6 - tmp2).store(cc7+k);
+                    }
+                }
+
+                cs += 7*P::width;
+            }
+        }
+
+    // ------------------------------------------------------------------------------------
+
+        inline void R8TX(int nxtlt, int nthpo, int length, const std::complex<float>* cs,
+            std::complex<float> *cc0, std::complex<float> *cc1, std::complex<float> *cc2, std::complex<float> *cc3,
+            std::complex<float> *cc4, std::complex<float> *cc5, std::complex<float> *cc6, std::complex<float> *cc7)
+        {
+            if (nxtlt%fft_pack_f::width == 0)
+                R8TX_simd<fft_pack_f>(nxtlt, nthpo, length, cs, cc0, cc1, cc2, cc3, cc4, cc5, cc6, cc7);
+            else
+                R8TX<float>(nxtlt, nthpo, length, cs, cc0, cc1, cc2, cc3, cc4, cc5, cc6, cc7);
+        }
+
+        inline void R8TX(int nxtlt, int nthpo, int length, const std::complex<double>* cs,
+            std::complex<double> *cc0, std::complex<double> *cc1, std::complex<double> *cc2, std::complex<double> *cc3,
+            std::complex<double> *cc4, std::complex<double> *cc5, std::complex<double> *cc6, std::complex<double> *cc7)
+        {
+#ifdef DLIB_HAVE_AVX
+            if (nxtlt%fft_pack_d2::width == 0)
+            {
+                R8TX_simd<fft_pack_d2>(nxtlt, nthpo, length, cs, cc0, cc1, cc2, cc3, cc4, cc5, cc6, cc7);
+                return;
+            }
+#endif
+            R8TX_simd<fft_pack_d>(nxtlt, nthpo, length, cs, cc0, cc1, cc2, cc3, cc4, cc5, cc6, cc7);
+        }
+
+#endif // DLIB_HAVE_SSE2
+
+    // ------------------------------------------------------------------------------------
+
+        template <typename T>
+        void fft1d_inplace(std::complex<T>* const b, const long size, bool do_backward_fft, twiddles<T>& cs)
+        /*!
+            requires
+                - b points to size contiguous elements
+                - is_power_of_two(size) == true
             ensures
                 - This routine replaces the input std::complex<double> vector by its finite
                   discrete complex fourier transform if do_backward_fft==true.  It replaces
@@ -235,17 +648,16 @@ namespace dlib
                   and then finishes with a radix-2 or -4 iteration if needed.
         !*/
         {
-            if (data.size() == 0)
+            if (size == 0)
                 return;
 
-            std::complex<T>* const b = &data(0);
             int L[16],L1,L2,L3,L4,L5,L6,L7,L8,L9,L10,L11,L12,L13,L14,L15;
             int j1,j2,j3,j4,j5,j6,j7,j8,j9,j10,j11,j12,j13,j14;
             int j, ij, ji;
             int n2pow, n8pow, nthpo, ipass, nxtlt, length;
 
-            n2pow = fastlog2(data.size());
-            nthpo = data.size();
+            n2pow = fastlog2(size);
+            nthpo = size;
 
             n8pow = n2pow/3;
 
@@ -257,9 +669,19 @@ namespace dlib
                     const int p = n2pow - 3*ipass;
                     nxtlt = 0x1 << p;
                     length = 8*nxtlt;
-                    R8TX(nxtlt, nthpo, length, cs.get_twiddles(p),
-                        b, b+nxtlt, b+2*nxtlt, b+3*nxtlt,
-                        b+4*nxtlt, b+5*nxtlt, b+6*nxtlt, b+7*nxtlt);
+                    if (cs.use_simd)
+                    {
+                        // calls the SIMD version of R8TX() if there is one for T
+                        R8TX(nxtlt, nthpo, length, cs.get_twiddles(p),
+                            b, b+nxtlt, b+2*nxtlt, b+3*nxtlt,
+                            b+4*nxtlt, b+5*nxtlt, b+6*nxtlt, b+7*nxtlt);
+                    }
+                    else
+                    {
+                        R8TX<T>(nxtlt, nthpo, length, cs.get_twiddles(p),
+                            b, b+nxtlt, b+2*nxtlt, b+3*nxtlt,
+                            b+4*nxtlt, b+5*nxtlt, b+6*nxtlt, b+7*nxtlt);
+                    }
                 }
             }
 
@@ -311,42 +733,151 @@ namespace dlib
             // unscramble outputs
             if(!do_backward_fft) 
             {
-                for(long i=1, j=data.size()-1; i<data.size()/2; i++,j--)
+                for(long i=1, j=size-1; i<size/2; i++,j--)
                 {
                     swap(b[j], b[i]);
                 }
             }
         }
 
+        template <typename T, long NR, long NC, typename MM, typename layout>
+        void fft1d_inplace(matrix<std::complex<T>,NR,NC,MM,layout>& data, bool do_backward_fft, twiddles<T>& cs)
+        /*!
+            requires
+                - is_vector(data) == true
+                - is_power_of_two(data.size()) == true
+            ensures
+                - performs the above fft1d_inplace() on the elements of data.
+        !*/
+        {
+            if (data.size() == 0)
+                return;
+
+            fft1d_inplace(&data(0), data.size(), do_backward_fft, cs);
+        }
+
+    // ------------------------------------------------------------------------------------
+
+        template <typename T>
+        class fft_workspace
+        {
+            /*!
+                WHAT THIS OBJECT REPRESENTS
+                    This object holds the twiddle tables and scratch buffers used while
+                    computing FFTs.  Reusing one fft_workspace for many equal sized
+                    transforms means the buffers are only allocated once.  The only state
+                    shared between workspaces is the thread safe twiddle_cache, so any
+                    number of threads can do FFTs at the same time as long as each uses
+                    its own workspace.
+            !*/
+        public:
+
+
+            twiddles<T> cs;
+            std::vector<std::complex<T> > buff;
+            matrix<std::complex<T> > temp;
+
+            const std::complex<T>* get_real_twiddles (
+                long n
+            )
+            /*!
+                requires
+                    - n is an even power of two
+                ensures
+                    - returns a pointer to the n/2 values exp(-2*pi*i*k/n) used to split
+                      and merge the spectra of real valued signals of length n.
+            !*/
+            {
+                return cs.get_real_twiddles(fastlog2(n));
+            }
+        };
+
+    // ------------------------------------------------------------------------------------
+
+        template < typename T, long NR, long NC, typename MM, typename L >
+        void fft_columns_inplace(
+            matrix<std::complex<T>,NR,NC,MM,L>& data,
+            bool do_backward_fft,
+            fft_workspace<T>& ws
+        )
+        /*!
+            ensures
+                - performs fft1d_inplace() on each column of data.
+                - The columns are copied out and back in blocks so that every cache line
+                  of data that gets loaded is used for several columns rather than one.
+        !*/
+        {
+            const long nr = data.nr();
+            const long nc = data.nc();
+            if (nr <= 1)
+                return;
+
+            const long block = 8;
+            ws.buff.resize(nr*block);
+            std::complex<T>* const buff = &ws.buff[0];
+            for (long c0 = 0; c0 < nc; c0 += block)
+            {
+                const long cols = std::min(block, nc-c0);
+                for (long r = 0; r < nr; ++r)
+                {
+                    for (long c = 0; c < cols; ++c)
+                        buff[c*nr+r] = data(r,c0+c);
+                }
+                for (long c = 0; c < cols; ++c)
+                    fft1d_inplace(buff+c*nr, nr, do_backward_fft, ws.cs);
+                for (long r = 0; r < nr; ++r)
+                {
+                    for (long c = 0; c < cols; ++c)
+                        data(r,c0+c) = buff[c*nr+r];
+                }
+            }
+        }
+
     // ------------------------------------------------------------------------------------
 
         template < typename T, long NR, long NC, typename MM, typename L >
         void fft2d_inplace(
             matrix<std::complex<T>,NR,NC,MM,L>& data,
-            bool do_backward_fft
+            bool do_backward_fft,
+            fft_workspace<T>& ws
         )
         {
             if (data.size() == 0)
                 return;
 
-            matrix<std::complex<double> > buff;
-            twiddles<double> cs;
-
-            // Compute transform row by row
-            for(long r=0; r<data.nr(); ++r) 
+            // Compute transform row by row.  The rows are contiguous in a row major
+            // matrix so they are transformed where they are.
+            if (is_same_type<L,row_major_layout>::value)
             {
-                buff = matrix_cast<std::complex<double> >(rowm(data,r));
-                fft1d_inplace(buff, do_backward_fft, cs);
-                set_rowm(data,r) = matrix_cast<std::complex<T> >(buff);
+                for(long r=0; r<data.nr(); ++r) 
+                    fft1d_inplace(&data(r,0), data.nc(), do_backward_fft, ws.cs);
             }
-
-            // Compute transform column by column
-            for(long c=0; c<data.nc(); ++c) 
+            else
             {
-                buff = matrix_cast<std::complex<double> >(colm(data,c));
-                fft1d_inplace(buff, do_backward_fft, cs);
-                set_colm(data,c) = matrix_cast<std::complex<T> >(buff);
+                ws.buff.resize(data.nc());
+                std::complex<T>* const buff = &ws.buff[0];
+                for(long r=0; r<data.nr(); ++r) 
+                {
+                    for (long c = 0; c < data.nc(); ++c)
+                        buff[c] = data(r,c);
+                    fft1d_inplace(buff, data.nc(), do_backward_fft, ws.cs);
+                    for (long c = 0; c < data.nc(); ++c)
+                        data(r,c) = buff[c];
+                }
             }
+
+            // Compute transform column by column
+            fft_columns_inplace(data, do_backward_fft, ws);
+        }
+
+        template < typename T, long NR, long NC, typename MM, typename L >
+        void fft2d_inplace(
+            matrix<std::complex<T>,NR,NC,MM,L>& data,
+            bool do_backward_fft
+        )
+        {
+            fft_workspace<T> ws;
+            fft2d_inplace(data, do_backward_fft, ws);
         }
         
     // ----------------------------------------------------------------------------------------
@@ -371,30 +902,134 @@ namespace dlib
                 << "\n\t is_power_of_two(data.nc()): " << is_power_of_two(data.nc())
             );
 
-            if (data.size() == 0)
-                return;
+            data_out = data;
+            fft2d_inplace(data_out, do_backward_fft);
+        }
+
+    // ------------------------------------------------------------------------------------
 
-            matrix<std::complex<double> > buff;
-            data_out.set_size(data.nr(), data.nc());
-            twiddles<double> cs;
+        template < typename T, long NR, long NC, typename MM, typename L >
+        void fft_any_inplace (
+            matrix<std::complex<T>,NR,NC,MM,L>& data,
+            bool do_backward_fft,
+            fft_workspace<T>& ws
+        )
+        {
+            if (data.nr() == 1 || data.nc() == 1)
+                fft1d_inplace(data, do_backward_fft, ws.cs);
+            else
+                fft2d_inplace(data, do_backward_fft, ws);
+        }
+
+    // ------------------------------------------------------------------------------------
 
-            // Compute transform row by row
-            for(long r=0; r<data.nr(); ++r) 
+        template <typename EXP, typename T>
+        void fftr2d (
+            const matrix_exp<EXP>& data,
+            matrix<std::complex<T> >& out,
+            fft_workspace<T>& ws
+        )
+        /*!
+            requires
+                - data contains real values of type T
+                - is_power_of_two(data.nr()) && is_power_of_two(data.nc())
+                - data.nc() >= 2
+            ensures
+                - #out == the first data.nc()/2+1 columns of fft(complex_matrix(data))
+        !*/
+        {
+            const long nr = data.nr();
+            const long n = data.nc();
+            const long m = n/2;
+            out.set_size(nr, m+1);
+            if (nr == 0)
+                return;
+            const std::complex<T>* const w = ws.get_real_twiddles(n);
+
+            for (long r = 0; r < nr; ++r)
             {
-                buff = matrix_cast<std::complex<double> >(rowm(data,r));
-                fft1d_inplace(buff, do_backward_fft, cs);
-                set_rowm(data_out,r) = matrix_cast<std::complex<T> >(buff);
+                // Pack the row into m complex values, transform them, and then split the
+                // result into the spectrum of the real row.
+                std::complex<T>* const z = &out(r,0);
+                for (long k = 0; k < m; ++k)
+                    z[k] = std::complex<T>(data(r,2*k), data(r,2*k+1));
+                fft1d_inplace(z, m, false, ws.cs);
+
+                const std::complex<T> z0 = z[0];
+                z[0] = std::complex<T>(z0.real()+z0.imag(), 0);
+                z[m] = std::complex<T>(z0.real()-z0.imag(), 0);
+                for (long k = 1; k <= m/2; ++k)
+                {
+                    const long j = m-k;
+                    const std::complex<T> a = z[k];
+                    const std::complex<T> b = std::conj(z[j]);
+                    const std::complex<T> even = (a + b)*(T)0.5;
+                    const std::complex<T> odd = (a - b)*std::complex<T>(0,-0.5);
+                    z[k] = even + w[k]*odd;
+                    z[j] = std::conj(even) + w[j]*std::conj(odd);
+                }
             }
 
-            // Compute transform column by column
-            for(long c=0; c<data_out.nc(); ++c) 
+            fft_columns_inplace(out, false, ws);
+        }
+
+    // ------------------------------------------------------------------------------------
+
+        template <typename EXP, typename T>
+        void ifftr2d (
+            const matrix_exp<EXP>& data,
+            matrix<T>& out,
+            fft_workspace<T>& ws
+        )
+        /*!
+            requires
+                - data contains elements of type std::complex<T>
+                - data.nc() >= 2 
+                - is_power_of_two(data.nr()) && is_power_of_two(2*(data.nc()-1))
+            ensures
+                - #out == the real signal whose fftr() is data, scaled by its size.  That
+                  is, like ifft_inplace(), the result isn't divided by out.size().
+        !*/
+        {
+            const long nr = data.nr();
+            const long m = data.nc()-1;
+            const long n = 2*m;
+            out.set_size(nr, n);
+            if (nr == 0)
+                return;
+            const std::complex<T>* const w = ws.get_real_twiddles(n);
+
+            matrix<std::complex<T> >& temp = ws.temp;
+            temp = data;
+            fft_columns_inplace(temp, true, ws);
+
+            const std::complex<T> i(0,1);
+            for (long r = 0; r < nr; ++r)
             {
-                buff = matrix_cast<std::complex<double> >(colm(data_out,c));
-                fft1d_inplace(buff, do_backward_fft, cs);
-                set_colm(data_out,c) = matrix_cast<std::complex<T> >(buff);
+                // Merge the spectrum of the real row back into the spectrum of the m
+                // packed complex values and transform those back.
+                std::complex<T>* const z = &temp(r,0);
+                const std::complex<T> zm = std::conj(z[m]);
+                z[0] = (z[0] + zm) + i*(z[0] - zm);
+                for (long k = 1; k <= m/2; ++k)
+                {
+                    const long j = m-k;
+                    const std::complex<T> a = z[k];
+                    const std::complex<T> b = std::conj(z[j]);
+                    const std::complex<T> even = a + b;
+                    const std::complex<T> diff = a - b;
+                    z[k] = even + i*diff*std::conj(w[k]);
+                    z[j] = std::conj(even) - i*std::conj(diff)*std::conj(w[j]);
+                }
+                fft1d_inplace(z, m, true, ws.cs);
+                for (long k = 0; k < m; ++k)
+                {
+                    out(r,2*k) = z[k].real();
+                    out(r,2*k+1) = z[k].imag();
+                }
             }
         }
-        
+
     // ------------------------------------------------------------------------------------
 
     } // end namespace impl
@@ -515,6 +1150,204 @@ namespace dlib
         }
     }
 
+// ----------------------------------------------------------------------------------------
+
+    template <typename EXP>
+    matrix<std::complex<typename EXP::type> > fftr (const matrix_exp<EXP>& data)
+    {
+        // You have to give a real matrix
+        COMPILE_TIME_ASSERT(is_float_type<typename EXP::type>::value);
+        // make sure requires clause is not broken
+        DLIB_CASSERT(is_power_of_two(data.nr()) && is_power_of_two(data.nc()) && data.nc() >= 2,
+            "\t matrix fftr(data)"
+            << "\n\t The number of rows and columns must be powers of two and data.nc() at least 2."
+            << "\n\t data.nr(): "<< data.nr()
+            << "\n\t data.nc(): "<< data.nc()
+            );
+
+        matrix<std::complex<typename EXP::type> > temp;
+        impl::fft_workspace<typename EXP::type> ws;
+        impl::fftr2d(data, temp, ws);
+        return temp;
+    }
+
+    template <typename EXP>
+    matrix<typename EXP::type::value_type> ifftr (const matrix_exp<EXP>& data)
+    {
+        // You have to give a complex matrix
+        COMPILE_TIME_ASSERT(is_complex<typename EXP::type>::value);
+        // make sure requires clause is not broken
+        DLIB_CASSERT(is_power_of_two(data.nr()) && data.nc() >= 2 && is_power_of_two(2*(data.nc()-1)),
+            "\t matrix ifftr(data)"
+            << "\n\t The number of rows must be a power of two and data.nc() one more than a power of two."
+            << "\n\t data.nr(): "<< data.nr()
+            << "\n\t data.nc(): "<< data.nc()
+            );
+
+        matrix<typename EXP::type::value_type> temp;
+        impl::fft_workspace<typename EXP::type::value_type> ws;
+        impl::ifftr2d(data, temp, ws);
+        if (temp.size() != 0)
+            temp /= temp.size();
+        return temp;
+    }
+
+    template < typename T, long NR, long NC, typename MM, typename L >
+    void fftr (
+        const matrix<T,NR,NC,MM,L>& data,
+        matrix<std::complex<T> >& out
+    )
+    {
+        // make sure requires clause is not broken
+        DLIB_CASSERT(is_power_of_two(data.nr()) && is_power_of_two(data.nc()) && data.nc() >= 2,
+            "\t void fftr(data, out)"
+            << "\n\t The number of rows and columns must be powers of two and data.nc() at least 2."
+            << "\n\t data.nr(): "<< data.nr()
+            << "\n\t data.nc(): "<< data.nc()
+            );
+
+        impl::fft_workspace<T> ws;
+        impl::fftr2d(data, out, ws);
+    }
+
+    template < typename T, long NR, long NC, typename MM, typename L >
+    void ifftr (
+        const matrix<std::complex<T>,NR,NC,MM,L>& data,
+        matrix<T>& out
+    )
+    {
+        // make sure requires clause is not broken
+        DLIB_CASSERT(is_power_of_two(data.nr()) && data.nc() >= 2 && is_power_of_two(2*(data.nc()-1)),
+            "\t void ifftr(data, out)"
+            << "\n\t The number of rows must be a power of two and data.nc() one more than a power of two."
+            << "\n\t data.nr(): "<< data.nr()
+            << "\n\t data.nc(): "<< data.nc()
+            );
+
+        impl::fft_workspace<T> ws;
+        impl::ifftr2d(data, out, ws);
+        if (out.size() != 0)
+            out /= out.size();
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    namespace impl
+    {
+        template <typename M>
+        bool all_same_size (
+            const std::vector<M>& data
+        )
+        {
+            for (unsigned long i = 1; i < data.size(); ++i)
+            {
+                if (data[i].nr() != data[0].nr() || data[i].nc() != data[0].nc())
+                    return false;
+            }
+            return true;
+        }
+    }
+
+    template < typename T, long NR, long NC, typename MM, typename L >
+    void fft_inplace (
+        std::vector<matrix<std::complex<T>,NR,NC,MM,L> >& data
+    )
+    {
+        if (data.size() == 0)
+            return;
+
+        // make sure requires clause is not broken
+        DLIB_CASSERT(impl::all_same_size(data) &&
+                     is_power_of_two(data[0].nr()) && is_power_of_two(data[0].nc()),
+            "\t void fft_inplace(data)"
+            << "\n\t All the matrices must have the same size and it must be a power of two."
+            << "\n\t data[0].nr(): "<< data[0].nr()
+            << "\n\t data[0].nc(): "<< data[0].nc()
+            << "\n\t impl::all_same_size(data): " << impl::all_same_size(data)
+            );
+
+        impl::fft_workspace<T> ws;
+        for (unsigned long i = 0; i < data.size(); ++i)
+            impl::fft_any_inplace(data[i], false, ws);
+    }
+
+    template < typename T, long NR, long NC, typename MM, typename L >
+    void ifft_inplace (
+        std::vector<matrix<std::complex<T>,NR,NC,MM,L> >& data
+    )
+    {
+        if (data.size() == 0)
+            return;
+
+        // make sure requires clause is not broken
+        DLIB_CASSERT(impl::all_same_size(data) &&
+                     is_power_of_two(data[0].nr()) && is_power_of_two(data[0].nc()),
+            "\t void ifft_inplace(data)"
+            << "\n\t All the matrices must have the same size and it must be a power of two."
+            << "\n\t data[0].nr(): "<< data[0].nr()
+            << "\n\t data[0].nc(): "<< data[0].nc()
+            << "\n\t impl::all_same_size(data): " << impl::all_same_size(data)
+            );
+
+        impl::fft_workspace<T> ws;
+        for (unsigned long i = 0; i < data.size(); ++i)
+            impl::fft_any_inplace(data[i], true, ws);
+    }
+
+    template < typename T, long NR, long NC, typename MM, typename L >
+    void fftr (
+        const std::vector<matrix<T,NR,NC,MM,L> >& data,
+        std::vector<matrix<std::complex<T> > >& out
+    )
+    {
+        out.resize(data.size());
+        if (data.size() == 0)
+            return;
+
+        // make sure requires clause is not broken
+        DLIB_CASSERT(impl::all_same_size(data) &&
+                     is_power_of_two(data[0].nr()) && is_power_of_two(data[0].nc()) && data[0].nc() >= 2,
+            "\t void fftr(data, out)"
+            << "\n\t All the matrices must have the same size, a power of two, and data[0].nc() at least 2."
+            << "\n\t data[0].nr(): "<< data[0].nr()
+            << "\n\t data[0].nc(): "<< data[0].nc()
+            << "\n\t impl::all_same_size(data): " << impl::all_same_size(data)
+            );
+
+        impl::fft_workspace<T> ws;
+        for (unsigned long i = 0; i < data.size(); ++i)
+            impl::fftr2d(data[i], out[i], ws);
+    }
+
+    template < typename T, long NR, long NC, typename MM, typename L >
+    void ifftr (
+        const std::vector<matrix<std::complex<T>,NR,NC,MM,L> >& data,
+        std::vector<matrix<T> >& out
+    )
+    {
+        out.resize(data.size());
+        if (data.size() == 0)
+            return;
+
+        // make sure requires clause is not broken
+        DLIB_CASSERT(impl::all_same_size(data) && is_power_of_two(data[0].nr()) &&
+                     data[0].nc() >= 2 && is_power_of_two(2*(data[0].nc()-1)),
+            "\t void ifftr(data, out)"
+            << "\n\t All the matrices must have the same size, a power of two number of rows"
+            << "\n\t and one more than a power of two columns."
+            << "\n\t data[0].nr(): "<< data[0].nr()
+            << "\n\t data[0].nc(): "<< data[0].nc()
+            << "\n\t impl::all_same_size(data): " << impl::all_same_size(data)
+            );
+
+        impl::fft_workspace<T> ws;
+        for (unsigned long i = 0; i < data.size(); ++i)
+        {
+            impl::ifftr2d(data[i], out[i], ws);
+            out[i] /= out[i].size();
+        }
+    }
+
 // ----------------------------------------------------------------------------------------
 
     /*
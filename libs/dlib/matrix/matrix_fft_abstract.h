@@ -110,6 +110,186 @@ namespace dlib
                   inverse transformation.  
     !*/
 
+// ----------------------------------------------------------------------------------------
+
+    template <typename EXP>
+    matrix<std::complex<typename EXP::type> > fftr (
+        const matrix_exp<EXP>& data
+    );  
+    /*!
+        requires
+            - data contains real numbers (i.e. float, double, or long double)
+            - is_power_of_two(data.nr()) == true
+            - is_power_of_two(data.nc()) == true
+            - data.nc() >= 2
+              (so it can't be 0 either, even though is_power_of_two(0) is true)
+        ensures
+            - Computes the 1 or 2 dimensional discrete Fourier transform of a real valued
+              matrix.  The transform of real data is conjugate symmetric so only the
+              non-redundant half of it is computed, which takes about half the time of
+              fft().  In particular, we return a matrix D such that:
+                - D.nr() == data.nr()
+                - D.nc() == data.nc()/2+1
+                - D == colm(fft(complex_matrix(data)), range(0,data.nc()/2))
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    template <typename EXP>
+    matrix<typename EXP::type::value_type> ifftr (
+        const matrix_exp<EXP>& data
+    );  
+    /*!
+        requires
+            - data contains elements of type std::complex<>
+            - is_power_of_two(data.nr()) == true
+            - data.nc() >= 2
+            - is_power_of_two(2*(data.nc()-1)) == true
+        ensures
+            - This is the inverse of fftr().  It returns the real matrix D such that:
+                - D.nr() == data.nr()
+                - D.nc() == 2*(data.nc()-1)
+                - fftr(D) == data 
+            - The imaginary parts of the redundant terms of data (i.e. column 0 and
+              column data.nc()-1) are assumed to be consistent with a real signal.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    template < 
+        typename T, 
+        long NR,
+        long NC,
+        typename MM,
+        typename L 
+        >
+    void fftr (
+        const matrix<T,NR,NC,MM,L>& data,
+        matrix<std::complex<T> >& out
+    );
+    /*!
+        requires
+            - the requirements of fftr(data) are satisfied 
+        ensures
+            - #out == fftr(data)
+            - out's memory is reused if it already has the right size.
+    !*/
+
+    template < 
+        typename T, 
+        long NR,
+        long NC,
+        typename MM,
+        typename L 
+        >
+    void ifftr (
+        const matrix<std::complex<T>,NR,NC,MM,L>& data,
+        matrix<T>& out
+    );
+    /*!
+        requires
+            - the requirements of ifftr(data) are satisfied 
+        ensures
+            - #out == ifftr(data)
+            - out's memory is reused if it already has the right size.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    template < 
+        typename T, 
+        long NR,
+        long NC,
+        typename MM,
+        typename L 
+        >
+    void fft_inplace (
+        std::vector<matrix<std::complex<T>,NR,NC,MM,L> >& data
+    );
+    /*!
+        requires
+            - All the matrices in data have the same dimensions and those dimensions are
+              powers of two.
+        ensures
+            - Performs fft_inplace(data[i]) for all i.  The twiddle tables and scratch
+              buffers are computed once and shared by all the transforms, so this is
+              faster than transforming the channels one by one.
+    !*/
+
+    template < 
+        typename T, 
+        long NR,
+        long NC,
+        typename MM,
+        typename L 
+        >
+    void ifft_inplace (
+        std::vector<matrix<std::complex<T>,NR,NC,MM,L> >& data
+    );
+    /*!
+        requires
+            - All the matrices in data have the same dimensions and those dimensions are
+              powers of two.
+        ensures
+            - Performs ifft_inplace(data[i]) for all i, sharing the twiddle tables like
+              the above fft_inplace().
+    !*/
+
+    template < 
+        typename T, 
+        long NR,
+        long NC,
+        typename MM,
+        typename L 
+        >
+    void fftr (
+        const std::vector<matrix<T,NR,NC,MM,L> >& data,
+        std::vector<matrix<std::complex<T> > >& out
+    );
+    /*!
+        requires
+            - All the matrices in data have the same dimensions and satisfy the
+              requirements of fftr().
+        ensures
+            - #out.size() == data.size()
+            - #out[i] == fftr(data[i]) for all i.
+            - The twiddle tables are shared by all the transforms and the memory in out
+              is reused if it already has the right size.
+    !*/
+
+    template < 
+        typename T, 
+        long NR,
+        long NC,
+        typename MM,
+        typename L 
+        >
+    void ifftr (
+        const std::vector<matrix<std::complex<T>,NR,NC,MM,L> >& data,
+        std::vector<matrix<T> >& out
+    );
+    /*!
+        requires
+            - All the matrices in data have the same dimensions and satisfy the
+              requirements of ifftr().
+        ensures
+            - #out.size() == data.size()
+            - #out[i] == ifftr(data[i]) for all i.
+            - The twiddle tables are shared by all the transforms and the memory in out
+              is reused if it already has the right size.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    /*!
+        THREAD SAFETY
+            It is safe to call the functions in this file concurrently from multiple
+            threads on different data.  The only state they share is a cache of twiddle
+            factor tables, one per transform size, which is protected by a mutex and only
+            written the first time a size is used.  When compiling without C++11 there is
+            no std::mutex, so each call computes its own tables instead.
+    !*/
+
 // ----------------------------------------------------------------------------------------
 
 }
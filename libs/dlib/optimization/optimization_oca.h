@@ -61,6 +61,7 @@ namespace dlib
             sub_max_iter = 50000;
 
             inactive_thresh = 20;
+            warm_start = false;
         }
 
         void set_subproblem_epsilon (
@@ -106,6 +107,13 @@ namespace dlib
         unsigned long get_inactive_plane_threshold (
         ) const { return inactive_thresh; }
 
+        void set_warm_start (
+            bool warm_start_
+        ) { warm_start = warm_start_; }
+
+        bool get_warm_start (
+        ) const { return warm_start; }
+
         template <
             typename matrix_type
             >
@@ -186,8 +194,13 @@ namespace dlib
 
             vect_type new_plane, alpha;
 
-            w.set_size(num_dims, 1);
-            w = 0;
+            // When warm starting, the first cutting plane is taken at the w we were given,
+            // e.g. the solution of a previous, similar problem.
+            if (!warm_start || !is_col_vector(w) || (unsigned long)w.size() != num_dims)
+            {
+                w.set_size(num_dims, 1);
+                w = 0;
+            }
 
             // The current objective value.  Note also that w always contains 
             // the current solution.
@@ -349,6 +362,8 @@ namespace dlib
         unsigned long sub_max_iter;
 
         unsigned long inactive_thresh;
+
+        bool warm_start;
     };
 }
 
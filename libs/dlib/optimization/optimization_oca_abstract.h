@@ -277,6 +277,26 @@ namespace dlib
                   inactivity required before a cutting plane is removed.
         !*/
 
+        void set_warm_start (
+            bool warm_start
+        ); 
+        /*!
+            ensures
+                - #get_warm_start() == warm_start
+        !*/
+
+        bool get_warm_start (
+        ) const; 
+        /*!
+            ensures
+                - returns true if operator() starts the optimization from the w it is given,
+                  provided w is a column vector with problem.get_num_dimensions() elements.
+                  Otherwise, and by default, the optimization starts from w == 0.  Starting
+                  from the solution of a similar problem, e.g. the same problem with a few
+                  more training samples, usually reaches the stopping criterion in fewer
+                  iterations.
+        !*/
+
     };
 }
 
@@ -57,9 +57,11 @@ namespace dlib
 
             C = 1;
             verbose = false;
+            observer = 0;
             eps = 0.1;
             num_threads = 2;
             max_cache_size = 5;
+            scanner_cache_size = 0;
             match_eps = 0.5;
             loss_per_missed_target = 1;
             loss_per_false_alarm = 1;
@@ -146,6 +148,19 @@ namespace dlib
             return max_cache_size; 
         }
 
+        void set_scanner_cache_size (
+            unsigned long num
+        )
+        {
+            scanner_cache_size = num;
+        }
+
+        unsigned long get_scanner_cache_size (
+        ) const
+        {
+            return scanner_cache_size;
+        }
+
         void be_verbose (
         )
         {
@@ -158,6 +173,16 @@ namespace dlib
             verbose = false;
         }
 
+        void set_status_observer (
+            structural_svm_status_observer* observer_
+        )
+        {
+            observer = observer_;
+        }
+
+        structural_svm_status_observer* get_status_observer (
+        ) const { return observer; }
+
         void set_oca (
             const oca& item
         )
@@ -171,6 +196,19 @@ namespace dlib
             return solver;
         }
 
+        void set_initial_weights (
+            const matrix<double,0,1>& w
+        )
+        {
+            initial_w = w;
+        }
+
+        const matrix<double,0,1>& get_initial_weights (
+        ) const
+        {
+            return initial_w;
+        }
+
         void set_c (
             scalar_type C_ 
         )
@@ -356,10 +394,12 @@ namespace dlib
 
             structural_svm_object_detection_problem<image_scanner_type,image_array_type > 
                 svm_prob(scanner, overlap_tester, auto_overlap_tester, images,
-                    truth_object_detections, ignore, ignore_overlap_tester, num_threads);
+                    truth_object_detections, ignore, ignore_overlap_tester, num_threads,
+                    scanner_cache_size);
 
             if (verbose)
                 svm_prob.be_verbose();
+            svm_prob.set_status_observer(observer);
 
             svm_prob.set_c(C);
             svm_prob.set_epsilon(eps);
@@ -368,10 +408,21 @@ namespace dlib
             svm_prob.set_loss_per_missed_target(loss_per_missed_target);
             svm_prob.set_loss_per_false_alarm(loss_per_false_alarm);
             configure_nuclear_norm_regularizer(scanner, svm_prob);
-            matrix<double,0,1> w;
+            // make sure requires clause is not broken
+            DLIB_ASSERT(initial_w.size() == 0 || initial_w.size() == (long)scanner.get_num_dimensions()+1,
+                "\t trained_function_type structural_object_detection_trainer::train()"
+                << "\n\t The initial weights don't match the scanner."
+                << "\n\t initial_w.size():                       " << initial_w.size()
+                << "\n\t get_scanner().get_num_dimensions()+1: " << scanner.get_num_dimensions()+1
+                );
+            matrix<double,0,1> w = initial_w;
 
-            // Run the optimizer to find the optimal w.
-            solver(svm_prob,w);
+            // Run the optimizer to find the optimal w, starting from the initial weights if
+            // we have any.
+            oca warm_solver(solver);
+            if (initial_w.size() != 0)
+                warm_solver.set_warm_start(true);
+            warm_solver(svm_prob,w);
 
             // report the results of the training.
             return object_detector<image_scanner_type>(scanner, svm_prob.get_overlap_tester(), w);
@@ -382,11 +433,14 @@ namespace dlib
 
         double C;
         oca solver;
+        matrix<double,0,1> initial_w;
         double eps;
         double match_eps;
         bool verbose;
+        structural_svm_status_observer* observer;
         unsigned long num_threads;
         unsigned long max_cache_size;
+        unsigned long scanner_cache_size;
         double loss_per_missed_target;
         double loss_per_false_alarm;
         bool auto_overlap_tester;
@@ -51,9 +51,11 @@ namespace dlib
             ensures
                 - #get_c() == 1
                 - this object isn't verbose
+                - #get_initial_weights().size() == 0
                 - #get_epsilon() == 0.1
                 - #get_num_threads() == 2
                 - #get_max_cache_size() == 5
+                - #get_scanner_cache_size() == 0
                 - #get_match_eps() == 0.5
                 - #get_loss_per_missed_target() == 1
                 - #get_loss_per_false_alarm() == 1
@@ -63,6 +65,7 @@ namespace dlib
                   (note that only the "configuration" of scanner is copied.
                   I.e. the copy is done using copy_configuration())
                 - #auto_set_overlap_tester() == true
+                - #get_status_observer() == 0
         !*/
 
         const image_scanner_type& get_scanner (
@@ -165,6 +168,28 @@ namespace dlib
                   memory (where scanner is the scanner given to this object's constructor).
         !*/
 
+        void set_scanner_cache_size (
+            unsigned long num
+        );
+        /*!
+            ensures
+                - #get_scanner_cache_size() == num
+        !*/
+
+        unsigned long get_scanner_cache_size (
+        ) const;
+        /*!
+            ensures
+                - returns the number of training images that stay loaded in a scanner
+                  during training.  0 (the default) means all of them.  Otherwise the
+                  remaining images are loaded into a spare scanner again each time the
+                  optimizer needs them, about one per thread.  A loaded scanner usually
+                  takes several times the memory of its image (e.g. an fHOG pyramid),
+                  so this bounds the memory used by training at the cost of reloading
+                  images, and the images are accessed during the whole training.  See
+                  structural_svm_object_detection_problem for the details.
+        !*/
+
         void be_verbose (
         );
         /*!
@@ -180,6 +205,28 @@ namespace dlib
                 - this object will not print anything to standard out
         !*/
 
+        void set_status_observer (
+            structural_svm_status_observer* observer
+        );
+        /*!
+            ensures
+                - #get_status_observer() == observer
+                - train() passes observer to the structural_svm_problem it optimizes, so
+                  observer->update() is called on every iteration and can stop the
+                  training early.  See structural_svm_status_observer.  observer isn't
+                  owned by this object and copies of this object share it, so it must
+                  be safe to call from several threads if the copies train in parallel,
+                  as cross_validate_object_detection_trainer() can do.
+        !*/
+
+        structural_svm_status_observer* get_status_observer (
+        ) const;
+        /*!
+            ensures
+                - returns the object train() reports its progress to, or 0 if there is
+                  none.
+        !*/
+
         void set_oca (
             const oca& item
         );
@@ -195,6 +242,29 @@ namespace dlib
                 - returns a copy of the optimizer used to solve the structural SVM problem.  
         !*/
 
+        void set_initial_weights (
+            const matrix<double,0,1>& w
+        );
+        /*!
+            requires
+                - w.size() == 0 or w.size() == get_scanner().get_num_dimensions()+1,
+                  the dimensionality of the weight vectors this object learns.  E.g.
+                  w == detector.get_w() for a detector previously learned with the same
+                  scanner configuration.
+            ensures
+                - #get_initial_weights() == w
+        !*/
+
+        const matrix<double,0,1>& get_initial_weights (
+        ) const;
+        /*!
+            ensures
+                - returns the weight vector training starts from.  If it is empty (the
+                  default) training starts from scratch.  Otherwise the optimizer is warm
+                  started from it (see oca::set_warm_start()), which makes retraining an
+                  existing detector on a slightly larger dataset converge faster.
+        !*/
+
         void set_c (
             scalar_type C
         );
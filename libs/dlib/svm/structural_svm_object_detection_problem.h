@@ -42,7 +42,8 @@ namespace dlib
             const std::vector<std::vector<full_object_detection> >& truth_object_detections_,
             const std::vector<std::vector<rectangle> >& ignore_,
             const test_box_overlap& ignore_overlap_tester_,
-            unsigned long num_threads = 2
+            unsigned long num_threads = 2,
+            unsigned long scanner_cache_size = 0
         ) :
             structural_svm_problem_threaded<matrix<double,0,1> >(num_threads),
             boxes_overlap(overlap_tester),
@@ -99,14 +100,21 @@ namespace dlib
             }
             max_num_dets = max_num_dets*3 + 10;
 
-            initialize_scanners(scanner, num_threads);
+            initialize_scanners(scanner, num_threads, scanner_cache_size);
 
             if (auto_overlap_tester)
             {
-                auto_configure_overlap_tester();
+                auto_configure_overlap_tester(num_threads);
             }
         }
 
+        ~structural_svm_object_detection_problem (
+        )
+        {
+            for (unsigned long i = 0; i < spare_scanners.size(); ++i)
+                delete spare_scanners[i];
+        }
+
         test_box_overlap get_overlap_tester (
         ) const 
         {
@@ -178,18 +186,38 @@ namespace dlib
 
     private:
 
-        void auto_configure_overlap_tester(
-        )
+        struct map_rects_helper
         {
-            std::vector<std::vector<rectangle> > mapped_rects(truth_object_detections.size());
-            for (unsigned long i = 0; i < truth_object_detections.size(); ++i)
+            map_rects_helper (
+                const structural_svm_object_detection_problem& prob_,
+                std::vector<std::vector<rectangle> >& mapped_rects_
+            ) :
+                prob(prob_),
+                mapped_rects(mapped_rects_)
+            {}
+
+            const structural_svm_object_detection_problem& prob;
+            std::vector<std::vector<rectangle> >& mapped_rects;
+
+            void operator() (long i ) const
             {
-                mapped_rects[i].resize(truth_object_detections[i].size());
-                for (unsigned long j = 0; j < truth_object_detections[i].size(); ++j)
+                // Some scanners only know the rectangles they can output once they are
+                // loaded with the image, so this uses the loaded scanner.
+                scanner_lease lease(prob, i);
+                mapped_rects[i].resize(prob.truth_object_detections[i].size());
+                for (unsigned long j = 0; j < prob.truth_object_detections[i].size(); ++j)
                 {
-                    mapped_rects[i][j] = scanners[i].get_best_matching_rect(truth_object_detections[i][j].get_rect());
+                    mapped_rects[i][j] = lease.get().get_best_matching_rect(prob.truth_object_detections[i][j].get_rect());
                 }
             }
+        };
+
+        void auto_configure_overlap_tester(
+            unsigned long num_threads
+        )
+        {
+            std::vector<std::vector<rectangle> > mapped_rects(truth_object_detections.size());
+            parallel_for(num_threads, 0, truth_object_detections.size(), map_rects_helper(*this, mapped_rects));
 
             boxes_overlap = find_tight_overlap_tester(mapped_rects);
         }
@@ -198,7 +226,7 @@ namespace dlib
         virtual long get_num_dimensions (
         ) const 
         {
-            return scanners[0].get_num_dimensions() + 
+            return config_scanner.get_num_dimensions() + 
                 1;// for threshold
         }
 
@@ -213,7 +241,8 @@ namespace dlib
             feature_vector_type& psi 
         ) const 
         {
-            const image_scanner_type& scanner = scanners[idx];
+            scanner_lease lease(*this, idx);
+            const image_scanner_type& scanner = lease.get();
 
             psi.set_size(get_num_dimensions());
             std::vector<rectangle> mapped_rects;
@@ -310,7 +339,8 @@ namespace dlib
             feature_vector_type& psi
         ) const 
         {
-            const image_scanner_type& scanner = scanners[idx];
+            scanner_lease lease(*this, idx);
+            const image_scanner_type& scanner = lease.get();
 
             std::vector<std::pair<double, rectangle> > dets;
             const double thresh = current_solution(scanner.get_num_dimensions());
@@ -500,11 +530,22 @@ namespace dlib
 
         void initialize_scanners (
             const image_scanner_type& scanner,
-            unsigned long num_threads
+            unsigned long num_threads,
+            unsigned long scanner_cache_size
         )
         {
-            scanners.set_max_size(images.size());
-            scanners.set_size(images.size());
+            config_scanner.copy_configuration(scanner);
+
+            // The first scanner_cache_size images stay loaded for the whole optimization.
+            // The solver visits every image in each iteration, so keeping a fixed set of
+            // them loaded is as good as it gets, a least recently used set would be
+            // evicted right before each of its images comes up again.
+            unsigned long num_loaded = images.size();
+            if (scanner_cache_size != 0 && scanner_cache_size < num_loaded)
+                num_loaded = scanner_cache_size;
+
+            scanners.set_max_size(num_loaded);
+            scanners.set_size(num_loaded);
 
             for (unsigned long i = 0; i < scanners.size(); ++i)
                 scanners[i].copy_configuration(scanner);
@@ -513,10 +554,90 @@ namespace dlib
             parallel_for(num_threads, 0, scanners.size(), init_scanners_helper(scanners, images));
         }
 
+        image_scanner_type* get_spare_scanner (
+        ) const
+        {
+            auto_mutex lock(spare_mutex);
+            if (free_spare_scanners.size() != 0)
+            {
+                image_scanner_type* spare = free_spare_scanners.back();
+                free_spare_scanners.pop_back();
+                return spare;
+            }
+            spare_scanners.reserve(spare_scanners.size()+1);
+            image_scanner_type* spare = new image_scanner_type;
+            spare_scanners.push_back(spare);
+            spare->copy_configuration(config_scanner);
+            return spare;
+        }
+
+        void return_spare_scanner (
+            image_scanner_type* spare
+        ) const
+        {
+            auto_mutex lock(spare_mutex);
+            free_spare_scanners.push_back(spare);
+        }
+
+        class scanner_lease : noncopyable
+        {
+            /*!
+                WHAT THIS OBJECT REPRESENTS
+                    This is a scanner loaded with images[idx] for as long as this object
+                    exists.  Either the one that keeps that image loaded all the time, or a
+                    spare scanner the image is loaded into now and which goes back to the
+                    pool afterwards.  So only scanners.size() plus about as many scanners
+                    as there are threads ever hold a loaded image.
+            !*/
+        public:
+            scanner_lease (
+                const structural_svm_object_detection_problem& prob_,
+                long idx
+            ) : prob(prob_), spare(0)
+            {
+                if (idx < (long)prob.scanners.size())
+                {
+                    scanner = &prob.scanners[idx];
+                    return;
+                }
+
+                spare = prob.get_spare_scanner();
+                try
+                {
+                    spare->load(prob.images[idx]);
+                }
+                catch (...)
+                {
+                    prob.return_spare_scanner(spare);
+                    throw;
+                }
+                scanner = spare;
+            }
+
+            ~scanner_lease (
+            )
+            {
+                if (spare)
+                    prob.return_spare_scanner(spare);
+            }
+
+            const image_scanner_type& get (
+            ) const { return *scanner; }
+
+        private:
+            const structural_svm_object_detection_problem& prob;
+            image_scanner_type* spare;
+            const image_scanner_type* scanner;
+        };
+
 
         test_box_overlap boxes_overlap;
 
+        image_scanner_type config_scanner;
         mutable array<image_scanner_type> scanners;
+        mutable mutex spare_mutex;
+        mutable std::vector<image_scanner_type*> spare_scanners;
+        mutable std::vector<image_scanner_type*> free_spare_scanners;
 
         const image_array_type& images;
         const std::vector<std::vector<full_object_detection> >& truth_object_detections;
@@ -72,7 +72,8 @@ namespace dlib
             const std::vector<std::vector<full_object_detection> >& truth_object_detections,
             const std::vector<std::vector<rectangle> >& ignore,
             const test_box_overlap& ignore_overlap_tester,
-            unsigned long num_threads = 2
+            unsigned long num_threads = 2,
+            unsigned long scanner_cache_size = 0
         );
         /*!
             requires
@@ -105,6 +106,18 @@ namespace dlib
                 - This object will use num_threads threads during the optimization 
                   procedure.  You should set this parameter equal to the number of 
                   available processing cores on your machine.
+                - if (scanner_cache_size == 0) then
+                    - every image is loaded into its own scanner once, up front, and
+                      they all stay loaded during the optimization.
+                - else
+                    - only min(scanner_cache_size, images.size()) images stay loaded.
+                      The others are loaded into one of a few spare scanners, about one
+                      per thread, each time the optimizer needs them.  This bounds the
+                      memory taken by the scanners (e.g. the fHOG pyramids of a
+                      scan_fhog_pyramid), which otherwise grows with the number of
+                      images, at the cost of loading those images again in every
+                      iteration.  images[i] is then accessed during the whole
+                      optimization, not only here.
                 - #get_loss_per_missed_target() == 1
                 - #get_loss_per_false_alarm() == 1
                 - for all valid i:
@@ -226,6 +226,23 @@ namespace dlib
         mutable double last_true_risk_computed;
     };
 
+// ----------------------------------------------------------------------------------------
+
+    class structural_svm_status_observer
+    {
+    public:
+        virtual ~structural_svm_status_observer() {}
+
+        virtual bool update (
+            double current_objective_value,
+            double current_error_gap,
+            double current_risk_value,
+            double current_risk_gap,
+            unsigned long num_cutting_planes,
+            unsigned long num_iterations
+        ) = 0;
+    };
+
 // ----------------------------------------------------------------------------------------
 
     template <
@@ -262,6 +279,7 @@ namespace dlib
             eps(0.001),
             max_iterations(10000),
             verbose(false),
+            observer(0),
             skip_cache(true),
             count_below_eps(0),
             max_cache_size(5),
@@ -342,6 +360,16 @@ namespace dlib
             verbose = false;
         }
 
+        void set_status_observer (
+            structural_svm_status_observer* observer_
+        )
+        {
+            observer = observer_;
+        }
+
+        structural_svm_status_observer* get_status_observer (
+        ) const { return observer; }
+
         scalar_type get_c (
         ) const { return C; }
 
@@ -457,6 +485,11 @@ namespace dlib
                 cout << endl;
             }
 
+            if (observer && observer->update(current_objective_value, current_error_gap,
+                                             current_risk_value, current_risk_gap,
+                                             num_cutting_planes, num_iterations))
+                return true;
+
             if (num_iterations >= max_iterations)
                 return true;
 
@@ -628,6 +661,7 @@ namespace dlib
         scalar_type eps;
         unsigned long max_iterations;
         mutable bool verbose;
+        structural_svm_status_observer* observer;
 
 
         mutable std::vector<cache_element_structural_svm<structural_svm_problem> > cache;
@@ -10,6 +10,38 @@
 namespace dlib
 {
 
+// ----------------------------------------------------------------------------------------
+
+    class structural_svm_status_observer
+    {
+        /*!
+            WHAT THIS OBJECT REPRESENTS
+                This is an interface for watching a structural_svm_problem while it is
+                being optimized, for example to show its progress in a GUI or to stop it
+                early.  Unlike be_verbose() it doesn't print anything, so it is safe to use
+                while other threads write to standard out.
+        !*/
+    public:
+        virtual ~structural_svm_status_observer() {}
+
+        virtual bool update (
+            double current_objective_value,
+            double current_error_gap,
+            double current_risk_value,
+            double current_risk_gap,
+            unsigned long num_cutting_planes,
+            unsigned long num_iterations
+        ) = 0;
+        /*!
+            ensures
+                - This function is called once per iteration of the solver with the same
+                  values be_verbose() prints.  current_risk_value and current_risk_gap
+                  include the nuclear norm part, if there is one.
+                - If it returns true the optimization stops right away and the solver
+                  returns its current, not yet converged, solution.
+        !*/
+    };
+
 // ----------------------------------------------------------------------------------------
 
     template <
@@ -258,6 +290,25 @@ namespace dlib
                 - this object will not print anything to standard out
         !*/
 
+        void set_status_observer (
+            structural_svm_status_observer* observer
+        );
+        /*!
+            ensures
+                - #get_status_observer() == observer
+                - observer->update() will be called on every iteration of the optimizer,
+                  from the thread running it.  observer isn't owned by this object and
+                  must outlive the optimization.  0 (the default) disables it.
+        !*/
+
+        structural_svm_status_observer* get_status_observer (
+        ) const;
+        /*!
+            ensures
+                - returns the object notified about the progress of the optimization, or 0
+                  if there is none.
+        !*/
+
         scalar_type get_c (
         ) const; 
         /*!
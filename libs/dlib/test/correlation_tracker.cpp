@@ -0,0 +1,189 @@
+// Copyright (C) 2015  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+
+
+#include <dlib/image_processing.h>
+#include <dlib/image_transforms.h>
+#include <dlib/rand.h>
+#include <dlib/string.h>
+#include <vector>
+
+#include "tester.h"
+
+namespace
+{
+
+    using namespace test;
+    using namespace dlib;
+    using namespace std;
+
+    logger dlog("test.correlation_tracker");
+
+// ----------------------------------------------------------------------------------------
+
+    template <typename pixel_type>
+    class moving_target
+    {
+        /*!
+            WHAT THIS OBJECT REPRESENTS
+                Renders the frames of a synthetic video where a randomly textured 40x40
+                square moves diagonally over a noisy background.
+        !*/
+    public:
+        moving_target (
+        ) : texture(40,40)
+        {
+            dlib::rand rnd;
+            for (long r = 0; r < texture.nr(); ++r)
+            {
+                for (long c = 0; c < texture.nc(); ++c)
+                    texture[r][c] = rnd.get_random_8bit_number();
+            }
+        }
+
+        drectangle truth (
+            int frame
+        ) const
+        {
+            return centered_rect(point(80+3*frame, 100+frame), 40, 40);
+        }
+
+        void render (
+            int frame,
+            array2d<pixel_type>& img
+        ) const
+        {
+            img.set_size(240,320);
+            dlib::rand rnd;
+            rnd.set_seed(cast_to_string(frame));
+            for (long r = 0; r < img.nr(); ++r)
+            {
+                for (long c = 0; c < img.nc(); ++c)
+                    assign_pixel(img[r][c], (unsigned char)(rnd.get_random_8bit_number()/4));
+            }
+            const rectangle rect = truth(frame);
+            for (long r = 0; r < texture.nr(); ++r)
+            {
+                for (long c = 0; c < texture.nc(); ++c)
+                    assign_pixel(img[rect.top()+r][rect.left()+c], texture[r][c]);
+            }
+        }
+
+    private:
+        array2d<unsigned char> texture;
+    };
+
+// ----------------------------------------------------------------------------------------
+
+    template <typename tracker_type, typename pixel_type>
+    drectangle track_target (
+        tracker_type& tracker,
+        const int num_frames
+    )
+    {
+        moving_target<pixel_type> video;
+        array2d<pixel_type> img;
+        video.render(0, img);
+        tracker.start_track(img, video.truth(0));
+        for (int frame = 1; frame < num_frames; ++frame)
+        {
+            video.render(frame, img);
+            const double psr = tracker.update(img);
+            DLIB_TEST_MSG(psr > 5, psr);
+
+            const drectangle pos = tracker.get_position();
+            const drectangle truth = video.truth(frame);
+            DLIB_TEST_MSG(length(center(pos) - center(truth)) < 3, pos << "   " << truth);
+            DLIB_TEST_MSG(std::abs(pos.width()/truth.width() - 1) < 0.15, pos << "   " << truth);
+        }
+        return tracker.get_position();
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <typename T>
+    void test_tracker (
+        unsigned long filter_size,
+        unsigned long num_scale_levels,
+        unsigned long scale_window_size
+    )
+    {
+        print_spinner();
+        dlog << LINFO << "test_tracker() " << sizeof(T) << " " << filter_size << " "
+             << num_scale_levels << " " << scale_window_size;
+
+        basic_correlation_tracker<T> tracker(filter_size, num_scale_levels, scale_window_size);
+        DLIB_TEST(tracker.get_position().is_empty());
+        DLIB_TEST(tracker.get_filter_size() == (1UL<<filter_size));
+        DLIB_TEST(tracker.get_num_scale_levels() == (1UL<<num_scale_levels));
+        DLIB_TEST(tracker.get_scale_window_size() == scale_window_size);
+
+        const drectangle gray_pos = track_target<basic_correlation_tracker<T>, unsigned char>(tracker, 20);
+
+        // The chip buffers depend on the pixel type, switching it must not disturb the
+        // tracking.
+        basic_correlation_tracker<T> rgb_tracker(filter_size, num_scale_levels, scale_window_size);
+        track_target<basic_correlation_tracker<T>, rgb_pixel>(rgb_tracker, 20);
+        track_target<basic_correlation_tracker<T>, unsigned char>(rgb_tracker, 20);
+
+        // A copy gets its own scratch buffers but the same filters, so it keeps tracking
+        // exactly like the original.
+        moving_target<unsigned char> video;
+        array2d<unsigned char> img;
+        basic_correlation_tracker<T> copy(tracker);
+        for (int frame = 20; frame < 25; ++frame)
+        {
+            video.render(frame, img);
+            tracker.update(img);
+            copy.update(img);
+            DLIB_TEST(tracker.get_position().tl_corner() == copy.get_position().tl_corner());
+            DLIB_TEST(tracker.get_position().br_corner() == copy.get_position().br_corner());
+        }
+        DLIB_TEST(length(center(tracker.get_position()) - center(gray_pos)) > 10);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void test_float_matches_double (
+    )
+    {
+        print_spinner();
+        correlation_tracker tracker;
+        correlation_tracker_float tracker_float;
+        const drectangle pos = track_target<correlation_tracker, unsigned char>(tracker, 20);
+        const drectangle pos_float = track_target<correlation_tracker_float, unsigned char>(tracker_float, 20);
+        dlog << LINFO << "double: " << pos << "  float: " << pos_float;
+        DLIB_TEST_MSG(length(center(pos) - center(pos_float)) < 0.5, pos << "   " << pos_float);
+        DLIB_TEST_MSG(std::abs(pos.width() - pos_float.width()) < 0.5, pos << "   " << pos_float);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    class test_correlation_tracker : public tester
+    {
+    public:
+        test_correlation_tracker (
+        ) :
+            tester ("test_correlation_tracker",
+                    "Runs tests on the correlation_tracker objects.")
+        {}
+
+        void perform_test (
+        )
+        {
+            test_tracker<double>(6, 5, 23);
+            test_tracker<float>(6, 5, 23);
+            // the smaller and larger configurations
+            test_tracker<float>(5, 4, 15);
+            test_tracker<double>(5, 4, 15);
+            test_tracker<float>(7, 6, 31);
+            test_float_matches_double();
+        }
+    } a;
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+
+
@@ -10,6 +10,7 @@
 #include <dlib/rand.h>
 #include <dlib/compress_stream.h>
 #include <dlib/base64.h>
+#include <dlib/misc_api.h>
 
 #include "tester.h"
 
@@ -128,6 +129,154 @@ namespace
         }
     }
 
+// ----------------------------------------------------------------------------------------
+
+    void test_fftr()
+    {
+        for (int iter = 0; iter < 10; ++iter)
+        {
+            print_spinner();
+            for (int nr = 1; nr <= 128; nr*=2)
+            {
+                for (int nc = 2; nc <= 128; nc *= 2)
+                {
+                    const matrix<double> m1 = real(rand_complex(nr,nc));
+                    const matrix<float> fm1 = matrix_cast<float>(real(rand_complex(nr,nc)));
+
+                    // fftr() gives the non-redundant half of the full spectrum
+                    DLIB_TEST(max(norm(fftr(m1)-colm(fft(complex_matrix(m1)),range(0,nc/2)))) < 1e-16);
+                    // The float transforms take different paths so only agree up to rounding.
+                    DLIB_TEST(max(norm(fftr(fm1)-colm(fft(complex_matrix(fm1)),range(0,nc/2)))) < 1e-5);
+                    DLIB_TEST(max(squared(ifftr(fftr(m1))-m1)) < 1e-16);
+                    DLIB_TEST(max(squared(ifftr(fftr(fm1))-fm1)) < 1e-7);
+
+                    matrix<complex<double> > temp;
+                    matrix<double> back;
+                    fftr(m1, temp);
+                    DLIB_TEST(max(norm(temp-fftr(m1))) < 1e-16);
+                    ifftr(temp, back);
+                    DLIB_TEST(max(squared(back-m1)) < 1e-16);
+                }
+            }
+        }
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void test_batched_ffts()
+    {
+        for (int iter = 0; iter < 10; ++iter)
+        {
+            print_spinner();
+            for (int nr = 1; nr <= 64; nr*=2)
+            {
+                for (int nc = 2; nc <= 64; nc *= 2)
+                {
+                    std::vector<matrix<complex<double> > > data, orig;
+                    std::vector<matrix<complex<float> > > fdata, forig;
+                    std::vector<matrix<double> > rdata, rback;
+                    std::vector<matrix<complex<double> > > rspec;
+                    for (int i = 0; i < 5; ++i)
+                    {
+                        data.push_back(rand_complex(nr,nc));
+                        fdata.push_back(matrix_cast<complex<float> >(rand_complex(nr,nc)));
+                        rdata.push_back(real(rand_complex(nr,nc)));
+                    }
+                    orig = data;
+                    forig = fdata;
+
+                    fft_inplace(data);
+                    fft_inplace(fdata);
+                    fftr(rdata, rspec);
+                    DLIB_TEST(rspec.size() == rdata.size());
+                    for (unsigned long i = 0; i < data.size(); ++i)
+                    {
+                        DLIB_TEST(max(norm(data[i]-fft(orig[i]))) < 1e-16);
+                        DLIB_TEST(max(norm(fdata[i]-fft(forig[i]))) < 1e-7);
+                        DLIB_TEST(max(norm(rspec[i]-fftr(rdata[i]))) < 1e-16);
+                    }
+
+                    ifft_inplace(data);
+                    ifft_inplace(fdata);
+                    ifftr(rspec, rback);
+                    for (unsigned long i = 0; i < data.size(); ++i)
+                    {
+                        DLIB_TEST(max(norm(data[i]/data[i].size()-orig[i])) < 1e-16);
+                        DLIB_TEST(max(norm(fdata[i]/fdata[i].size()-forig[i])) < 1e-7);
+                        DLIB_TEST(max(squared(rback[i]-rdata[i])) < 1e-16);
+                    }
+                }
+            }
+        }
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <typename T>
+    void test_simd_matches_scalar()
+    {
+        // The SIMD butterflies must compute the same thing as the plain C++ ones.
+        for (int nr = 1; nr <= 256; nr*=2)
+        {
+            print_spinner();
+            for (int nc = 1; nc <= 256; nc *= 2)
+            {
+                const matrix<complex<T> > m = matrix_cast<complex<T> >(rand_complex(nr,nc));
+                matrix<complex<T> > a = m, b = m;
+                impl::fft_workspace<T> ws1, ws2;
+                ws2.cs.use_simd = false;
+                impl::fft_any_inplace(a, false, ws1);
+                impl::fft_any_inplace(b, false, ws2);
+                DLIB_TEST(max(norm(a-b)) < 1e-16*nr*nc);
+                impl::fft_any_inplace(a, true, ws1);
+                impl::fft_any_inplace(b, true, ws2);
+                DLIB_TEST(max(norm(a-b)) < 1e-16*nr*nc);
+            }
+        }
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <typename T>
+    double time_fft (
+        long nr,
+        long nc,
+        bool use_simd
+    )
+    /*!
+        ensures
+            - returns the average number of microseconds fft_inplace() takes on an nr by
+              nc matrix.
+    !*/
+    {
+        matrix<complex<T> > m = matrix_cast<complex<T> >(rand_complex(nr,nc));
+        impl::fft_workspace<T> ws;
+        ws.cs.use_simd = use_simd;
+        const long iters = 2000000/(nr*nc);
+        timestamper ts;
+        const uint64 start = ts.get_timestamp();
+        for (long i = 0; i < iters; ++i)
+            impl::fft_any_inplace(m, false, ws);
+        return (ts.get_timestamp()-start)/(double)iters;
+    }
+
+    template <typename T>
+    void benchmark_fft (
+        const std::string& type
+    )
+    {
+        // These are the sizes correlation_tracker uses by default, a 64x64 filter and 32
+        // scale levels.  Note that the 23x23 scale window is only the size of the image
+        // chips, the scale FFTs are over the 32 levels.
+        print_spinner();
+        const double scalar_2d = time_fft<T>(64,64,false);
+        const double simd_2d = time_fft<T>(64,64,true);
+        const double scalar_1d = time_fft<T>(32,1,false);
+        const double simd_1d = time_fft<T>(32,1,true);
+        dlog << LINFO << type << " 64x64 fft: scalar " << scalar_2d << "us, simd " << simd_2d << "us";
+        dlog << LINFO << type << " 32 point fft: scalar " << scalar_1d << "us, simd " << simd_1d << "us";
+    }
+
 // ----------------------------------------------------------------------------------------
 
     class test_fft : public tester
@@ -145,9 +294,32 @@ namespace
             test_against_saved_good_ffts();
             test_random_ffts();
             test_random_real_ffts();
+            test_fftr();
+            test_batched_ffts();
+            test_simd_matches_scalar<float>();
+            test_simd_matches_scalar<double>();
         }
     } a;
 
+// ----------------------------------------------------------------------------------------
+
+    class test_fft_speed : public tester
+    {
+    public:
+        test_fft_speed (
+        ) :
+            tester ("test_fft_speed",
+                    "Times the SIMD FFT butterflies against the scalar ones.  Run with -d to see the results.")
+        {}
+
+        void perform_test (
+        )
+        {
+            benchmark_fft<float>("float");
+            benchmark_fft<double>("double");
+        }
+    } b;
+
 // ----------------------------------------------------------------------------------------
 
     // This function returns the contents of the file 'fft_test_data.dat'
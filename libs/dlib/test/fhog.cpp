@@ -153,11 +153,58 @@ namespace
         }
 
 
+        void test_pixel_formats()
+        {
+            // The 8 pixel wide gradient code loads packed rgb, bgr and grayscale rows
+            // directly, so every layout of the same image must give the same features.
+            // The widths cover the 8 wide, 4 wide and scalar column loops.
+            dlib::rand rnd;
+            for (long nc = 14; nc < 30; ++nc)
+            {
+                print_spinner();
+                array2d<rgb_pixel> rgb(23, nc);
+                array2d<bgr_pixel> bgr(23, nc);
+                array2d<unsigned char> gray(23, nc);
+                array2d<float> fgray(23, nc);
+                for (long r = 0; r < rgb.nr(); ++r)
+                {
+                    for (long c = 0; c < rgb.nc(); ++c)
+                    {
+                        rgb[r][c] = rgb_pixel(rnd.get_random_8bit_number(),
+                                              rnd.get_random_8bit_number(),
+                                              rnd.get_random_8bit_number());
+                        assign_pixel(bgr[r][c], rgb[r][c]);
+                        gray[r][c] = rnd.get_random_8bit_number();
+                        fgray[r][c] = gray[r][c];
+                    }
+                }
+
+                for (int cell_size = 1; cell_size <= 4; ++cell_size)
+                {
+                    array2d<matrix<float,31,1> > hog1, hog2;
+                    extract_fhog_features(rgb, hog1, cell_size);
+                    extract_fhog_features(bgr, hog2, cell_size);
+                    DLIB_TEST(hog1.nr() == hog2.nr() && hog1.nc() == hog2.nc());
+                    for (long r = 0; r < hog1.nr(); ++r)
+                        for (long c = 0; c < hog1.nc(); ++c)
+                            DLIB_TEST(hog1[r][c] == hog2[r][c]);
+
+                    extract_fhog_features(gray, hog1, cell_size);
+                    extract_fhog_features(fgray, hog2, cell_size);
+                    DLIB_TEST(hog1.nr() == hog2.nr() && hog1.nc() == hog2.nc());
+                    for (long r = 0; r < hog1.nr(); ++r)
+                        for (long c = 0; c < hog1.nc(); ++c)
+                            DLIB_TEST(hog1[r][c] == hog2[r][c]);
+                }
+            }
+        }
+
         void perform_test (
         )
         {
             test_point_transforms();
             test_on_small();
+            test_pixel_formats();
 
             print_spinner();
             // load the testing data
@@ -430,6 +430,221 @@ namespace
             DLIB_TEST(d1.size() == d2.size());
             DLIB_TEST(set_intersection_size(d1,d2) == d1.size());
         }
+
+        {
+            // scanners loaded once can stand in for the images
+            dlib::array<image_scanner_type> loaded;
+            loaded.set_max_size(images.size());
+            loaded.set_size(images.size());
+            for (unsigned long i = 0; i < images.size(); ++i)
+            {
+                loaded[i].copy_configuration(scanner);
+                loaded[i].load(images[i]);
+            }
+
+            image_scanner_type s2;
+            s2.copy_configuration(scanner);
+            s2.load(loaded[0]);
+            DLIB_TEST(s2.is_loaded_with_image());
+            std::vector<rectangle> dets1 = detector(images[0]);
+            std::vector<rectangle> dets2 = detector(loaded[0]);
+            DLIB_TEST(dets1.size() > 0);
+            DLIB_TEST(dets1 == dets2);
+
+            structural_object_detection_trainer<image_scanner_type> trainer2(scanner);
+            trainer2.set_num_threads(1);
+            trainer2.set_overlap_tester(test_box_overlap(0,0));
+            object_detector<image_scanner_type> d1 = trainer2.train(images, object_locations);
+            object_detector<image_scanner_type> d2 = trainer2.train(loaded, object_locations);
+            DLIB_TEST(max(abs(d1.get_w() - d2.get_w())) < 1e-10);
+            DLIB_TEST(sum(test_object_detection_function(d2, images, object_locations)) == 3);
+            DLIB_TEST(sum(test_object_detection_function(d2, loaded, object_locations)) == 3);
+
+            // warm starting from a previous solution
+            trainer2.set_initial_weights(d1.get_w());
+            object_detector<image_scanner_type> d3 = trainer2.train(loaded, object_locations);
+            DLIB_TEST(sum(test_object_detection_function(d3, images, object_locations)) == 3);
+        }
+
+        {
+            // Keeping only some of the images loaded and loading the rest when they are
+            // needed learns the same thing, single threaded and with several threads
+            // sharing the spare scanners.
+            structural_object_detection_trainer<image_scanner_type> trainer2(scanner);
+            trainer2.set_num_threads(1);
+            DLIB_TEST(trainer2.get_scanner_cache_size() == 0);
+            object_detector<image_scanner_type> d1 = trainer2.train(images, object_locations);
+            for (unsigned long cache_size = 1; cache_size <= images.size()+1; ++cache_size)
+            {
+                trainer2.set_scanner_cache_size(cache_size);
+                DLIB_TEST(trainer2.get_scanner_cache_size() == cache_size);
+                object_detector<image_scanner_type> d2 = trainer2.train(images, object_locations);
+                DLIB_TEST(max(abs(d1.get_w() - d2.get_w())) < 1e-10);
+                DLIB_TEST(d1.get_overlap_tester().get_match_thresh() == d2.get_overlap_tester().get_match_thresh());
+                DLIB_TEST(d1.get_overlap_tester().get_overlap_thresh() == d2.get_overlap_tester().get_overlap_thresh());
+            }
+
+            trainer2.set_num_threads(4);
+            trainer2.set_scanner_cache_size(1);
+            object_detector<image_scanner_type> d3 = trainer2.train(images, object_locations);
+            DLIB_TEST(sum(test_object_detection_function(d3, images, object_locations)) == 3);
+        }
+
+        {
+            // a multithreaded load() builds exactly the same feature pyramid
+            dlib::rand rnd;
+            array2d<unsigned char> big(300,400);
+            array2d<rgb_pixel> big_rgb(300,400);
+            for (long r = 0; r < big.nr(); ++r)
+            {
+                for (long c = 0; c < big.nc(); ++c)
+                {
+                    big[r][c] = rnd.get_random_8bit_number();
+                    big_rgb[r][c] = rgb_pixel(rnd.get_random_8bit_number(), rnd.get_random_8bit_number(), rnd.get_random_8bit_number());
+                }
+            }
+
+            image_scanner_type s1, s2;
+            s1.copy_configuration(scanner);
+            s2.copy_configuration(scanner);
+            s2.set_num_threads(3);
+            DLIB_TEST(s2.get_num_threads() == 3);
+            for (int cell_size = 1; cell_size <= 8; cell_size *= 2)
+            {
+                s1.set_cell_size(cell_size);
+                s2.set_cell_size(cell_size);
+                ostringstream sout1, sout2, sout3, sout4;
+                s1.load(big);
+                s2.load(big);
+                serialize(s1, sout1);
+                serialize(s2, sout2);
+                DLIB_TEST(sout1.str() == sout2.str());
+                s1.load(big_rgb);
+                s2.load(big_rgb);
+                serialize(s1, sout3);
+                serialize(s2, sout4);
+                DLIB_TEST(sout3.str() == sout4.str());
+            }
+
+            // A single threaded pyramid_down<6> load streams its levels into the fHOG
+            // extraction while the multithreaded one makes the level images, so they
+            // must agree for odd image sizes and all the cell sizes too.
+            typedef scan_fhog_pyramid<pyramid_down<6> > scanner6_type;
+            scanner6_type s4, s5;
+            s4.set_detection_window_size(35,35);
+            s4.set_min_pyramid_layer_size(8,8);
+            s5.copy_configuration(s4);
+            s5.set_num_threads(2);
+            array2d<unsigned char> odd(157,211);
+            array2d<rgb_pixel> odd_rgb(157,211);
+            for (long r = 0; r < odd.nr(); ++r)
+            {
+                for (long c = 0; c < odd.nc(); ++c)
+                {
+                    odd[r][c] = big[r][c];
+                    odd_rgb[r][c] = big_rgb[r][c];
+                }
+            }
+            for (int cell_size = 1; cell_size <= 8; ++cell_size)
+            {
+                s4.set_cell_size(cell_size);
+                s5.set_cell_size(cell_size);
+                ostringstream sout1, sout2, sout3, sout4;
+                s4.load(odd);
+                s5.load(odd);
+                serialize(s4, sout1);
+                serialize(s5, sout2);
+                DLIB_TEST(sout1.str() == sout2.str());
+                s4.load(odd_rgb);
+                s5.load(odd_rgb);
+                serialize(s4, sout3);
+                serialize(s5, sout4);
+                DLIB_TEST(sout3.str() == sout4.str());
+            }
+
+            image_scanner_type s3;
+            s3.copy_configuration(scanner);
+            s3.set_num_threads(2);
+            object_detector<image_scanner_type> threaded(s3, detector.get_overlap_tester(), detector.get_w());
+            DLIB_TEST(threaded.get_scanner().get_num_threads() == 2);
+            for (unsigned long i = 0; i < images.size(); ++i)
+                DLIB_TEST(threaded(images[i]) == detector(images[i]));
+
+            // several filter banks are spread over the threads per pyramid level and
+            // still give the same detections in the same order
+            std::vector<image_scanner_type::feature_vector_type> ws(3, detector.get_w());
+            ws[1] *= 0.5;
+            ws[2] *= 2;
+            object_detector<image_scanner_type> multi(scanner, detector.get_overlap_tester(), ws);
+            object_detector<image_scanner_type> multi_threaded(s3, detector.get_overlap_tester(), ws);
+            for (unsigned long i = 0; i < images.size(); ++i)
+            {
+                std::vector<rect_detection> dets1, dets2;
+                multi(images[i], dets1, -0.5);
+                multi_threaded(images[i], dets2, -0.5);
+                DLIB_TEST(dets1.size() > 0);
+                DLIB_TEST(dets1.size() == dets2.size());
+                for (unsigned long j = 0; j < dets1.size() && j < dets2.size(); ++j)
+                {
+                    DLIB_TEST(dets1[j].rect == dets2[j].rect);
+                    DLIB_TEST(dets1[j].weight_index == dets2[j].weight_index);
+                    DLIB_TEST(dets1[j].detection_confidence == dets2[j].detection_confidence);
+                }
+            }
+
+            // Loading a sequence of frames incrementally only redoes the parts that
+            // changed but must give the same features and detections as loading each
+            // frame from scratch.
+            image_scanner_type s6;
+            s6.copy_configuration(scanner);
+            s6.set_loads_incrementally(true);
+            DLIB_TEST(s6.loads_incrementally());
+            object_detector<image_scanner_type> incremental(s6, detector.get_overlap_tester(), ws);
+            DLIB_TEST(incremental.get_scanner().loads_incrementally());
+            array2d<unsigned char> frame;
+            assign_image(frame, images[0]);
+            for (int i = 0; i < 8; ++i)
+            {
+                if (i%4 == 1)
+                {
+                    // move a small block around
+                    const long r0 = rnd.get_random_32bit_number()%(frame.nr()-10);
+                    const long c0 = rnd.get_random_32bit_number()%(frame.nc()-10);
+                    for (long r = r0; r < r0+10; ++r)
+                        for (long c = c0; c < c0+10; ++c)
+                            frame[r][c] = rnd.get_random_8bit_number();
+                }
+                else if (i%4 == 2)
+                {
+                    frame[rnd.get_random_32bit_number()%frame.nr()][0] += 50;
+                }
+                else if (i%4 == 3)
+                {
+                    for (long r = 0; r < frame.nr(); ++r)
+                        for (long c = 0; c < frame.nc(); ++c)
+                            frame[r][c] = 255 - frame[r][c];
+                }
+
+                std::vector<rect_detection> dets1, dets2;
+                multi(frame, dets1, -0.5);
+                incremental(frame, dets2, -0.5);
+                DLIB_TEST(dets1.size() == dets2.size());
+                for (unsigned long j = 0; j < dets1.size() && j < dets2.size(); ++j)
+                {
+                    DLIB_TEST(dets1[j].rect == dets2[j].rect);
+                    DLIB_TEST(dets1[j].weight_index == dets2[j].weight_index);
+                    DLIB_TEST(dets1[j].detection_confidence == dets2[j].detection_confidence);
+                }
+
+                ostringstream sout1, sout2;
+                s1.set_cell_size(scanner.get_cell_size());
+                s1.load(frame);
+                s6.load(frame);
+                serialize(s1, sout1);
+                serialize(s6, sout2);
+                DLIB_TEST(sout1.str() == sout2.str());
+            }
+        }
     }
 
 // ----------------------------------------------------------------------------------------
@@ -12,23 +12,40 @@ using namespace ofxDLib;
 FaceTracker::FaceTracker() {
     smoothingRate = 0.5;
     drawStyle = lines;
+    numThreads = 1;
+    bIncremental = false;
+    bHybrid = false;
+    detectionInterval = 30;
+    minimumConfidence = 7;
+    framesSinceDetection = 0;
+    predictor.reset(new dlib::shape_predictor());
     tracker.setSmoothingRate(smoothingRate);
 }
 
 //--------------------------------------------------------------
 void FaceTracker::setup(string predictorDatFilePath) {
     detector = dlib::get_frontal_face_detector();
+    configureDetector();
     if(predictorDatFilePath.empty()){
         predictorDatFilePath = ofToDataPath("shape_predictor_68_face_landmarks.dat");
     }
     ofFile f(predictorDatFilePath);
     if (f.exists()) {
-        dlib::deserialize(f.getAbsolutePath()) >> predictor;
+        std::shared_ptr<dlib::shape_predictor> loaded(new dlib::shape_predictor());
+        dlib::deserialize(f.getAbsolutePath()) >> *loaded;
+        predictor = loaded;
     } else {
         ofLogError("ofxDLib::FaceTracker","SHAPE PREDICTOR DAT FILE MISSING!!!");
     }
 }
 
+//--------------------------------------------------------------
+void FaceTracker::setup(std::shared_ptr<const dlib::shape_predictor> predictor) {
+    detector = dlib::get_frontal_face_detector();
+    configureDetector();
+    this->predictor = predictor;
+}
+
 //--------------------------------------------------------------
 void FaceTracker::findFaces(const ofPixels& pixels, bool bUpscale) {
     faces.clear();
@@ -37,12 +54,13 @@ void FaceTracker::findFaces(const ofPixels& pixels, bool bUpscale) {
     toDLib(pixels, img);
     if (bUpscale) pyramid_up(img);
     
-    std::vector<dlib::rectangle> dets = detector(img);
+    bool bDetected = true;
+    std::vector<dlib::rectangle> dets = detect(img, bDetected);
     tracker.track(toOf(dets));
     
     for (int i=0; i<dets.size(); i++) {
         vector<ofVec3f> currentLandmarks;
-        dlib::full_object_detection shapes = predictor(img, dets[i]);
+        dlib::full_object_detection shapes = (*predictor)(img, dets[i]);
         unsigned int label = tracker.getLabelFromIndex(i);
         bool existsShapeHistory = shapeHistory.count(label) > 0;
         bool existsSmoothingPerFace = smoothingRatePerFace.count(label) > 0;
@@ -54,6 +72,8 @@ void FaceTracker::findFaces(const ofPixels& pixels, bool bUpscale) {
         face.rect = tracker.getSmoothed(label);
         face.age = tracker.getAge(label);
         face.velocity = tracker.getVelocity(i);
+        face.tracked = !bDetected;
+        face.confidence = bDetected ? 0 : confidences[i];
         for (int j=0; j<shapes.num_parts(); j++) {
             ofVec3f point;
             ofVec3f current = toOf(shapes.part(j));
@@ -64,55 +84,7 @@ void FaceTracker::findFaces(const ofPixels& pixels, bool bUpscale) {
             currentLandmarks.push_back(point);
             face.landmarks.push_back(point);
         }
-        if (face.landmarks.size() == 68) {
-            for (int j=0; j<=16; j++) { // jaw
-                face.jaw.addVertex(face.landmarks[j]);
-            }
-            
-            for (int j=17; j<=21; j++) { // leftEyebrow
-                face.leftEyebrow.addVertex(face.landmarks[j]);
-            }
-            
-            for (int j=22; j<=26; j++) { // rightEyebrow
-                face.rightEyebrow.addVertex(face.landmarks[j]);
-            }
-            
-            for (int j=27; j<=30; j++) { // noseBridge
-                face.noseBridge.addVertex(face.landmarks[j]);
-            }
-            
-            for (int j=30; j<=35; j++) { // noseTip
-                face.noseTip.addVertex(face.landmarks[j]);
-            }
-            face.noseTip.addVertex(face.landmarks[30]);
-            face.noseTip.close();
-            
-            for (int j=36; j<=41; j++) { // leftEye
-                face.leftEye.addVertex(face.landmarks[j]);
-            }
-            face.leftEye.addVertex(face.landmarks[36]);
-            face.leftEye.close();
-            face.leftEyeCenter = face.leftEye.getCentroid2D();
-            
-            for (int j=42; j<=47; j++) { // rightEye
-                face.rightEye.addVertex(face.landmarks[j]);
-            }
-            face.rightEye.addVertex(face.landmarks[42]);
-            face.rightEye.close();
-            face.rightEyeCenter = face.rightEye.getCentroid2D();
-            
-            for (int j=48; j<=59; j++) { // outerMouth
-                face.outerMouth.addVertex(face.landmarks[j]);
-            }
-            face.outerMouth.addVertex(face.landmarks[48]);
-            face.outerMouth.close();
-            
-            for (int j=60; j<=67; j++) { // innerMouth
-                face.innerMouth.addVertex(face.landmarks[j]);
-            }
-            face.innerMouth.addVertex(face.landmarks[60]);
-            face.innerMouth.close();
-        }
+        buildShapes(face);
         shapeHistory[label] = currentLandmarks;
         faces.push_back(face);
         
@@ -129,6 +101,91 @@ void FaceTracker::findFaces(const ofPixels& pixels, bool bUpscale) {
     }
 }
 
+//--------------------------------------------------------------
+void FaceTracker::buildShapes(Face& face) {
+    if (face.landmarks.size() == 68) {
+        for (int j=0; j<=16; j++) { // jaw
+            face.jaw.addVertex(face.landmarks[j]);
+        }
+        
+        for (int j=17; j<=21; j++) { // leftEyebrow
+            face.leftEyebrow.addVertex(face.landmarks[j]);
+        }
+        
+        for (int j=22; j<=26; j++) { // rightEyebrow
+            face.rightEyebrow.addVertex(face.landmarks[j]);
+        }
+        
+        for (int j=27; j<=30; j++) { // noseBridge
+            face.noseBridge.addVertex(face.landmarks[j]);
+        }
+        
+        for (int j=30; j<=35; j++) { // noseTip
+            face.noseTip.addVertex(face.landmarks[j]);
+        }
+        face.noseTip.addVertex(face.landmarks[30]);
+        face.noseTip.close();
+        
+        for (int j=36; j<=41; j++) { // leftEye
+            face.leftEye.addVertex(face.landmarks[j]);
+        }
+        face.leftEye.addVertex(face.landmarks[36]);
+        face.leftEye.close();
+        face.leftEyeCenter = face.leftEye.getCentroid2D();
+        
+        for (int j=42; j<=47; j++) { // rightEye
+            face.rightEye.addVertex(face.landmarks[j]);
+        }
+        face.rightEye.addVertex(face.landmarks[42]);
+        face.rightEye.close();
+        face.rightEyeCenter = face.rightEye.getCentroid2D();
+        
+        for (int j=48; j<=59; j++) { // outerMouth
+            face.outerMouth.addVertex(face.landmarks[j]);
+        }
+        face.outerMouth.addVertex(face.landmarks[48]);
+        face.outerMouth.close();
+        
+        for (int j=60; j<=67; j++) { // innerMouth
+            face.innerMouth.addVertex(face.landmarks[j]);
+        }
+        face.innerMouth.addVertex(face.landmarks[60]);
+        face.innerMouth.close();
+    }
+}
+
+//--------------------------------------------------------------
+std::vector<dlib::rectangle> FaceTracker::detect(const dlib::array2d<dlib::rgb_pixel>& img, bool& bDetected) {
+    std::vector<dlib::rectangle> dets;
+    if (!bHybrid) {
+        correlationTrackers.clear();
+        confidences.clear();
+        bDetected = true;
+        return detector(img);
+    }
+    
+    // follow the faces of the last detection as long as every tracker is confident
+    framesSinceDetection++;
+    bDetected = correlationTrackers.empty() || framesSinceDetection >= detectionInterval;
+    for (int i=0; i<correlationTrackers.size() && !bDetected; i++) {
+        confidences[i] = correlationTrackers[i].update(img);
+        bDetected = confidences[i] < minimumConfidence;
+        dets.push_back(dlib::rectangle(correlationTrackers[i].get_position()));
+    }
+    if (!bDetected) {
+        return dets;
+    }
+    
+    dets = detector(img);
+    framesSinceDetection = 0;
+    correlationTrackers.resize(dets.size());
+    confidences.assign(dets.size(), 0);
+    for (int i=0; i<dets.size(); i++) {
+        correlationTrackers[i].start_track(img, dlib::drectangle(dets[i]));
+    }
+    return dets;
+}
+
 //--------------------------------------------------------------
 unsigned int FaceTracker::size() {
     return faces.size();
@@ -252,6 +309,69 @@ void FaceTracker::setDrawStyle(DrawStyle style) {
     this->drawStyle = style;
 }
 
+//--------------------------------------------------------------
+void FaceTracker::setNumThreads(unsigned int numThreads) {
+    this->numThreads = std::max(1u, numThreads);
+    configureDetector();
+}
+
+//--------------------------------------------------------------
+unsigned int FaceTracker::getNumThreads() {
+    return numThreads;
+}
+
+//--------------------------------------------------------------
+void FaceTracker::setIncrementalDetection(bool bIncremental) {
+    this->bIncremental = bIncremental;
+    configureDetector();
+}
+
+//--------------------------------------------------------------
+bool FaceTracker::getIncrementalDetection() {
+    return bIncremental;
+}
+
+//--------------------------------------------------------------
+void FaceTracker::configureDetector() {
+    if (detector.num_detectors() == 0) return;
+    // the thread count and incremental loading are part of the scanner's configuration, so the
+    // detector is rebuilt around them
+    dlib::frontal_face_detector::image_scanner_type scanner;
+    scanner.copy_configuration(detector.get_scanner());
+    scanner.set_num_threads(numThreads);
+    scanner.set_loads_incrementally(bIncremental);
+    std::vector<dlib::frontal_face_detector::feature_vector_type> w;
+    for (unsigned long i = 0; i < detector.num_detectors(); i++) {
+        w.push_back(detector.get_w(i));
+    }
+    detector = dlib::frontal_face_detector(scanner, detector.get_overlap_tester(), w);
+}
+
+//--------------------------------------------------------------
+void FaceTracker::setHybridTracking(bool bHybrid, unsigned int detectionInterval, float minimumConfidence) {
+    this->bHybrid = bHybrid;
+    this->detectionInterval = std::max(1u, detectionInterval);
+    this->minimumConfidence = minimumConfidence;
+    // start with a detection
+    correlationTrackers.clear();
+    confidences.clear();
+}
+
+//--------------------------------------------------------------
+bool FaceTracker::getHybridTracking() {
+    return bHybrid;
+}
+
+//--------------------------------------------------------------
+float FaceTracker::getConfidence(unsigned int i) {
+    return faces[i].confidence;
+}
+
+//--------------------------------------------------------------
+bool FaceTracker::isTracked(unsigned int i) {
+    return faces[i].tracked;
+}
+
 //--------------------------------------------------------------
 void FaceTracker::draw() {
     ofPushStyle();
@@ -260,7 +380,7 @@ void FaceTracker::draw() {
     ofNoFill();
     
     for (auto & face : faces) {
-        ofDrawBitmapString(ofToString(face.label), face.rect.getTopLeft());
+        ofDrawBitmapString(ofToString(face.label) + (face.tracked ? " " + ofToString(face.confidence, 1) : ""), face.rect.getTopLeft());
         ofDrawRectangle(face.rect);
         
         switch (drawStyle) {
@@ -288,3 +408,70 @@ void FaceTracker::draw() {
     
     ofPopStyle();
 }
+
+//--------------------------------------------------------------
+void ofxDLib::serialize(const FaceTracker& item, std::ostream& out) {
+    int version = 2;
+    dlib::serialize(version, out);
+    serialize(item.tracker, out);
+    dlib::serialize(item.smoothingRate, out);
+    dlib::serialize(item.smoothingRatePerFace, out);
+    dlib::serialize(item.shapeHistory, out);
+    // the polylines and eye centers are rebuilt from the landmarks
+    dlib::serialize(item.faces.size(), out);
+    for (auto & face : item.faces) {
+        dlib::serialize(face.label, out);
+        dlib::serialize(face.age, out);
+        serialize(face.rect, out);
+        serialize(face.velocity, out);
+        dlib::serialize(face.tracked, out);
+        dlib::serialize(face.confidence, out);
+        dlib::serialize(face.landmarks, out);
+    }
+    dlib::serialize((int)item.drawStyle, out);
+    dlib::serialize(item.numThreads, out);
+    dlib::serialize(item.bIncremental, out);
+    dlib::serialize(item.bHybrid, out);
+    dlib::serialize(item.detectionInterval, out);
+    dlib::serialize(item.minimumConfidence, out);
+}
+
+//--------------------------------------------------------------
+void ofxDLib::deserialize(FaceTracker& item, std::istream& in) {
+    int version = 0;
+    dlib::deserialize(version, in);
+    if (version != 2) {
+        throw dlib::serialization_error("Unexpected version found while deserializing ofxDLib::FaceTracker.");
+    }
+    deserialize(item.tracker, in);
+    dlib::deserialize(item.smoothingRate, in);
+    dlib::deserialize(item.smoothingRatePerFace, in);
+    dlib::deserialize(item.shapeHistory, in);
+    size_t size = 0;
+    dlib::deserialize(size, in);
+    item.faces.clear();
+    item.faces.resize(size);
+    for (auto & face : item.faces) {
+        dlib::deserialize(face.label, in);
+        dlib::deserialize(face.age, in);
+        deserialize(face.rect, in);
+        deserialize(face.velocity, in);
+        dlib::deserialize(face.tracked, in);
+        dlib::deserialize(face.confidence, in);
+        dlib::deserialize(face.landmarks, in);
+        FaceTracker::buildShapes(face);
+    }
+    int drawStyle = 0;
+    dlib::deserialize(drawStyle, in);
+    item.drawStyle = (DrawStyle)drawStyle;
+    dlib::deserialize(item.numThreads, in);
+    dlib::deserialize(item.bIncremental, in);
+    dlib::deserialize(item.bHybrid, in);
+    dlib::deserialize(item.detectionInterval, in);
+    dlib::deserialize(item.minimumConfidence, in);
+    item.configureDetector();
+    // the correlation trackers aren't stored, so the next frame of hybrid mode runs the detector
+    item.correlationTrackers.clear();
+    item.confidences.clear();
+    item.framesSinceDetection = 0;
+}
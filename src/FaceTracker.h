@@ -9,6 +9,7 @@
 #pragma once
 #include "ofxDLib.h"
 #include "Tracker.h"
+#include <memory>
 
 namespace ofxDLib {
     
@@ -25,6 +26,10 @@ namespace ofxDLib {
         int age;
         ofRectangle rect;
         ofVec2f velocity, leftEyeCenter, rightEyeCenter;
+        // true if rect came from the correlation tracker in hybrid mode, false if it was detected this frame
+        bool tracked;
+        // peak to side lobe ratio of the correlation tracker, 0 when detected
+        float confidence;
         ofPolyline leftEye, rightEye, innerMouth, outerMouth, leftEyebrow, rightEyebrow, jaw, noseBridge, noseTip;
         vector<ofVec3f> landmarks;
     } Face;
@@ -33,18 +38,35 @@ namespace ofxDLib {
     protected:
         // face tracker
         dlib::frontal_face_detector detector;
-        dlib::shape_predictor predictor;
+        // never modified once loaded, so trackers can share one
+        std::shared_ptr<const dlib::shape_predictor> predictor;
         vector<Face> faces;
         map<unsigned int, vector<ofVec3f>> shapeHistory;
         map<unsigned int, float> smoothingRatePerFace;
         float smoothingRate;
         DrawStyle drawStyle;
+        unsigned int numThreads;
+        bool bIncremental;
+        void configureDetector();
         
         // assign labels
         RectTracker tracker;
+        
+        // hybrid mode, faces are followed by correlation trackers between detections
+        bool bHybrid;
+        float minimumConfidence;
+        unsigned int detectionInterval, framesSinceDetection;
+        std::vector<dlib::correlation_tracker_float> correlationTrackers;
+        std::vector<float> confidences;
+        std::vector<dlib::rectangle> detect(const dlib::array2d<dlib::rgb_pixel>& img, bool& bDetected);
+        // the polylines and eye centers from the 68 landmarks
+        static void buildShapes(Face& face);
     public:
         FaceTracker();
         void setup(string predictorDatFilePath);
+        // uses predictor without copying it, e.g. one loaded model for several trackers. Its
+        // operator() is const, so trackers on different threads can share it
+        void setup(std::shared_ptr<const dlib::shape_predictor> predictor);
         void findFaces(const ofPixels& pixels, bool bUpscale = false);
         unsigned int size();
         RectTracker& getTracker();
@@ -61,8 +83,31 @@ namespace ofxDLib {
         float getSmoothingRate();
         float getSmoothingRate(unsigned int label);
         void setDrawStyle(DrawStyle style);
+        // threads the face detector builds its fHOG pyramid and runs its five filters with, 1 by
+        // default. Worth it for big frames, MultiStreamTracker already spreads streams over the cores
+        void setNumThreads(unsigned int numThreads);
+        unsigned int getNumThreads();
+        // for static cameras: only redo the detector's work around the parts of the frame that
+        // changed since the last detection, off by default. Keeps copies of the frame's image pyramid
+        // and the filter responses around, and only pays off when the frame size stays the same
+        void setIncrementalDetection(bool bIncremental);
+        bool getIncrementalDetection();
+        // run the face detector only every detectionInterval frames or when the confidence of
+        // a correlation tracker drops below minimumConfidence, and follow the faces in between
+        void setHybridTracking(bool bHybrid, unsigned int detectionInterval = 30, float minimumConfidence = 7);
+        bool getHybridTracking();
+        float getConfidence(unsigned int i);
+        bool isTracked(unsigned int i);
         void draw();
-
+        
+        // labels, smoothing, per label history, the last faces and the settings. The detector
+        // weights and shape predictor come from setup(), and the correlation trackers of hybrid
+        // mode aren't stored, so after a restore the next frame runs the detector
+        friend void serialize(const FaceTracker& item, std::ostream& out);
+        friend void deserialize(FaceTracker& item, std::istream& in);
     };
     
+    void serialize(const FaceTracker& item, std::ostream& out);
+    void deserialize(FaceTracker& item, std::istream& in);
+    
 }
\ No newline at end of file
@@ -11,141 +11,853 @@
 
 using namespace ofxDLib;
 
+namespace {
+    // thrown on the training thread to unwind it once cancel() was called
+    struct TrainingCancelled {};
+    
+    // hands the trainer's progress after every iteration to a callback, which returns true to
+    // stop it. Copies of a trainer share it, so the callback must be thread safe
+    class TrainingObserver : public structural_svm_status_observer {
+    public:
+        TrainingObserver(std::function<bool(double, unsigned long)> onStatus)
+        :onStatus(onStatus) {}
+        bool update(double objective, double objectiveGap, double risk, double riskGap, unsigned long numPlanes, unsigned long iteration){
+            return onStatus(riskGap, iteration);
+        }
+    protected:
+        std::function<bool(double, unsigned long)> onStatus;
+    };
+    
+    // the images of a dataset at idx, what a sweep run trains on while streaming. Unlike
+    // impl::array_subset_helper it returns them by value, as ImageDataset does
+    template <class T>
+    struct ArraySubset {
+        typedef typename T::type type;
+        typedef default_memory_manager mem_manager_type;
+        ArraySubset(const T& array, const std::vector<unsigned long>& idx)
+        :array(array), idx(idx) {}
+        unsigned long size() const { return idx.size(); }
+        type operator[](unsigned long i) const { return array[idx[i]]; }
+        
+        const T& array;
+        const std::vector<unsigned long>& idx;
+    };
+    
+    // dlib's input checks only look at the size of mat(images), like for ImageDataset
+    template <class T>
+    const matrix_op<op_array_to_mat<ArraySubset<T> > > mat(const ArraySubset<T>& images) {
+        typedef op_array_to_mat<ArraySubset<T> > op;
+        return matrix_op<op>(op(images));
+    }
+    
+    // loaded scanners standing in for the training images, see scan_fhog_pyramid::load(scanner)
+    struct PyramidArray : std::vector<const HOGtrainer::image_scanner_type*> {
+        typedef HOGtrainer::image_scanner_type type;
+        typedef default_memory_manager mem_manager_type;
+        const type& operator[](unsigned long i) const {
+            return *std::vector<const type*>::operator[](i);
+        }
+    };
+}
+
 HOGtrainer::HOGtrainer()
 {
+    curTestImage = 0;
+    curTrainImage = 0;
+    pending.numThreads = std::max(1u, std::thread::hardware_concurrency());
+    pending.bUpsample = pending.bFlip = true;
+    pending.cacheSize = 0;
+    pending.prefetch = 0;
+    pending.timingPasses = 3;
+    settings = pending;
+    bCachePyramids = false;
+    bCancel = false;
+    progress = TrainerProgress();
+    progress.state = TRAINER_IDLE;
+    progress.eta = -1;
+    bDatasetsLoaded = bDetectorTrained = false;
+    bShowDatasets = bShowDetections = false;
 }
 
 HOGtrainer::~HOGtrainer(){
-    //close();
+    cancel();
+    waitForTraining();
 }
 
 
 void HOGtrainer::setup(string _trainDir){
+    start();
+    thread = std::thread(&HOGtrainer::threadedFunction, this, ofToDataPath(_trainDir), matrix<double,0,1>());
+}
+
+void HOGtrainer::retrain(string _trainDir){
+    start();
+    // no training thread runs here. Start from the weights the last training ended with, before
+    // its filters were thresholded, unless detector was replaced since
+    matrix<double,0,1> initialWeights;
+    if (detector.num_detectors() > 0) {
+        initialWeights = trainedWeights.size() > 0 && detector.get_w() == thresholdedWeights ? trainedWeights : detector.get_w();
+    }
+    bCachePyramids = true;
+    thread = std::thread(&HOGtrainer::threadedFunction, this, ofToDataPath(_trainDir), initialWeights);
+}
+
+void HOGtrainer::setPyramidCaching(bool bCache){
+    waitForTraining();
+    bCachePyramids = bCache;
+    if (!bCachePyramids) {
+        pyramidCache.clear();
+    }
+}
+
+void HOGtrainer::sweep(string _trainDir, const std::vector<double>& cs, const std::vector<double>& epsilons, const std::vector<double>& nuclearNorms, unsigned int numFolds){
+    start();
+    thread = std::thread(&HOGtrainer::threadedSweep, this, ofToDataPath(_trainDir), cs, epsilons, nuclearNorms, numFolds);
+}
+
+void HOGtrainer::start(){
+    cancel();
+    waitForTraining();
     
     curTestImage = 0;
-    //    uint64_t st =ofGetElapsedTimeMillis();
-    //
-    //    detector = get_frontal_face_detector();
-    //    cout << "get_frontal_face_detector: " << ofGetElapsedTimeMillis() - st << " ms." << endl;
-    //    //http://dlib.net/files/shape_predictor_68_face_landmarks.dat.bz2
-    //    ofFile f(ofToDataPath("shape_predictor_68_face_landmarks.dat"));
-    //    if (f.exists()) {
-    //        deserialize(f.getAbsolutePath()) >> shape_predictor_object;
-    //    }else{
-    //        cout << "SHAPE PREDICTOR DAT FILE MISSING!!!" << endl;
-    //    }
-    //
-    const std::string faces_directory = ofToDataPath(_trainDir);
-    
-    load_image_dataset(images_train, face_boxes_train, faces_directory+"/training.xml");//face_boxes_train_ignore
-    load_image_dataset(images_test, face_boxes_test, faces_directory+"/testing.xml");
-    
-    upsample_image_dataset<pyramid_down<2> >(images_train, face_boxes_train);
-    upsample_image_dataset<pyramid_down<2> >(images_test,  face_boxes_test);
-    
-    add_image_left_right_flips(images_train, face_boxes_train);
+    curTrainImage = 0;
+    bCancel = false;
+    bShowDatasets = bShowDetections = false;
+    testRects.clear();
+    trainRects.clear();
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        progress = TrainerProgress();
+        progress.state = TRAINER_LOADING;
+        progress.eta = -1;
+        bDatasetsLoaded = bDetectorTrained = false;
+        sweepResults.clear();
+        filterTuningResults.clear();
+        startTime = ofGetElapsedTimeMicros();
+        // the job works with the settings as they are now, later changes apply to the next one
+        settings = pending;
+    }
+}
+
+std::vector<SweepResult> HOGtrainer::getSweepResults(){
+    std::unique_lock<std::mutex> lock(mutex);
+    return sweepResults;
+}
+
+void HOGtrainer::setFilterTuning(const std::vector<double>& thresholds, unsigned int timingPasses){
+    std::unique_lock<std::mutex> lock(mutex);
+    pending.filterThresholds = thresholds;
+    pending.timingPasses = std::max(1u, timingPasses);
+}
+
+std::vector<FilterTuningResult> HOGtrainer::getFilterTuningResults(){
+    std::unique_lock<std::mutex> lock(mutex);
+    return filterTuningResults;
+}
+
+FilterTuningResult HOGtrainer::getFastestDetector(double minAveragePrecision){
+    std::unique_lock<std::mutex> lock(mutex);
+    FilterTuningResult fastest = FilterTuningResult();
+    for (auto& r : filterTuningResults) {
+        if (r.bPareto && r.averagePrecision >= minAveragePrecision && (fastest.numFilters == 0 || r.detectionTime < fastest.detectionTime)) {
+            fastest = r;
+        }
+    }
+    return fastest;
+}
+
+void HOGtrainer::setNumThreads(unsigned int numThreads){
+    std::unique_lock<std::mutex> lock(mutex);
+    pending.numThreads = std::max(1u, numThreads);
+}
+
+void HOGtrainer::setAugmentation(bool bUpsample, bool bFlip){
+    std::unique_lock<std::mutex> lock(mutex);
+    pending.bUpsample = bUpsample;
+    pending.bFlip = bFlip;
+}
+
+void HOGtrainer::setStreaming(unsigned long cacheSize, unsigned long prefetch){
+    std::unique_lock<std::mutex> lock(mutex);
+    pending.cacheSize = cacheSize;
+    pending.prefetch = cacheSize > 0 ? prefetch : 0;
+}
+
+void HOGtrainer::cancel(){
+    bCancel = true;
+}
+
+void HOGtrainer::waitForTraining(){
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+bool HOGtrainer::isTraining(){
+    std::unique_lock<std::mutex> lock(mutex);
+    return progress.state >= TRAINER_LOADING && progress.state <= TRAINER_SAVING;
+}
+
+TrainerProgress HOGtrainer::getProgress(){
+    std::unique_lock<std::mutex> lock(mutex);
+    TrainerProgress p = progress;
+    if (p.state != TRAINER_IDLE) {
+        p.elapsed = (ofGetElapsedTimeMicros() - startTime) / 1000000.f;
+    }
+    return p;
+}
+
+void HOGtrainer::setState(TrainerState state){
+    std::unique_lock<std::mutex> lock(mutex);
+    progress.state = state;
+    if (state == TRAINER_DONE || state == TRAINER_CANCELLED || state == TRAINER_FAILED) {
+        progress.elapsed = (ofGetElapsedTimeMicros() - startTime) / 1000000.f;
+        progress.eta = -1;
+    }
+}
+
+bool HOGtrainer::trainingStatus(double riskGap, unsigned long iteration){
+    std::unique_lock<std::mutex> lock(mutex);
+    progress.riskGap = riskGap;
+    progress.iteration = iteration;
+    // the risk gap shrinks roughly geometrically, extrapolate its rate so far down to epsilon
+    float now = (ofGetElapsedTimeMicros() - trainingStartTime) / 1000000.f;
+    if (firstRiskGap <= 0) {
+        firstRiskGap = progress.riskGap;
+        firstRiskGapTime = now;
+    } else if (progress.riskGap <= progress.epsilon) {
+        // only refining the solution from here on
+        progress.eta = 0;
+    } else if (progress.riskGap < firstRiskGap && now > firstRiskGapTime) {
+        float rate = std::log(firstRiskGap / progress.riskGap) / (now - firstRiskGapTime);
+        progress.eta = std::log(progress.riskGap / progress.epsilon) / rate;
+    }
+    return bCancel;
+}
+
+std::vector<std::vector<rectangle> > HOGtrainer::loadDataset(const string& xml, ImageDataset& images, std::vector<std::vector<rectangle> >& boxes, std::vector<string>& names, bool bUpsample, bool bFlip){
+    image_dataset_metadata::dataset data;
+    image_dataset_metadata::load_image_dataset_metadata(data, xml);
+    // image paths are relative to the xml file
+    const string dir = get_parent_directory(file(xml)).full_name() + directory::get_separator();
+    
+    const unsigned long num = data.images.size();
+    std::vector<string> paths(num);
+    for (unsigned long i = 0; i < num; ++i) {
+        const string& filename = data.images[i].filename;
+        bool bAbsolute = filename.size() > 0 && (filename[0] == '/' || filename[0] == '\\' || (filename.size() > 1 && filename[1] == ':'));
+        paths[i] = bAbsolute ? filename : dir + filename;
+    }
+    images.setCacheSize(settings.cacheSize);
+    images.setPrefetch(settings.prefetch);
+    images.setup(paths, bUpsample, bFlip);
+    
+    // every image gets its slots up front so workers write straight into the final arrays
+    const unsigned long total = images.size();
+    boxes.assign(total, std::vector<rectangle>());
+    names.resize(total);
+    std::vector<std::vector<rectangle> > ignored(total);
+    
+    std::mutex errorMutex;
+    string error;
+    dlib::parallel_for(settings.numThreads, 0, num, [&](long i){
+        if (bCancel) return;
+        try {
+            const image_dataset_metadata::image& meta = data.images[i];
+            for (auto& box : meta.boxes) {
+                (box.ignore ? ignored[i] : boxes[i]).push_back(box.rect);
+            }
+            names[i] = images.getName(i);
+            
+            // decoding finds unreadable images now rather than on the trainer's threads later
+            array2d<unsigned char> img;
+            images.decode(i, img);
+            if (bUpsample) {
+                pyramid_down<2> pyr;
+                for (auto& r : boxes[i]) r = pyr.rect_up(r);
+                for (auto& r : ignored[i]) r = pyr.rect_up(r);
+            }
+            
+            if (bFlip) {
+                array2d<unsigned char> flipped;
+                const point_transform_affine tran = flip_image_left_right(img, flipped);
+                // same mapping add_image_left_right_flips uses
+                for (auto& r : boxes[i]) boxes[num+i].push_back(impl::tform_object(tran, r));
+                for (auto& r : ignored[i]) ignored[num+i].push_back(impl::tform_object(tran, r));
+                names[num+i] = images.getName(num+i);
+                images.store(num+i, flipped);
+            }
+            images.store(i, img);
+        } catch (std::exception& e) {
+            // dlib's thread pool doesn't pass exceptions on, rethrown below
+            std::unique_lock<std::mutex> lock(errorMutex);
+            if (error.empty()) error = e.what();
+        }
+    });
+    
+    if (bCancel) throw TrainingCancelled();
+    if (!error.empty()) throw dlib::error(error);
+    return ignored;
+}
+
+void HOGtrainer::loadDatasets(const string& faces_directory){
+    face_boxes_train_ignore = loadDataset(faces_directory+"/training.xml", images_train, face_boxes_train, trainNames, settings.bUpsample, settings.bFlip);
+    loadDataset(faces_directory+"/testing.xml", images_test, face_boxes_test, testNames, settings.bUpsample, false);
+    
     cout << "num training images: " << images_train.size() << endl;
     cout << "num testing images:  " << images_test.size() << endl;
     
-    ofxDLib::toOf(images_test[0],testPix);
-    
-    
-    image_scanner_type scanner;
-    // The sliding window detector will be 80 pixels wide and 80 pixels tall.
-    scanner.set_detection_window_size(80, 80);
-    structural_object_detection_trainer<image_scanner_type> trainer(scanner);
-    // Set this to the number of processing cores on your machine.
-    trainer.set_num_threads(4);
-    // The trainer is a kind of support vector machine and therefore has the usual SVM
-    // C parameter.  In general, a bigger C encourages it to fit the training data
-    // better but might lead to overfitting.  You must find the best C value
-    // empirically by checking how well the trained detector works on a test set of
-    // images you haven't trained on.  Don't just leave the value set at 1.  Try a few
-    // different C values and see what works best for your data.
-    trainer.set_c(1);
-    // We can tell the trainer to print it's progress to the console if we want.
-    trainer.be_verbose();
-    // The trainer will run until the "risk gap" is less than 0.01.  Smaller values
-    // make the trainer solve the SVM optimization problem more accurately but will
-    // take longer to train.  For most problems a value in the range of 0.1 to 0.01 is
-    // plenty accurate.  Also, when in verbose mode the risk gap is printed on each
-    // iteration so you can see how close it is to finishing the training.
-    trainer.set_epsilon(0.01);
-    
-    // Now we run the trainer.  For this example, it should take on the order of 10
-    // seconds to train.
-    detector = trainer.train(images_train, face_boxes_train); //,face_boxes_train_ignore);
-    
-    // Now that we have a face detector we can test it.  The first statement tests it
-    // on the training data.  It will print the precision, recall, and then average precision.
-    cout << "training results: " << test_object_detection_function(detector, images_train, face_boxes_train) << endl;
-    // However, to get an idea if it really worked without overfitting we need to run
-    // it on images it wasn't trained on.  The next line does this.  Happily, we see
-    // that the object detector works perfectly on the testing images.
-    cout << "testing results:  " << test_object_detection_function(detector, images_test, face_boxes_test) << endl;
-    
-    
-    // If you have read any papers that use HOG you have probably seen the nice looking
-    // "sticks" visualization of a learned HOG detector.  This next line creates a
-    // window with such a visualization of our detector.  It should look somewhat like
-    // a face.
-//    image_window hogwin(draw_fhog(detector), "Learned fHOG detector");
-    
-    ofxDLib::toOf(draw_fhog(detector),hogPix);
-    
-    // Now for the really fun part.  Let's display the testing images on the screen and
-    // show the output of the face detector overlaid on each image.  You will see that
-    // it finds all the faces without false alarming on any non-faces.
-    //    image_window win;
-    
-    
-    
-    
-    // Like everything in dlib, you can save your detector to disk using the
-    // serialize() function.
-    serialize("face_detector.svm") << detector;
-    
-    // Then you can recall it using the deserialize() function.
-    object_detector<image_scanner_type> detector2;
-    deserialize("face_detector.svm") >> detector2;
-    
-    
-    std::vector<object_detector<image_scanner_type> > my_detectors;
-    my_detectors.push_back(detector);
-    std::vector<rectangle> dets = evaluate_detectors(my_detectors, images_train[0]);
-    //
-    //
-    // Finally, you can add a nuclear norm regularizer to the SVM trainer.  Doing has
-    // two benefits.  First, it can cause the learned HOG detector to be composed of
-    // separable filters and therefore makes it execute faster when detecting objects.
-    // It can also help with generalization since it tends to make the learned HOG
-    // filters smoother.  To enable this option you call the following function before
-    // you create the trainer object:
-    //    scanner.set_nuclear_norm_regularization_strength(1.0);
-    // The argument determines how important it is to have a small nuclear norm.  A
-    // bigger regularization strength means it is more important.  The smaller the
-    // nuclear norm the smoother and faster the learned HOG filters will be, but if the
-    // regularization strength value is too large then the SVM will not fit the data
-    // well.  This is analogous to giving a C value that is too small.
-    //
-    // You can see how many separable filters are inside your detector like so:
-    cout << "num filters: "<< num_separable_filters(detector) << endl;
-    // You can also control how many filters there are by explicitly thresholding the
-    // singular values of the filters like this:
-    detector = threshold_filter_singular_values(detector,0.1);
-    // That removes filter components with singular values less than 0.1.  The bigger
-    // this number the fewer separable filters you will have and the faster the
-    // detector will run.  However, a large enough threshold will hurt detection
-    // accuracy.
-    
-    
-       nextTestImage(0);
-        nextTrainImage(0);
+    if (bCancel) throw TrainingCancelled();
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        bDatasetsLoaded = true;
+    }
 }
 
+void HOGtrainer::updatePyramidCache(const image_scanner_type& scanner){
+    std::map<string, std::unique_ptr<image_scanner_type> > cache;
+    std::vector<image_scanner_type*> added;
+    std::vector<unsigned long> addedIdx;
+    // the pyramids also depend on the upsampling and the scanner's settings, flipped images have
+    // their own names. A fresh copy serializes the settings without any loaded image
+    image_scanner_type config;
+    config.copy_configuration(scanner);
+    std::ostringstream key;
+    serialize(settings.bUpsample, key);
+    serialize(config, key);
+    if (key.str() != pyramidCacheKey) {
+        pyramidCache.clear();
+        pyramidCacheKey = key.str();
+    }
+    for (unsigned long i = 0; i < trainNames.size(); ++i) {
+        std::unique_ptr<image_scanner_type>& cached = pyramidCache[trainNames[i]];
+        if (!cached) {
+            cached.reset(new image_scanner_type());
+            added.push_back(cached.get());
+            addedIdx.push_back(i);
+        }
+        cache[trainNames[i]] = std::move(cached);
+    }
+    // images that were removed from the dataset drop out of the cache here
+    std::swap(cache, pyramidCache);
+    cout << "computing fHOG pyramids of " << added.size() << " new training images" << endl;
+    
+    dlib::parallel_for(settings.numThreads, 0, added.size(), [&](long i){
+        if (bCancel) return;
+        added[i]->copy_configuration(scanner);
+        added[i]->load(images_train[addedIdx[i]]);
+    });
+    if (bCancel) {
+        // don't keep pyramids that weren't computed
+        pyramidCache.clear();
+        throw TrainingCancelled();
+    }
+}
 
-void HOGtrainer::update(){
+matrix<double,1,3> HOGtrainer::evaluate(const object_detector<image_scanner_type>& detector, const ImageDataset& images, const std::vector<std::vector<rectangle> >& boxes, const std::vector<std::vector<rectangle> >& ignore, std::vector<std::vector<rectangle> >& detections, LatencyStats& latency){
+    const unsigned long num = images.size();
+    detections.assign(num, std::vector<rectangle>());
+    std::vector<std::vector<std::pair<double,bool> > > dets(num);
+    std::vector<unsigned long> hits(num), missing(num);
+    std::vector<float> times(num);
+    
+    // workers take the next image as they become free, the calling thread is one of them
+    std::atomic<unsigned long> next(0);
+    std::mutex errorMutex;
+    string error;
+    auto work = [&](){
+        try {
+            object_detector<image_scanner_type> copy = detector;
+            for (unsigned long i = next++; i < num && !bCancel; i = next++) {
+                ImageDataset::Image img = images[i];
+                std::vector<std::pair<double,rectangle> > found;
+                uint64_t t = ofGetElapsedTimeMicros();
+                copy(img, found);
+                times[i] = (ofGetElapsedTimeMicros() - t) / 1000.f;
+                
+                std::vector<full_object_detection> truth;
+                for (auto& box : boxes[i]) truth.push_back(full_object_detection(box));
+                hits[i] = impl::number_of_truth_hits(truth, ignore[i], found, test_box_overlap(), dets[i], missing[i]);
+                for (auto& d : found) detections[i].push_back(d.second);
+            }
+        } catch (std::exception& e) {
+            std::unique_lock<std::mutex> lock(errorMutex);
+            if (error.empty()) error = e.what();
+        }
+    };
+    uint64_t start = ofGetElapsedTimeMicros();
+    std::vector<std::thread> workers;
+    for (unsigned int i = 1; i < std::min<unsigned long>(settings.numThreads, num); ++i) {
+        workers.push_back(std::thread(work));
+    }
+    work();
+    for (auto& w : workers) {
+        w.join();
+    }
+    if (bCancel) throw TrainingCancelled();
+    if (!error.empty()) throw dlib::error(error);
+    
+    // pooled in image order, exactly like test_object_detection_function does it
+    double correctHits = 0, totalTargets = 0;
+    unsigned long missingDetections = 0;
+    std::vector<std::pair<double,bool> > allDets;
+    for (unsigned long i = 0; i < num; ++i) {
+        correctHits += hits[i];
+        totalTargets += boxes[i].size();
+        missingDetections += missing[i];
+        allDets.insert(allDets.end(), dets[i].begin(), dets[i].end());
+    }
+    std::sort(allDets.rbegin(), allDets.rend());
+    matrix<double,1,3> res;
+    res = allDets.size() == 0 ? 1 : correctHits / allDets.size(),
+          totalTargets == 0 ? 1 : correctHits / totalTargets,
+          average_precision(allDets, missingDetections);
+    
+    latency = LatencyStats();
+    latency.numImages = num;
+    latency.total = (ofGetElapsedTimeMicros() - start) / 1000000.f;
+    if (num > 0) {
+        std::sort(times.begin(), times.end());
+        for (float t : times) latency.mean += t / num;
+        latency.median = times[num/2];
+        latency.p90 = times[std::min(num-1, (unsigned long)(0.9*num))];
+        latency.p99 = times[std::min(num-1, (unsigned long)(0.99*num))];
+        latency.max = times.back();
+    }
+    return res;
+}
+
+void HOGtrainer::threadedFunction(string faces_directory, matrix<double,0,1> initialWeights){
+    try {
+        loadDatasets(faces_directory);
+        setState(TRAINER_TRAINING);
+    
+        image_scanner_type scanner;
+        // The sliding window detector will be 80 pixels wide and 80 pixels tall.
+        scanner.set_detection_window_size(80, 80);
+        structural_object_detection_trainer<image_scanner_type> trainer(scanner);
+        // Set this to the number of processing cores on your machine.
+        trainer.set_num_threads(settings.numThreads);
+        // The trainer is a kind of support vector machine and therefore has the usual SVM
+        // C parameter.  In general, a bigger C encourages it to fit the training data
+        // better but might lead to overfitting.  You must find the best C value
+        // empirically by checking how well the trained detector works on a test set of
+        // images you haven't trained on.  Don't just leave the value set at 1.  Try a few
+        // different C values and see what works best for your data.
+        trainer.set_c(1);
+        // We can tell the trainer to print it's progress to the console if we want.
+        trainer.be_verbose();
+        // getProgress() follows the iterations through an observer, which also stops the
+        // trainer once cancel() was called
+        TrainingObserver observer([this](double riskGap, unsigned long iteration){
+            return trainingStatus(riskGap, iteration);
+        });
+        trainer.set_status_observer(&observer);
+        // The trainer will run until the "risk gap" is less than 0.01.  Smaller values
+        // make the trainer solve the SVM optimization problem more accurately but will
+        // take longer to train.  For most problems a value in the range of 0.1 to 0.01 is
+        // plenty accurate.  Also, when in verbose mode the risk gap is printed on each
+        // iteration so you can see how close it is to finishing the training.
+        trainer.set_epsilon(0.01);
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            progress.epsilon = trainer.get_epsilon();
+            trainingStartTime = ofGetElapsedTimeMicros();
+            firstRiskGap = 0;
+        }
+    
+        // Now we run the trainer.  For this example, it should take on the order of 10
+        // seconds to train.
+        object_detector<image_scanner_type> trained;
+        if (initialWeights.size() == scanner.get_num_dimensions()+1) {
+            trainer.set_initial_weights(initialWeights);
+        }
+        if (settings.cacheSize > 0) {
+            // streaming: only cacheSize fHOG pyramids stay loaded, the trainer computes the others
+            // from the streamed images whenever it needs them
+            if (bCachePyramids) {
+                ofLogNotice("ofxDLib::HOGtrainer") << "not caching fHOG pyramids while streaming";
+                pyramidCache.clear();
+            }
+            trainer.set_scanner_cache_size(settings.cacheSize);
+            trained = trainer.train(images_train, face_boxes_train);
+        } else if (bCachePyramids) {
+            // the trainer loads its scanners from the cached ones instead of the images
+            updatePyramidCache(scanner);
+            PyramidArray pyramids;
+            for (auto& name : trainNames) {
+                pyramids.push_back(pyramidCache[name].get());
+            }
+            trained = trainer.train(pyramids, face_boxes_train);
+        } else {
+            trained = trainer.train(images_train, face_boxes_train); //,face_boxes_train_ignore);
+        }
+        if (bCancel) throw TrainingCancelled();
+        setState(TRAINER_TESTING);
+        // the app keeps the detector with its weak filter components removed (see below), so that
+        // is the one tested here and whose detections the previews show
+        object_detector<image_scanner_type> thresholded = threshold_filter_singular_values(trained,0.1);
+    
+        // Now that we have a face detector we can test it.  The first statement tests it
+        // on the training data.  It will print the precision, recall, and then average precision.
+        trainResults = evaluate(thresholded, images_train, face_boxes_train, std::vector<std::vector<rectangle> >(images_train.size()), trainDetections, trainLatency);
+        cout << "training results: " << trainResults << endl;
+        // However, to get an idea if it really worked without overfitting we need to run
+        // it on images it wasn't trained on.  The next line does this.  Happily, we see
+        // that the object detector works perfectly on the testing images.
+        testResults = evaluate(thresholded, images_test, face_boxes_test, std::vector<std::vector<rectangle> >(images_test.size()), testDetections, testLatency);
+        cout << "testing results:  " << testResults << endl;
+        cout << "detection ms/img: mean " << testLatency.mean << "  median " << testLatency.median << "  p90 " << testLatency.p90
+             << "  p99 " << testLatency.p99 << "  max " << testLatency.max << endl;
+        if (bCancel) throw TrainingCancelled();
+        setState(TRAINER_SAVING);
+    
+    
+        // If you have read any papers that use HOG you have probably seen the nice looking
+        // "sticks" visualization of a learned HOG detector.  This next line creates a
+        // window with such a visualization of our detector.  It should look somewhat like
+        // a face.
+    //    image_window hogwin(draw_fhog(detector), "Learned fHOG detector");
+        // update() draws it into hogPix once training is done
+    
+        // Now for the really fun part.  Let's display the testing images on the screen and
+        // show the output of the face detector overlaid on each image.  You will see that
+        // it finds all the faces without false alarming on any non-faces.
+        //    image_window win;
+    
+    
+    
+    
+        // Like everything in dlib, you can save your detector to disk using the
+        // serialize() function.
+        serialize("face_detector.svm") << trained;
+    
+        // Then you can recall it using the deserialize() function.
+        object_detector<image_scanner_type> detector2;
+        deserialize("face_detector.svm") >> detector2;
+    
+    
+        std::vector<object_detector<image_scanner_type> > my_detectors;
+        my_detectors.push_back(trained);
+        std::vector<rectangle> dets = evaluate_detectors(my_detectors, images_train[0]);
+        //
+        //
+        // Finally, you can add a nuclear norm regularizer to the SVM trainer.  Doing has
+        // two benefits.  First, it can cause the learned HOG detector to be composed of
+        // separable filters and therefore makes it execute faster when detecting objects.
+        // It can also help with generalization since it tends to make the learned HOG
+        // filters smoother.  To enable this option you call the following function before
+        // you create the trainer object:
+        //    scanner.set_nuclear_norm_regularization_strength(1.0);
+        // The argument determines how important it is to have a small nuclear norm.  A
+        // bigger regularization strength means it is more important.  The smaller the
+        // nuclear norm the smoother and faster the learned HOG filters will be, but if the
+        // regularization strength value is too large then the SVM will not fit the data
+        // well.  This is analogous to giving a C value that is too small.
+        //
+        // You can see how many separable filters are inside your detector like so:
+        cout << "num filters: "<< num_separable_filters(trained) << endl;
+        // You can also control how many filters there are by explicitly thresholding the
+        // singular values of the filters like thresholded above:
+        const matrix<double,0,1> rawWeights = trained.get_w();
+        trained = thresholded;
+        // That removes filter components with singular values less than 0.1.  The bigger
+        // this number the fewer separable filters you will have and the faster the
+        // detector will run.  However, a large enough threshold will hurt detection
+        // accuracy. setFilterTuning() measures that trade off for a range of thresholds.
+        if (!settings.filterThresholds.empty()) {
+            setState(TRAINER_TUNING);
+            tuneFilters(detector2);
+        }
+    
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            detector = trained;
+            trainedWeights = rawWeights;
+            thresholdedWeights = trained.get_w();
+            bDetectorTrained = true;
+        }
+        setState(TRAINER_DONE);
+    
+    } catch (TrainingCancelled&) {
+        setState(TRAINER_CANCELLED);
+    } catch (std::exception& e) {
+        ofLogError("ofxDLib::HOGtrainer") << e.what();
+        setState(TRAINER_FAILED);
+    }
+}
+
+void HOGtrainer::tuneFilters(const object_detector<image_scanner_type>& trained){
+    std::vector<FilterTuningResult> results;
+    for (double threshold : settings.filterThresholds) {
+        if (bCancel) throw TrainingCancelled();
+        FilterTuningResult r = FilterTuningResult();
+        r.threshold = threshold;
+        object_detector<image_scanner_type> thresholded = threshold_filter_singular_values(trained, threshold);
+        r.numFilters = num_separable_filters(thresholded);
+        
+        std::vector<std::vector<rectangle> > detections;
+        LatencyStats latency;
+        matrix<double,1,3> res = evaluate(thresholded, images_test, face_boxes_test, std::vector<std::vector<rectangle> >(images_test.size()), detections, latency);
+        r.precision = res(0);
+        r.recall = res(1);
+        r.averagePrecision = res(2);
+        
+        // best of a few passes over the held out images, to keep other load out of the timing
+        // only the detector is timed, fetching a streamed image first can mean decoding it
+        for (unsigned int pass = 0; pass < settings.timingPasses; ++pass) {
+            float time = 0;
+            for (unsigned long i = 0; i < images_test.size(); ++i) {
+                ImageDataset::Image img = images_test[i];
+                uint64_t t = ofGetElapsedTimeMicros();
+                thresholded(img);
+                time += (ofGetElapsedTimeMicros() - t) / 1000.f;
+            }
+            time /= std::max<size_t>(1, images_test.size());
+            if (pass == 0 || time < r.detectionTime) r.detectionTime = time;
+        }
+        results.push_back(r);
+    }
+    
+    // fastest first, a detector is on the front if it is more accurate than every faster one
+    std::vector<unsigned long> order(results.size());
+    for (unsigned long i = 0; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](unsigned long a, unsigned long b){
+        return results[a].detectionTime < results[b].detectionTime;
+    });
+    double bestAveragePrecision = -1;
+    for (unsigned long i : order) {
+        FilterTuningResult& r = results[i];
+        r.bPareto = r.averagePrecision > bestAveragePrecision;
+        if (r.bPareto) {
+            bestAveragePrecision = r.averagePrecision;
+            r.path = "face_detector_pareto_" + ofToString(r.threshold) + ".svm";
+            serialize(r.path) << threshold_filter_singular_values(trained, r.threshold);
+        }
+    }
+    
+    std::ostringstream table;
+    table << " threshold   filters  precision    recall        AP   detect ms/img  pareto" << endl;
+    for (auto& r : results) {
+        table << std::setw(10) << r.threshold << std::setw(10) << r.numFilters << std::setw(11) << r.precision
+              << std::setw(10) << r.recall << std::setw(10) << r.averagePrecision << std::setw(16) << r.detectionTime
+              << (r.bPareto ? "  " + r.path : string()) << endl;
+    }
+    cout << table.str();
     
+    std::unique_lock<std::mutex> lock(mutex);
+    filterTuningResults = results;
+}
+
+void HOGtrainer::threadedSweep(string faces_directory, std::vector<double> cs, std::vector<double> epsilons, std::vector<double> nuclearNorms, unsigned int numFolds){
+    try {
+        loadDatasets(faces_directory);
+        
+        image_scanner_type scanner;
+        scanner.set_detection_window_size(80, 80);
+        
+        std::vector<SweepResult> results;
+        for (double c : cs) {
+            for (double epsilon : epsilons) {
+                for (double nuclearNorm : nuclearNorms) {
+                    SweepResult r = SweepResult();
+                    r.c = c;
+                    r.epsilon = epsilon;
+                    r.nuclearNorm = nuclearNorm;
+                    results.push_back(r);
+                }
+            }
+        }
+        
+        // folds are split like cross_validate_object_detection_trainer does, but over the original
+        // images. A flip at numOriginals+i goes into the fold of image i, otherwise the held out
+        // images would be tested with their mirror images in the training set
+        const unsigned long num = images_train.size();
+        const unsigned long numOriginals = settings.bFlip ? num/2 : num;
+        if (numFolds < 2 || numFolds > numOriginals) {
+            throw dlib::error("sweep() needs at least 2 folds and no more than the " + ofToString(numOriginals) + " training images, got " + ofToString(numFolds));
+        }
+        const unsigned long testSize = numOriginals / numFolds;
+        
+        // what every configuration and fold adds to the pooled precision, recall and average precision
+        struct Run {
+            object_detector<image_scanner_type> detector;
+            std::vector<unsigned long> testIdx;
+            double correctHits, totalTargets;
+            unsigned long missingDetections;
+            std::vector<std::pair<double,bool> > dets;
+            float trainingTime, detectionTime;
+        };
+        std::vector<Run> runs(results.size() * numFolds);
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            progress.state = TRAINER_SWEEPING;
+            progress.sweepRuns = runs.size();
+        }
+        
+        // every run trains on the same images, so each fHOG pyramid is computed only once. The
+        // runs' scanners copy them from here with scan_fhog_pyramid::load(scanner). While
+        // streaming the runs compute them from the images instead, and the runs in parallel
+        // share the cacheSize loaded pyramids
+        const bool bStreaming = settings.cacheSize > 0;
+        const unsigned long runCacheSize = std::max(1ul, settings.cacheSize / std::min<unsigned long>(settings.numThreads, runs.size()));
+        dlib::array<image_scanner_type> pyramids;
+        if (!bStreaming) {
+            pyramids.set_max_size(num);
+            pyramids.set_size(num);
+            dlib::parallel_for(settings.numThreads, 0, num, [&](long i){
+                if (bCancel) return;
+                pyramids[i].copy_configuration(scanner);
+                pyramids[i].load(images_train[i]);
+            });
+        }
+        if (bCancel) throw TrainingCancelled();
+        uint64_t sweepStartTime = ofGetElapsedTimeMicros();
+        
+        // configurations and folds all run in parallel, so each trainer gets a single thread
+        TrainingObserver observer([this](double, unsigned long){
+            return (bool)bCancel;
+        });
+        std::mutex errorMutex;
+        string error;
+        dlib::parallel_for(settings.numThreads, 0, runs.size(), [&](long i){
+            if (bCancel) return;
+            try {
+                const SweepResult& config = results[i / numFolds];
+                const unsigned long fold = i % numFolds;
+                Run& run = runs[i];
+                
+                image_scanner_type runScanner;
+                runScanner.copy_configuration(scanner);
+                runScanner.set_nuclear_norm_regularization_strength(config.nuclearNorm);
+                structural_object_detection_trainer<image_scanner_type> trainer(runScanner);
+                trainer.set_num_threads(1);
+                trainer.set_c(config.c);
+                trainer.set_epsilon(config.epsilon);
+                trainer.set_status_observer(&observer);
+                
+                std::vector<unsigned long> trainIdx;
+                std::vector<std::vector<rectangle> > trainBoxes, trainIgnore;
+                for (unsigned long j = 0; j < num; ++j) {
+                    const unsigned long original = j % numOriginals;
+                    if (original >= fold*testSize && original < (fold+1)*testSize) {
+                        run.testIdx.push_back(j);
+                    } else {
+                        trainIdx.push_back(j);
+                        trainBoxes.push_back(face_boxes_train[j]);
+                        trainIgnore.push_back(face_boxes_train_ignore[j]);
+                    }
+                }
+                
+                uint64_t t = ofGetElapsedTimeMicros();
+                if (bStreaming) {
+                    trainer.set_scanner_cache_size(runCacheSize);
+                    run.detector = trainer.train(ArraySubset<ImageDataset>(images_train, trainIdx), trainBoxes, trainIgnore);
+                } else {
+                    run.detector = trainer.train(impl::array_subset_helper<dlib::array<image_scanner_type> >(pyramids, trainIdx), trainBoxes, trainIgnore);
+                }
+                run.trainingTime = (ofGetElapsedTimeMicros() - t) / 1000000.f;
+            } catch (std::exception& e) {
+                std::unique_lock<std::mutex> lock(errorMutex);
+                if (error.empty()) error = e.what();
+            }
+            
+            std::unique_lock<std::mutex> lock(mutex);
+            progress.sweepRunsDone++;
+            float elapsed = (ofGetElapsedTimeMicros() - sweepStartTime) / 1000000.f;
+            progress.eta = elapsed / progress.sweepRunsDone * (progress.sweepRuns - progress.sweepRunsDone);
+        });
+        if (bCancel) throw TrainingCancelled();
+        if (!error.empty()) throw dlib::error(error);
+        
+        // the held out images go through the whole detector, fHOG pyramid included, to time it.
+        // One run at a time once training is done, so the timings don't depend on what else ran.
+        // Images are fetched before the clock starts, decoding a streamed one isn't detection
+        for (Run& run : runs) {
+            if (bCancel) throw TrainingCancelled();
+            run.correctHits = run.totalTargets = 0;
+            run.missingDetections = 0;
+            run.detectionTime = 0;
+            for (unsigned long j : run.testIdx) {
+                ImageDataset::Image img = images_train[j];
+                std::vector<std::pair<double,rectangle> > hits;
+                uint64_t t = ofGetElapsedTimeMicros();
+                run.detector(img, hits);
+                run.detectionTime += (ofGetElapsedTimeMicros() - t) / 1000.f;
+                std::vector<full_object_detection> truth;
+                for (auto& box : face_boxes_train[j]) truth.push_back(full_object_detection(box));
+                run.correctHits += impl::number_of_truth_hits(truth, face_boxes_train_ignore[j], hits, test_box_overlap(), run.dets, run.missingDetections);
+                run.totalTargets += truth.size();
+            }
+            run.detectionTime /= std::max<size_t>(1, run.testIdx.size());
+        }
+        
+        // pool the folds like cross_validate_object_detection_trainer
+        std::ostringstream table;
+        table << "         C   epsilon   nuclear  precision    recall        AP   train s/fold   detect ms/img" << endl;
+        for (unsigned long i = 0; i < results.size(); ++i) {
+            SweepResult& r = results[i];
+            double correctHits = 0, totalTargets = 0;
+            unsigned long missingDetections = 0;
+            std::vector<std::pair<double,bool> > dets;
+            for (unsigned long fold = 0; fold < numFolds; ++fold) {
+                const Run& run = runs[i*numFolds + fold];
+                correctHits += run.correctHits;
+                totalTargets += run.totalTargets;
+                missingDetections += run.missingDetections;
+                dets.insert(dets.end(), run.dets.begin(), run.dets.end());
+                r.trainingTime += run.trainingTime / numFolds;
+                r.detectionTime += run.detectionTime / numFolds;
+            }
+            std::sort(dets.rbegin(), dets.rend());
+            r.precision = dets.size() == 0 ? 1 : correctHits / dets.size();
+            r.recall = totalTargets == 0 ? 1 : correctHits / totalTargets;
+            r.averagePrecision = average_precision(dets, missingDetections);
+            
+            table << std::setw(10) << r.c << std::setw(10) << r.epsilon << std::setw(10) << r.nuclearNorm
+                  << std::setw(11) << r.precision << std::setw(10) << r.recall << std::setw(10) << r.averagePrecision
+                  << std::setw(15) << r.trainingTime << std::setw(16) << r.detectionTime << endl;
+        }
+        cout << table.str();
+        
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            sweepResults = results;
+        }
+        setState(TRAINER_DONE);
+        
+    } catch (TrainingCancelled&) {
+        setState(TRAINER_CANCELLED);
+    } catch (std::exception& e) {
+        ofLogError("ofxDLib::HOGtrainer") << e.what();
+        setState(TRAINER_FAILED);
+    }
+}
+
+void HOGtrainer::update(){
+    bool bLoaded, bTrained;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        bLoaded = bDatasetsLoaded;
+        bTrained = bDetectorTrained;
+    }
+    // after loading the training thread only reads the datasets, still evaluating and tuning
+    // with their images while the previews show them. That's safe because ImageDataset locks
+    // its cache, and the boxes and names don't change anymore. The detector isn't touched
+    // after training, so the previews can use both from here on
+    if (bLoaded && !bShowDatasets) {
+        bShowDatasets = true;
+        nextTestImage(0);
+        nextTrainImage(0);
+    }
+    if (bTrained && !bShowDetections) {
+        bShowDetections = true;
+        ofxDLib::toOf(draw_fhog(detector),hogPix);
+        curTestImage = 0;
+        curTrainImage = 0;
+        nextTestImage(0);
+        nextTrainImage(0);
+    }
 }
 
 
@@ -187,7 +899,7 @@ void HOGtrainer::drawTrain(){
 
 void HOGtrainer::draw(){
     
-    
+    if (bShowDatasets) {
     drawTest();
     ofDrawBitmapStringHighlight("test data", 10,20);
     
@@ -197,29 +909,46 @@ void HOGtrainer::draw(){
     drawTrain();
     ofDrawBitmapStringHighlight("training data", 10,20);
     ofPopMatrix();
+    }
     
+    if (bShowDetections) {
     ofImage HOGimg;
     HOGimg.setFromPixels(hogPix);
     HOGimg.draw(0,600);
+    }
     
+    TrainerProgress p = getProgress();
+    static const char* states[] = {"idle", "loading datasets", "training", "sweeping", "testing", "tuning filters", "saving", "done", "cancelled", "failed"};
+    string status = string(states[p.state]) + " " + ofToString(p.elapsed, 0) + "s";
+    if (p.state == TRAINER_TRAINING) {
+        status += "  iteration " + ofToString(p.iteration) + "  risk gap " + ofToString(p.riskGap, 4) + " / " + ofToString(p.epsilon, 4);
+        status += "  eta " + (p.eta < 0 ? string("?") : ofToString(p.eta, 0) + "s");
+    }
+    if (p.state == TRAINER_SWEEPING) {
+        status += "  runs " + ofToString(p.sweepRunsDone) + " / " + ofToString(p.sweepRuns);
+        status += "  eta " + (p.eta < 0 ? string("?") : ofToString(p.eta, 0) + "s");
+    }
+    ofDrawBitmapStringHighlight(status, 10, ofGetHeight()-10);
     
 }
 
 void HOGtrainer::nextTestImage(int i){
     
+    if (!bShowDatasets || images_test.size() == 0) return;
     i = curTestImage;
     
     ofLog()<<"nextTestImage "<<curTestImage;
     
-    // Run the detector and get the face detections.
-    std::vector<rectangle> dets = detector(images_test[i]);
+    // the detector's detections were cached when it was tested
+    std::vector<rectangle> dets;
+    if (bShowDetections) dets = testDetections[i];
     
     testRects.clear();
     for(int i=0; i<dets.size(); i++){
         testRects.push_back(ofxDLib::toOf(dets[i]));
     }
     
-    ofxDLib::toOf(images_test[curTestImage],testPix);
+    ofxDLib::toOf(*images_test[curTestImage],testPix);
     
     
     curTestImage++;
@@ -229,19 +958,21 @@ void HOGtrainer::nextTestImage(int i){
 
 void HOGtrainer::nextTrainImage(int i){
     
+    if (!bShowDatasets || images_train.size() == 0) return;
     i = curTrainImage;
     
     ofLog()<<"nextTestImage "<<curTestImage;
     
-    // Run the detector and get the face detections.
-    std::vector<rectangle> dets = detector(images_train[i]);
+    // the detector's detections were cached when it was tested
+    std::vector<rectangle> dets;
+    if (bShowDetections) dets = trainDetections[i];
     
     trainRects.clear();
     for(int i=0; i<dets.size(); i++){
         trainRects.push_back(ofxDLib::toOf(dets[i]));
     }
     
-    ofxDLib::toOf(images_train[curTrainImage],trainPix);
+    ofxDLib::toOf(*images_train[curTrainImage],trainPix);
     
     
     curTrainImage++;
@@ -13,6 +13,7 @@
 #pragma once
 
 #include "ofxDLib.h"
+#include "ImageDataset.h"
 
 #include <dlib/svm_threaded.h>
 #include <dlib/gui_widgets.h>
@@ -24,6 +25,13 @@
 
 #include <stdio.h>
 #include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <memory>
 
 
 
@@ -31,13 +39,112 @@ using namespace dlib;
 
 namespace ofxDLib{
     
+    enum TrainerState {
+        TRAINER_IDLE,
+        TRAINER_LOADING,
+        TRAINER_TRAINING,
+        TRAINER_SWEEPING,
+        TRAINER_TESTING,
+        TRAINER_TUNING,
+        TRAINER_SAVING,
+        TRAINER_DONE,
+        TRAINER_CANCELLED,
+        TRAINER_FAILED
+    };
+    
+    typedef struct {
+        TrainerState state;
+        // reported by the trainer's structural_svm_status_observer after every iteration
+        unsigned long iteration;
+        float riskGap;
+        float epsilon;
+        float elapsed;  // seconds since setup()
+        float eta;      // seconds until the risk gap reaches epsilon, or the sweep is done. -1 while unknown
+        unsigned int sweepRuns, sweepRunsDone;
+    } TrainerProgress;
+    
+    typedef struct {
+        double c, epsilon, nuclearNorm;
+        // pooled over all cross validation folds
+        double precision, recall, averagePrecision;
+        float trainingTime;   // seconds per fold
+        float detectionTime;  // ms per image, including the fHOG pyramid
+    } SweepResult;
+    
+    typedef struct {
+        double threshold;
+        unsigned long numFilters;
+        // on the testing images
+        double precision, recall, averagePrecision;
+        float detectionTime;  // ms per image
+        // no other threshold gives a faster detector with at least the same average precision
+        bool bPareto;
+        // where the detector was saved, only for the Pareto front
+        string path;
+    } FilterTuningResult;
+    
+    typedef struct {
+        unsigned long numImages;
+        // detection time per image in ms, including the fHOG pyramid
+        float mean, median, p90, p99, max;
+        // s for the whole dataset on all threads
+        float total;
+    } LatencyStats;
+    
     class HOGtrainer {
     public:
         
         HOGtrainer();
         virtual ~HOGtrainer();
         
+        // loads the datasets and trains the detector on a background thread, returns immediately
         void setup(string _trainDir);
+        // like setup(), but the optimiser starts from the current detector's weights, as they were
+        // before the last training thresholded its filters, and fHOG pyramids are only computed for
+        // training images that weren't in the previous run or whose augmentation or scanner settings
+        // changed. For quick updates after a few images were added to training.xml. Without a
+        // detector (from setup() or deserialized into detector) training starts from scratch
+        void retrain(string _trainDir);
+        // keeps the training images' fHOG pyramids between runs for retrain(), retrain() turns it on.
+        // Costs about as much memory again as the training itself, so it's off while streaming
+        void setPyramidCaching(bool bCache);
+        // instead of training one detector, cross validates every combination of the values on the
+        // training set with numFolds folds, which must be between 2 and the number of training images
+        // or the sweep fails. Flips stay in the fold of their original image. Detection is timed one
+        // run at a time after all of them are trained.
+        // Results are printed as a table and available from getSweepResults() once done
+        void sweep(string _trainDir, const std::vector<double>& cs, const std::vector<double>& epsilons, const std::vector<double>& nuclearNorms = std::vector<double>(1, 0), unsigned int numFolds = 3);
+        std::vector<SweepResult> getSweepResults();
+        // after training, thresholds the detector's filter singular values with each value, times the
+        // results on the testing images and saves the speed / average precision Pareto front as
+        // face_detector_pareto_<threshold>.svm. Empty (the default) keeps the single threshold of 0.1
+        void setFilterTuning(const std::vector<double>& thresholds, unsigned int timingPasses = 3);
+        std::vector<FilterTuningResult> getFilterTuningResults();
+        // the fastest Pareto detector with at least minAveragePrecision, numFilters is 0 if there is none
+        FilterTuningResult getFastestDetector(double minAveragePrecision);
+        // the settings below and setFilterTuning() apply to the next setup(), retrain() or sweep(),
+        // a running job keeps the values it started with
+        // used for loading and training
+        void setNumThreads(unsigned int numThreads);
+        // upsample both datasets and add left right flips of the training images while loading
+        void setAugmentation(bool bUpsample = true, bool bFlip = true);
+        // streams the datasets from disk for datasets that don't fit in memory once upsampled and
+        // flipped. At most cacheSize decoded images of each dataset and cacheSize fHOG pyramids of
+        // the trainer stay in memory, prefetch images ahead of the ones in use are decoded in the
+        // background. The trainer computes the other pyramids from the images again in every
+        // iteration, so training gets slower the smaller the cache. Loading still decodes every
+        // image once, one at a time per thread, to check it and size the boxes of its flip. What
+        // still grows with the dataset are the boxes and the solver's per image cache (see
+        // structural_object_detection_trainer::set_max_cache_size()). setPyramidCaching() has no
+        // effect while streaming. 0 (the default) keeps every image and pyramid in memory
+        void setStreaming(unsigned long cacheSize, unsigned long prefetch = 16);
+        // cancels at the next trainer iteration, or between loading, training and testing
+        void cancel();
+        void waitForTraining();
+        bool isTraining();
+        TrainerProgress getProgress();
+        
+        // picks up loaded datasets and the finished detector for the previews, call from the app's update
         void update();
         void draw();
         
@@ -50,7 +157,7 @@ namespace ofxDLib{
         int curTestImage;
         int curTrainImage;
         
-        dlib::array<array2d<unsigned char> > images_train, images_test;
+        ImageDataset images_train, images_test;
         std::vector<std::vector<rectangle> > face_boxes_train, face_boxes_test,face_boxes_train_ignore;
         
         typedef scan_fhog_pyramid<pyramid_down<6> > image_scanner_type;
@@ -64,5 +171,66 @@ namespace ofxDLib{
         std::vector<ofRectangle> testRects;
         std::vector<ofRectangle> trainRects;
         
+        // precision, recall and average precision of detector, valid once training is done
+        matrix<double,1,3> trainResults, testResults;
+        LatencyStats trainLatency, testLatency;
+        
+    protected:
+        // stops a running job and resets the progress for a new one
+        void start();
+        void threadedFunction(string trainDir, matrix<double,0,1> initialWeights);
+        void threadedSweep(string trainDir, std::vector<double> cs, std::vector<double> epsilons, std::vector<double> nuclearNorms, unsigned int numFolds);
+        void loadDatasets(const string& trainDir);
+        // loads the training images into the pyramid cache, unless they are cached already
+        void updatePyramidCache(const image_scanner_type& scanner);
+        void tuneFilters(const object_detector<image_scanner_type>& trained);
+        // runs detector over images on numThreads workers, each with its own copy of it. Returns
+        // precision, recall and average precision like test_object_detection_function, and every
+        // image's detections
+        matrix<double,1,3> evaluate(const object_detector<image_scanner_type>& detector, const ImageDataset& images, const std::vector<std::vector<rectangle> >& boxes, const std::vector<std::vector<rectangle> >& ignore, std::vector<std::vector<rectangle> >& detections, LatencyStats& latency);
+        // sets images up for an imglab xml file and decodes every image once on numThreads workers,
+        // to check it and size the boxes of its flip. As many as fit stay in images' cache. Flipped
+        // copies follow all originals, like add_image_left_right_flips appends them. names identifies
+        // every image across runs. Returns the ignored boxes, like load_image_dataset
+        std::vector<std::vector<rectangle> > loadDataset(const string& xml, ImageDataset& images, std::vector<std::vector<rectangle> >& boxes, std::vector<string>& names, bool bUpsample, bool bFlip);
+        void setState(TrainerState state);
+        // called by the trainer after every iteration, returns true to stop it once cancel() was called
+        bool trainingStatus(double riskGap, unsigned long iteration);
+        
+        // what the setters configure. They change pending under the mutex, start() hands a copy
+        // to the job in settings, which only the job reads
+        struct Settings {
+            unsigned int numThreads;
+            bool bUpsample, bFlip;
+            unsigned long cacheSize, prefetch;
+            std::vector<double> filterThresholds;
+            unsigned int timingPasses;
+        };
+        Settings pending, settings;
+        
+        std::vector<string> trainNames, testNames;
+        // detector's detections from evaluate(), the previews show these instead of detecting again
+        std::vector<std::vector<rectangle> > trainDetections, testDetections;
+        bool bCachePyramids;
+        // loaded scanners by image name, only touched by the training thread. They were computed
+        // with the upsampling and scanner settings serialized in pyramidCacheKey
+        std::map<string, std::unique_ptr<image_scanner_type> > pyramidCache;
+        string pyramidCacheKey;
+        // the last training's weights before and after thresholding its filters, retrain() starts
+        // from the former while detector still has the latter
+        matrix<double,0,1> trainedWeights, thresholdedWeights;
+        
+        std::thread thread;
+        std::mutex mutex;
+        std::atomic<bool> bCancel;
+        TrainerProgress progress;
+        uint64_t startTime, trainingStartTime;
+        float firstRiskGap, firstRiskGapTime;
+        std::vector<SweepResult> sweepResults;
+        std::vector<FilterTuningResult> filterTuningResults;
+        // set by the training thread, picked up by update()
+        bool bDatasetsLoaded, bDetectorTrained;
+        // owned by the app thread, the previews only touch datasets and detector once these are set
+        bool bShowDatasets, bShowDetections;
     };
 }
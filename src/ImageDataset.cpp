@@ -0,0 +1,231 @@
+//
+//  ImageDataset.cpp
+//  ofxDLib
+//
+
+#include "ImageDataset.h"
+using namespace ofxDLib;
+//--------------------------------------------------------------
+ImageDataset::ImageDataset(){
+    bUpsample = bFlip = false;
+    cacheSize = 0;
+    prefetch = 0;
+    bStop = false;
+}
+
+//--------------------------------------------------------------
+ImageDataset::~ImageDataset(){
+    stopPrefetching();
+}
+
+//--------------------------------------------------------------
+void ImageDataset::setCacheSize(unsigned long numImages){
+    std::unique_lock<std::mutex> lock(mutex);
+    cacheSize = numImages;
+    while (cacheSize > 0 && lru.size() > cacheSize) {
+        cache[lru.back()].reset();
+        lru.pop_back();
+    }
+}
+
+//--------------------------------------------------------------
+void ImageDataset::setPrefetch(unsigned long numImages){
+    prefetch = numImages;
+}
+
+//--------------------------------------------------------------
+void ImageDataset::setup(const std::vector<string>& paths, bool bUpsample, bool bFlip){
+    clear();
+    this->paths = paths;
+    this->bUpsample = bUpsample;
+    this->bFlip = bFlip;
+
+    const unsigned long total = size();
+    cache.resize(total);
+    lruPos.resize(total);
+    decoding.assign(total, false);
+    queued.assign(total, false);
+
+    if (prefetch > 0) {
+        bStop = false;
+        thread = std::thread(&ImageDataset::threadedFunction, this);
+    }
+}
+
+//--------------------------------------------------------------
+void ImageDataset::clear(){
+    stopPrefetching();
+    std::unique_lock<std::mutex> lock(mutex);
+    paths.clear();
+    cache.clear();
+    lru.clear();
+    lruPos.clear();
+    decoding.clear();
+    queued.clear();
+    queue.clear();
+}
+
+//--------------------------------------------------------------
+void ImageDataset::stopPrefetching(){
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        bStop = true;
+    }
+    prefetchRequested.notify_all();
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+//--------------------------------------------------------------
+unsigned long ImageDataset::size() const{
+    return bFlip ? 2*paths.size() : paths.size();
+}
+
+//--------------------------------------------------------------
+string ImageDataset::getName(unsigned long i) const{
+    return i < paths.size() ? paths[i] : paths[i - paths.size()] + " (flipped)";
+}
+
+//--------------------------------------------------------------
+unsigned long ImageDataset::getNumCached() const{
+    std::unique_lock<std::mutex> lock(mutex);
+    return lru.size();
+}
+
+//--------------------------------------------------------------
+ImageDataset::Image ImageDataset::operator[](unsigned long i) const{
+    Image img = get(i);
+    if (prefetch > 0) {
+        prefetchAfter(i);
+    }
+    return img;
+}
+
+//--------------------------------------------------------------
+void ImageDataset::decode(unsigned long i, image_type& img) const{
+    const unsigned long num = paths.size();
+    if (i >= num) {
+        // flip the original, from the cache if it's there
+        std::shared_ptr<const image_type> original;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            original = cache[i - num];
+        }
+        if (original) {
+            dlib::flip_image_left_right(*original, img);
+        } else {
+            image_type decoded;
+            decode(i - num, decoded);
+            dlib::flip_image_left_right(decoded, img);
+        }
+        return;
+    }
+
+    if (bUpsample) {
+        image_type decoded;
+        dlib::load_image(decoded, paths[i]);
+        dlib::pyramid_down<2> pyr;
+        dlib::pyramid_up(decoded, img, pyr);
+    } else {
+        dlib::load_image(img, paths[i]);
+    }
+}
+
+//--------------------------------------------------------------
+void ImageDataset::store(unsigned long i, image_type& img){
+    std::unique_lock<std::mutex> lock(mutex);
+    if (cache[i] || (cacheSize > 0 && lru.size() >= cacheSize)) return;
+    std::shared_ptr<image_type> stored(new image_type);
+    stored->swap(img);
+    insert(i, stored);
+}
+
+//--------------------------------------------------------------
+ImageDataset::Image ImageDataset::get(unsigned long i) const{
+    std::unique_lock<std::mutex> lock(mutex);
+    // another thread may be decoding it already, or drop it again before we wake up
+    while (!cache[i] && decoding[i]) {
+        decoded.wait(lock);
+    }
+    if (cache[i]) {
+        lru.splice(lru.begin(), lru, lruPos[i]);
+        return Image(cache[i]);
+    }
+    decoding[i] = true;
+    lock.unlock();
+
+    std::shared_ptr<image_type> img(new image_type);
+    try {
+        decode(i, *img);
+    } catch (std::exception& e) {
+        // this usually runs on a trainer's worker thread, which can't pass exceptions on. The
+        // image reads as empty, but stays uncached so the next access tries again
+        ofLogError("ofxDLib::ImageDataset") << "couldn't load " << getName(i) << ": " << e.what();
+        lock.lock();
+        decoding[i] = false;
+        decoded.notify_all();
+        return Image(img);
+    }
+
+    lock.lock();
+    decoding[i] = false;
+    insert(i, img);
+    decoded.notify_all();
+    return Image(img);
+}
+
+//--------------------------------------------------------------
+void ImageDataset::insert(unsigned long i, const std::shared_ptr<const image_type>& img) const{
+    // store() can cache an image while get() is decoding it
+    if (cache[i]) {
+        cache[i] = img;
+        lru.splice(lru.begin(), lru, lruPos[i]);
+        return;
+    }
+    cache[i] = img;
+    lru.push_front(i);
+    lruPos[i] = lru.begin();
+    while (cacheSize > 0 && lru.size() > cacheSize) {
+        cache[lru.back()].reset();
+        lru.pop_back();
+    }
+}
+
+//--------------------------------------------------------------
+void ImageDataset::prefetchAfter(unsigned long i) const{
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (unsigned long j = i+1; j <= i+prefetch && j < cache.size(); ++j) {
+            if (!cache[j] && !decoding[j] && !queued[j]) {
+                queued[j] = true;
+                queue.push_back(j);
+            }
+        }
+        // readers that jumped elsewhere don't need their old requests anymore
+        while (queue.size() > 4*prefetch) {
+            queued[queue.front()] = false;
+            queue.pop_front();
+        }
+    }
+    prefetchRequested.notify_one();
+}
+
+//--------------------------------------------------------------
+void ImageDataset::threadedFunction(){
+    while (true) {
+        unsigned long i;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!bStop && queue.empty()) {
+                prefetchRequested.wait(lock);
+            }
+            if (bStop) return;
+            i = queue.front();
+            queue.pop_front();
+            queued[i] = false;
+            if (cache[i] || decoding[i]) continue;
+        }
+        get(i);
+    }
+}
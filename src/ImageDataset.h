@@ -0,0 +1,119 @@
+//
+//  ImageDataset.h
+//  ofxDLib
+//
+//  grayscale training images that are decoded from disk on demand instead of
+//  being held in memory all at once. Decoded (and upsampled or flipped) images
+//  go into an LRU cache of a fixed number of images and a background thread
+//  decodes the images after the last one accessed ahead of time. Works as the
+//  image array of dlib's trainers and test_object_detection_function. To bound
+//  the trainer's fHOG pyramids as well, see
+//  structural_object_detection_trainer::set_scanner_cache_size().
+//
+
+#pragma once
+#include "ofxDLib.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <memory>
+
+namespace ofxDLib {
+
+    class ImageDataset {
+    public:
+        typedef dlib::array2d<unsigned char> image_type;
+
+        // a decoded image, stays valid while it is held even if the cache drops it. Implements
+        // dlib's generic image interface (read only), so it goes straight into scanners and detectors
+        class Image {
+        public:
+            Image() {}
+            Image(const std::shared_ptr<const image_type>& img) : img(img) {}
+            const image_type& operator*() const { return *img; }
+            const image_type* operator->() const { return img.get(); }
+
+            std::shared_ptr<const image_type> img;
+        };
+
+        // what dlib expects from an image array
+        typedef Image type;
+        typedef dlib::default_memory_manager mem_manager_type;
+
+        ImageDataset();
+        virtual ~ImageDataset();
+
+        // decoded images kept in memory, the least recently used ones are dropped first. 0 (the
+        // default) keeps every image once it was decoded. Images that are in use don't count
+        void setCacheSize(unsigned long numImages);
+        // how many images after the one last accessed are decoded ahead on a background thread,
+        // 0 disables prefetching. Keep it well below the cache size divided by the number of
+        // threads reading from the dataset, or prefetched images are dropped before they are used.
+        // Call before setup()
+        void setPrefetch(unsigned long numImages);
+
+        // paths of the images on disk, bUpsample doubles their size with pyramid_up and with bFlip
+        // their left right flips follow all originals, like add_image_left_right_flips appends them
+        void setup(const std::vector<string>& paths, bool bUpsample, bool bFlip);
+        void clear();
+
+        unsigned long size() const;
+        // decodes image i unless it is cached, safe to call from several threads
+        Image operator[](unsigned long i) const;
+        // path of image i, with " (flipped)" appended for flips
+        string getName(unsigned long i) const;
+        unsigned long getNumCached() const;
+
+        // decodes image i into img without going through the cache, throws if it can't be read
+        void decode(unsigned long i, image_type& img) const;
+        // hands an image that was decoded elsewhere to the cache, img is swapped out. Does nothing
+        // when the cache is full, so filling the cache never drops other images
+        void store(unsigned long i, image_type& img);
+
+    protected:
+        Image get(unsigned long i) const;
+        // with the mutex held. Replaces an image that is cached already, so it is never in lru twice
+        void insert(unsigned long i, const std::shared_ptr<const image_type>& img) const;
+        void prefetchAfter(unsigned long i) const;
+        void threadedFunction();
+        void stopPrefetching();
+
+        std::vector<string> paths;
+        bool bUpsample, bFlip;
+        unsigned long cacheSize, prefetch;
+
+        // everything below is shared with the prefetch thread and guarded by mutex
+        mutable std::mutex mutex;
+        mutable std::condition_variable decoded, prefetchRequested;
+        mutable std::vector<std::shared_ptr<const image_type> > cache;
+        // most recently used first
+        mutable std::list<unsigned long> lru;
+        mutable std::vector<std::list<unsigned long>::iterator> lruPos;
+        mutable std::vector<bool> decoding, queued;
+        mutable std::deque<unsigned long> queue;
+        bool bStop;
+        std::thread thread;
+    };
+
+    // the rest of dlib's generic image interface for ImageDataset::Image
+    inline long num_rows(const ImageDataset::Image& img) { return img.img ? img->nr() : 0; }
+    inline long num_columns(const ImageDataset::Image& img) { return img.img ? img->nc() : 0; }
+    inline const void* image_data(const ImageDataset::Image& img) { return img.img ? dlib::image_data(*img) : 0; }
+    inline long width_step(const ImageDataset::Image& img) { return img.img ? dlib::width_step(*img) : 0; }
+
+    // dlib's input checks only look at the size of mat(images), don't read elements through it
+    inline const dlib::matrix_op<dlib::op_array_to_mat<ImageDataset> > mat(const ImageDataset& images) {
+        typedef dlib::op_array_to_mat<ImageDataset> op;
+        return dlib::matrix_op<op>(op(images));
+    }
+}
+
+namespace dlib {
+    template <>
+    struct image_traits<ofxDLib::ImageDataset::Image> {
+        typedef unsigned char pixel_type;
+    };
+}
@@ -0,0 +1,242 @@
+//
+//  MultiStreamTracker.cpp
+//  ofxDLib
+//
+//
+
+#include "MultiStreamTracker.h"
+using namespace ofxDLib;
+
+MultiStreamTracker::MultiStreamTracker() {
+    maxBacklog = 4;
+    served = 0;
+    running = false;
+}
+
+MultiStreamTracker::~MultiStreamTracker() {
+    close();
+}
+
+//--------------------------------------------------------------
+void MultiStreamTracker::setup(unsigned int numStreams, string predictorDatFilePath, unsigned int numThreads) {
+    close();
+    if(predictorDatFilePath.empty()){
+        predictorDatFilePath = ofToDataPath("shape_predictor_68_face_landmarks.dat");
+    }
+    // every stream's tracker uses this one instance, the 68 landmark model is about 100 MB
+    std::shared_ptr<dlib::shape_predictor> predictor(new dlib::shape_predictor());
+    ofFile f(predictorDatFilePath);
+    if (f.exists()) {
+        dlib::deserialize(f.getAbsolutePath()) >> *predictor;
+    } else {
+        ofLogError("ofxDLib::MultiStreamTracker","SHAPE PREDICTOR DAT FILE MISSING!!!");
+    }
+    
+    streams.clear();
+    for (int i=0; i<numStreams; i++) {
+        std::unique_ptr<Stream> stream(new Stream());
+        stream->tracker.setup(predictor);
+        stream->busy = false;
+        stream->hasNewFaces = false;
+        stream->bUpscale = false;
+        stream->weight = 1;
+        stream->budget = 0;
+        stream->lastServed = 0;
+        stream->stats = StreamStats();
+        streams.push_back(std::move(stream));
+    }
+    
+    running = true;
+    numThreads = std::max(1u, std::min(numThreads, numStreams));
+    for (int i=0; i<numThreads; i++) {
+        workers.push_back(std::thread(&MultiStreamTracker::threadedFunction, this));
+    }
+}
+
+//--------------------------------------------------------------
+void MultiStreamTracker::close() {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        running = false;
+        // nothing would ever process the queued frames
+        for (auto & stream : streams) {
+            stream->stats.framesDropped += stream->backlog.size();
+            stream->backlog.clear();
+        }
+    }
+    frameAvailable.notify_all();
+    frameDone.notify_all();
+    for (auto & worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+}
+
+//--------------------------------------------------------------
+void MultiStreamTracker::addFrame(unsigned int stream, const ofPixels& pixels) {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        Stream& s = *streams[stream];
+        if (!running) {
+            s.stats.framesDropped++;
+            return;
+        }
+        s.backlog.push_back(pixels);
+        while (s.backlog.size() > maxBacklog) {
+            s.backlog.pop_front();
+            s.stats.framesDropped++;
+        }
+    }
+    frameAvailable.notify_one();
+}
+
+//--------------------------------------------------------------
+void MultiStreamTracker::waitForAll() {
+    std::unique_lock<std::mutex> lock(mutex);
+    frameDone.wait(lock, [this]() {
+        // without workers nothing is left to wait for
+        if (!running) return true;
+        for (auto & stream : streams) {
+            if (stream->busy || !stream->backlog.empty()) return false;
+        }
+        return true;
+    });
+}
+
+//--------------------------------------------------------------
+void MultiStreamTracker::dropStale(Stream& stream) {
+    // keep the newest frame, skip older ones that can't be done within budget anyway
+    if (stream.budget <= 0 || stream.stats.averageFrameTime <= 0) return;
+    while (stream.backlog.size() > 1 && stream.backlog.size() * stream.stats.averageFrameTime > stream.budget) {
+        stream.backlog.pop_front();
+        stream.stats.framesDropped++;
+    }
+}
+
+//--------------------------------------------------------------
+int MultiStreamTracker::nextStream() {
+    // largest weighted backlog first, the longest waiting stream wins ties
+    int next = -1;
+    for (int i=0; i<streams.size(); i++) {
+        Stream& s = *streams[i];
+        if (s.busy || s.backlog.empty()) continue;
+        if (next < 0) {
+            next = i;
+            continue;
+        }
+        Stream& best = *streams[next];
+        float priority = s.backlog.size() * s.weight;
+        float bestPriority = best.backlog.size() * best.weight;
+        if (priority > bestPriority || (priority == bestPriority && s.lastServed < best.lastServed)) {
+            next = i;
+        }
+    }
+    return next;
+}
+
+//--------------------------------------------------------------
+void MultiStreamTracker::threadedFunction() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        int next;
+        frameAvailable.wait(lock, [this, &next]() {
+            next = nextStream();
+            return !running || next >= 0;
+        });
+        if (!running) break;
+        
+        Stream& stream = *streams[next];
+        dropStale(stream);
+        ofPixels pixels = std::move(stream.backlog.front());
+        stream.backlog.pop_front();
+        stream.busy = true;
+        stream.lastServed = ++served;
+        bool bUpscale = stream.bUpscale;
+        lock.unlock();
+        
+        uint64_t start = ofGetElapsedTimeMicros();
+        stream.tracker.findFaces(pixels, bUpscale);
+        float frameTime = (ofGetElapsedTimeMicros() - start) / 1000.f;
+        
+        lock.lock();
+        stream.faces = stream.tracker.getFaces();
+        stream.hasNewFaces = true;
+        stream.busy = false;
+        stream.stats.framesProcessed++;
+        stream.stats.lastFrameTime = frameTime;
+        stream.stats.averageFrameTime = stream.stats.averageFrameTime > 0 ? ofLerp(stream.stats.averageFrameTime, frameTime, 0.1) : frameTime;
+        frameDone.notify_all();
+    }
+}
+
+//--------------------------------------------------------------
+unsigned int MultiStreamTracker::size() const {
+    return streams.size();
+}
+
+//--------------------------------------------------------------
+vector<Face> MultiStreamTracker::getFaces(unsigned int stream) {
+    std::unique_lock<std::mutex> lock(mutex);
+    return streams[stream]->faces;
+}
+
+//--------------------------------------------------------------
+bool MultiStreamTracker::isFrameNew(unsigned int stream) {
+    std::unique_lock<std::mutex> lock(mutex);
+    bool hasNewFaces = streams[stream]->hasNewFaces;
+    streams[stream]->hasNewFaces = false;
+    return hasNewFaces;
+}
+
+//--------------------------------------------------------------
+StreamStats MultiStreamTracker::getStats(unsigned int stream) {
+    std::unique_lock<std::mutex> lock(mutex);
+    StreamStats stats = streams[stream]->stats;
+    stats.backlog = streams[stream]->backlog.size();
+    return stats;
+}
+
+//--------------------------------------------------------------
+FaceTracker& MultiStreamTracker::getTracker(unsigned int stream) {
+    return streams[stream]->tracker;
+}
+
+//--------------------------------------------------------------
+void MultiStreamTracker::setMaxBacklog(unsigned int maxBacklog) {
+    std::unique_lock<std::mutex> lock(mutex);
+    this->maxBacklog = std::max(1u, maxBacklog);
+}
+
+//--------------------------------------------------------------
+void MultiStreamTracker::setWeight(unsigned int stream, float weight) {
+    std::unique_lock<std::mutex> lock(mutex);
+    streams[stream]->weight = weight;
+}
+
+//--------------------------------------------------------------
+void MultiStreamTracker::setBudget(unsigned int stream, float budget) {
+    std::unique_lock<std::mutex> lock(mutex);
+    streams[stream]->budget = budget;
+}
+
+//--------------------------------------------------------------
+void MultiStreamTracker::setUpscale(unsigned int stream, bool bUpscale) {
+    std::unique_lock<std::mutex> lock(mutex);
+    streams[stream]->bUpscale = bUpscale;
+}
+
+//--------------------------------------------------------------
+void MultiStreamTracker::draw(unsigned int stream) {
+    vector<Face> faces = getFaces(stream);
+    ofPushStyle();
+    
+    ofSetColor(ofColor::red);
+    ofNoFill();
+    
+    for (auto & face : faces) {
+        ofDrawBitmapString(ofToString(face.label), face.rect.getTopLeft());
+        ofDrawRectangle(face.rect);
+    }
+    
+    ofPopStyle();
+}
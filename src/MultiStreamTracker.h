@@ -0,0 +1,85 @@
+//
+//  MultiStreamTracker.h
+//  ofxDLib
+//
+//  runs one FaceTracker per camera stream on a shared pool of worker threads.
+//  Frames are queued per stream with addFrame(), workers always pick the idle
+//  stream with the largest weighted backlog, so busy streams get more cores
+//  while every stream is processed in order by at most one worker at a time.
+//
+
+#pragma once
+#include "FaceTracker.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+
+namespace ofxDLib {
+    
+    typedef struct {
+        unsigned long framesProcessed;
+        unsigned long framesDropped;
+        unsigned int backlog;
+        float lastFrameTime;     // ms
+        float averageFrameTime;  // ms
+    } StreamStats;
+    
+    class MultiStreamTracker {
+    protected:
+        struct Stream {
+            FaceTracker tracker;
+            std::deque<ofPixels> backlog;
+            vector<Face> faces;
+            bool busy, hasNewFaces, bUpscale;
+            float weight, budget;
+            unsigned long lastServed;
+            StreamStats stats;
+        };
+        
+        vector<std::unique_ptr<Stream> > streams;
+        vector<std::thread> workers;
+        std::mutex mutex;
+        std::condition_variable frameAvailable, frameDone;
+        unsigned int maxBacklog;
+        unsigned long served;
+        bool running;
+        
+        void threadedFunction();
+        int nextStream();
+        void dropStale(Stream& stream);
+    public:
+        MultiStreamTracker();
+        virtual ~MultiStreamTracker();
+        // the shape predictor is loaded once and all streams' trackers share that one instance
+        void setup(unsigned int numStreams, string predictorDatFilePath, unsigned int numThreads = std::thread::hardware_concurrency());
+        void close();
+        
+        // queue a frame, the oldest queued frame is dropped once maxBacklog is reached.
+        // Frames added after close() are dropped
+        void addFrame(unsigned int stream, const ofPixels& pixels);
+        // blocks until every queued frame is processed, returns right away before setup()
+        // or after close(), which drops the queued frames
+        void waitForAll();
+        
+        unsigned int size() const;
+        // latest results, safe to call while workers are running
+        vector<Face> getFaces(unsigned int stream);
+        // true once after each processed frame
+        bool isFrameNew(unsigned int stream);
+        StreamStats getStats(unsigned int stream);
+        // only touch the tracker itself while the stream is idle
+        FaceTracker& getTracker(unsigned int stream);
+        
+        void setMaxBacklog(unsigned int maxBacklog);
+        // relative share of the workers when streams compete, default 1
+        void setWeight(unsigned int stream, float weight);
+        // ms a frame may wait plus take to process, older frames are skipped to keep up. 0 disables
+        void setBudget(unsigned int stream, float budget);
+        void setUpscale(unsigned int stream, bool bUpscale);
+        
+        void draw(unsigned int stream);
+    };
+}
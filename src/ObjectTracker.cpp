@@ -8,18 +8,53 @@
 
 #include "ObjectTracker.h"
 using namespace ofxDLib;
+//--------------------------------------------------------------
+ObjectTracker::ObjectTracker(){
+    nextId = 0;
+    bRoi = false;
+    setTrackerSizes();
+    setNumThreads(std::thread::hardware_concurrency());
+}
+
 //--------------------------------------------------------------
 void ObjectTracker::setup(string predictorDatFilePath){
 
 }
+
+//--------------------------------------------------------------
+void ObjectTracker::setNumThreads(unsigned int numThreads){
+    pool.reset(new dlib::thread_pool(std::max(1u, numThreads)));
+}
+
+//--------------------------------------------------------------
+void ObjectTracker::setTrackerSizes(unsigned int filterSize, unsigned int numScaleLevels, unsigned int scaleWindowSize){
+    // dlib::correlation_tracker takes the filter sizes as powers of 2
+    filterSizeLog2 = 2;
+    while ((2u << filterSizeLog2) <= filterSize) filterSizeLog2++;
+    numScaleLevelsLog2 = 1;
+    while ((2u << numScaleLevelsLog2) <= numScaleLevels) numScaleLevelsLog2++;
+    this->scaleWindowSize = std::max(1u, scaleWindowSize);
+}
+
+//--------------------------------------------------------------
+void ObjectTracker::setRoiProcessing(bool bRoi){
+    this->bRoi = bRoi;
+}
+
+//--------------------------------------------------------------
+bool ObjectTracker::getRoiProcessing(){
+    return bRoi;
+}
+
 //--------------------------------------------------------------
 void ObjectTracker::draw(){
     ofPushStyle();
     
     ofSetColor(ofColor::red);
     ofNoFill();
-    for (auto& r:dets) {
-        ofDrawRectangle(toOf(r));
+    for (auto& t:tracked) {
+        ofDrawRectangle(t.target.rect);
+        ofDrawBitmapString(ofToString(t.target.id) + " " + ofToString(t.target.confidence, 1), t.target.rect.getTopLeft());
     }
 
     ofPopStyle();
@@ -28,11 +63,88 @@ void ObjectTracker::draw(){
 
 //--------------------------------------------------------------
 void ObjectTracker::setNewSelection(ofRectangle _rect){
-    selectionTrackerInit = false;
-    sel_x = _rect.getX();
-    sel_y = _rect.getY();
-    sel_w = _rect.getWidth();
-    sel_h = _rect.getHeight();
+    clear();
+    addTarget(_rect);
+}
+
+//--------------------------------------------------------------
+unsigned int ObjectTracker::addTarget(const ofRectangle& rect){
+    Tracked t;
+    t.target.id = nextId++;
+    t.target.rect = rect;
+    t.target.confidence = 0;
+    t.started = false;
+    t.position = dlib::drectangle(rect.x, rect.y, rect.x+rect.width, rect.y+rect.height);
+    t.tracker = dlib::correlation_tracker_float(filterSizeLog2, numScaleLevelsLog2, scaleWindowSize);
+    tracked.push_back(t);
+    return t.target.id;
+}
+
+//--------------------------------------------------------------
+void ObjectTracker::removeTarget(unsigned int id){
+    int i = getIndex(id);
+    if (i >= 0) {
+        tracked.erase(tracked.begin() + i);
+    }
+}
+
+//--------------------------------------------------------------
+void ObjectTracker::clear(){
+    tracked.clear();
+}
+
+//--------------------------------------------------------------
+int ObjectTracker::getIndex(unsigned int id){
+    for (int i=0; i<tracked.size(); i++) {
+        if (tracked[i].target.id == id) return i;
+    }
+    return -1;
+}
+
+//--------------------------------------------------------------
+dlib::rectangle ObjectTracker::getSearchArea(const Tracked& t){
+    // start_track samples the target padded by 1.4 and the scale pyramid around it. update
+    // can also move the target by up to half of the padded chip before sampling the scale pyramid
+    double scaleReach = 0.5 * std::pow(t.tracker.get_scale_pyramid_alpha(), t.tracker.get_num_scale_levels()/2.0);
+    double reach = t.started ? 0.7 + scaleReach : std::max(0.7, scaleReach);
+    // a few extra pixels for the bilinear sampling and pyramid_up's filter
+    double margin = 4;
+    const dlib::drectangle& p = t.position;
+    dlib::vector<double,2> c = dlib::center(p);
+    double rx = reach * p.width() + margin;
+    double ry = reach * p.height() + margin;
+    return dlib::rectangle(std::floor(c.x() - rx), std::floor(c.y() - ry), std::ceil(c.x() + rx), std::ceil(c.y() + ry));
+}
+
+//--------------------------------------------------------------
+unsigned int ObjectTracker::size(){
+    return tracked.size();
+}
+
+//--------------------------------------------------------------
+vector<Target> ObjectTracker::getTargets(){
+    vector<Target> targets;
+    for (auto& t:tracked) {
+        targets.push_back(t.target);
+    }
+    return targets;
+}
+
+//--------------------------------------------------------------
+bool ObjectTracker::existsTarget(unsigned int id){
+    return getIndex(id) >= 0;
+}
+
+//--------------------------------------------------------------
+ofRectangle ObjectTracker::getRectangle(unsigned int id){
+    int i = getIndex(id);
+    return i >= 0 ? tracked[i].target.rect : ofRectangle();
+}
+
+//--------------------------------------------------------------
+float ObjectTracker::getConfidence(unsigned int id){
+    int i = getIndex(id);
+    return i >= 0 ? tracked[i].target.confidence : 0;
 }
 
 //--------------------------------------------------------------
@@ -40,31 +152,47 @@ void ObjectTracker::findObjects(const ofPixels& pixels, bool bUpscale){
     //http://dlib.net/video_tracking_ex.cpp.html
     //http://blog.dlib.net/2015/02/dlib-1813-released.html
     
-    dlib::array2d< dlib::rgb_pixel> img;
-    toDLib(pixels , img);
-    
-    if (bUpscale) {
-        pyramid_up(img);
+    float scale = bUpscale ? 2 : 1;
+    if (!bRoi) {
+        // one conversion per frame, shared read only by all targets
+        toDLib(pixels , img);
+        if (bUpscale) {
+            pyramid_up(img);
+        }
+    } else {
+        rois.resize(tracked.size());
     }
     
-    if(selectionTrackerInit == false){
-        selectionTrackerInit = true;
+    // every correlation_tracker only touches its own state, so targets update in parallel
+    dlib::parallel_for(*pool, 0, tracked.size(), [&](long i){
+        Tracked& t = tracked[i];
+        const dlib::array2d<dlib::rgb_pixel>* image = &img;
+        dlib::vector<double,2> offset(0, 0);
+        if (bRoi) {
+            dlib::rectangle area = toDLib(pixels, getSearchArea(t), rois[i]);
+            if (area.is_empty()) {
+                // completely outside of the frame
+                t.target.confidence = 0;
+                return;
+            }
+            if (bUpscale) {
+                pyramid_up(rois[i]);
+            }
+            image = &rois[i];
+            offset = area.tl_corner();
+        }
         
-        // Now create a tracker and start a track on the juice box.  If you look at the first
-        // frame you will see that the juice box is centered at pixel point(92,110) and 38
-        // pixels wide and 86 pixels tall.
-        
-        cout<<"sel_x "<<sel_x<<" "<<sel_y<<" "<<sel_w;
-        tracker.start_track(img, dlib::rectangle(sel_x,sel_y, sel_x+sel_w, sel_y+sel_h));
-        //            centered_rect(point(sel_x,sel_y), sel_w, sel_h));
-        
-        dets.push_back(dlib::rectangle(0,0,1,1));
-    }else{
-        tracker.update(img);
-        dets.back() = tracker.get_position();
-        
-    }
-    
-    
+        // the tracker always gets its position passed in, in coordinates of the image it sees
+        const dlib::drectangle& p = t.position;
+        dlib::drectangle guess((p.left()-offset.x())*scale, (p.top()-offset.y())*scale, (p.right()-offset.x())*scale, (p.bottom()-offset.y())*scale);
+        if (!t.started) {
+            t.tracker.start_track(*image, guess);
+            t.started = true;
+        } else {
+            t.target.confidence = t.tracker.update(*image, guess);
+            dlib::drectangle q = t.tracker.get_position();
+            t.position = dlib::drectangle(q.left()/scale+offset.x(), q.top()/scale+offset.y(), q.right()/scale+offset.x(), q.bottom()/scale+offset.y());
+            t.target.rect.set(t.position.left(), t.position.top(), t.position.width(), t.position.height());
+        }
+    }, 1);
 }
-
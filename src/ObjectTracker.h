@@ -7,28 +7,70 @@
 //
 #pragma once
 #include "ofxDLib.h"
+#include "dlib/threads.h"
+#include <thread>
+#include <memory>
 
 
 namespace ofxDLib{
+    
+    typedef struct {
+        unsigned int id;
+        ofRectangle rect;
+        // peak to side lobe ratio of the last update, low values mean the target is likely lost
+        float confidence;
+    } Target;
+    
     class ObjectTracker{
     public:
+        ObjectTracker();
+        
         void setup(string predictorDatFilePath);
+        void setNumThreads(unsigned int numThreads);
+        // sizes of the correlation filters for targets added afterwards, filterSize and
+        // numScaleLevels are rounded down to powers of 2. 32, 8 is several times faster than the defaults
+        void setTrackerSizes(unsigned int filterSize = 64, unsigned int numScaleLevels = 32, unsigned int scaleWindowSize = 23);
+        
+        // with bRoi only a padded window around every target's search area is converted
+        // (and upscaled), instead of the whole frame. Much cheaper for small targets in big frames
+        void setRoiProcessing(bool bRoi);
+        bool getRoiProcessing();
         
         void findObjects(const ofPixels& pixels, bool bUpscale = false);
+        // removes all targets and starts tracking _rect
         void setNewSelection(ofRectangle _rect = ofRectangle(0,0,38,86));
+        // targets start tracking with the next findObjects() call, rectangles are in pixels coordinates
+        unsigned int addTarget(const ofRectangle& rect);
+        void removeTarget(unsigned int id);
+        void clear();
+        
+        unsigned int size();
+        vector<Target> getTargets();
+        bool existsTarget(unsigned int id);
+        ofRectangle getRectangle(unsigned int id);
+        float getConfidence(unsigned int id);
         
         void draw();
     protected:
+        struct Tracked {
+            Target target;
+            bool started;
+            // exact position in pixels coordinates, the tracker itself only sees image local ones
+            dlib::drectangle position;
+            dlib::correlation_tracker_float tracker;
+        };
+        int getIndex(unsigned int id);
+        // the part of the frame the next update of t can sample from, in pixels coordinates
+        dlib::rectangle getSearchArea(const Tracked& t);
         
-        std::vector<dlib::rectangle> dets;
-
-        
-        std::vector<dlib::full_object_detection> shapes;
-        
-        //object tracker
-        dlib::correlation_tracker tracker;
-        bool selectionTrackerInit;
-        int sel_x,sel_y, sel_w, sel_h;
+        std::vector<Tracked> tracked;
+        unsigned int nextId;
+        unsigned int filterSizeLog2, numScaleLevelsLog2, scaleWindowSize;
+        bool bRoi;
         
+        std::unique_ptr<dlib::thread_pool> pool;
+        dlib::array2d<dlib::rgb_pixel> img;
+        // one window per target when bRoi is set
+        dlib::array<dlib::array2d<dlib::rgb_pixel> > rois;
     };
-}
\ No newline at end of file
+}
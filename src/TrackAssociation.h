@@ -0,0 +1,269 @@
+//
+//  TrackAssociation.h
+//  learned detection to track association on top of Tracker
+//
+//  AssociationTrainer records labelled tracks and learns a linear scoring
+//  function with dlib::structural_track_association_trainer. LearnedTracker
+//  then matches objects with that function instead of a hand set distance
+//  threshold: a detection is matched to the track it scores highest with,
+//  if that score is positive.
+//
+
+#pragma once
+
+#include "FaceTracker.h"
+#include "dlib/svm_threaded.h"
+
+namespace ofxDLib {
+    
+    class AssociationTrack;
+    
+    // what is known about a detection, appearance is optional and compared elementwise
+    struct AssociationDetection {
+        typedef AssociationTrack track_type;
+        ofRectangle rect;
+        std::vector<float> appearance;
+    };
+    
+    inline AssociationDetection toAssociationDetection(const ofRectangle& rect) {
+        AssociationDetection det;
+        det.rect = rect;
+        return det;
+    }
+    
+    // landmarks relative to the face rectangle as appearance
+    inline AssociationDetection toAssociationDetection(const Face& face) {
+        AssociationDetection det;
+        det.rect = face.rect;
+        det.appearance.reserve(face.landmarks.size() * 2);
+        for (auto & landmark : face.landmarks) {
+            det.appearance.push_back((landmark.x - face.rect.x) / std::max(face.rect.width, 1.f));
+            det.appearance.push_back((landmark.y - face.rect.y) / std::max(face.rect.height, 1.f));
+        }
+        return det;
+    }
+    
+    inline void serialize(const AssociationDetection& item, std::ostream& out) {
+        dlib::serialize(item.rect.x, out);
+        dlib::serialize(item.rect.y, out);
+        dlib::serialize(item.rect.width, out);
+        dlib::serialize(item.rect.height, out);
+        dlib::serialize(item.appearance, out);
+    }
+    
+    inline void deserialize(AssociationDetection& item, std::istream& in) {
+        dlib::deserialize(item.rect.x, in);
+        dlib::deserialize(item.rect.y, in);
+        dlib::deserialize(item.rect.width, in);
+        dlib::deserialize(item.rect.height, in);
+        dlib::deserialize(item.appearance, in);
+    }
+    
+    // the track interface dlib::track_association_function expects
+    class AssociationTrack {
+    protected:
+        AssociationDetection last;
+        ofVec2f velocity;
+        unsigned int lastSeen;
+        bool initialized;
+    public:
+        typedef dlib::matrix<double, 0, 1> feature_vector_type;
+        static const long numFeatures = 8;
+        
+        AssociationTrack()
+        :lastSeen(0)
+        ,initialized(false) {
+        }
+        
+        void get_similarity_features(const AssociationDetection& det, feature_vector_type& feats) const {
+            const ofRectangle& a = last.rect;
+            const ofRectangle& b = det.rect;
+            float scale = std::max((a.width + a.height + b.width + b.height) / 4, 1.f);
+            ofVec2f centerA(a.x + a.width / 2, a.y + a.height / 2);
+            ofVec2f centerB(b.x + b.width / 2, b.y + b.height / 2);
+            ofVec2f predicted = centerA + velocity * (lastSeen + 1);
+            float appearance = 0;
+            size_t n = std::min(last.appearance.size(), det.appearance.size());
+            for (size_t i=0; i<n; i++) {
+                appearance += std::fabs(last.appearance[i] - det.appearance[i]);
+            }
+            
+            feats.set_size(numFeatures);
+            feats(0) = std::fabs(centerA.x - centerB.x) / scale;
+            feats(1) = std::fabs(centerA.y - centerB.y) / scale;
+            feats(2) = predicted.distance(centerB) / scale;
+            feats(3) = std::fabs(std::log(std::max(b.width, 1.f) / std::max(a.width, 1.f)));
+            feats(4) = std::fabs(std::log(std::max(b.height, 1.f) / std::max(a.height, 1.f)));
+            feats(5) = IoUDistance()(a, b);
+            feats(6) = n > 0 ? appearance / n : 0;
+            feats(7) = lastSeen;
+        }
+        
+        void update_track(const AssociationDetection& det) {
+            if (initialized) {
+                ofVec2f previous(last.rect.x + last.rect.width / 2, last.rect.y + last.rect.height / 2);
+                ofVec2f current(det.rect.x + det.rect.width / 2, det.rect.y + det.rect.height / 2);
+                velocity = (current - previous) / (lastSeen + 1);
+            }
+            last = det;
+            lastSeen = 0;
+            initialized = true;
+        }
+        
+        void propagate_track() {
+            lastSeen++;
+        }
+    };
+    
+    typedef dlib::track_association_function<AssociationDetection> AssociationFunction;
+    
+    // D is only used until an association function is set
+    template <class T, class D = TrackingDistance>
+    class LearnedTracker : public Tracker<T, D> {
+    protected:
+        typedef Tracker<T, D> Base;
+        typedef typename Base::MatchPair MatchPair;
+        typedef typename Base::MatchDistancePair MatchDistancePair;
+        
+        AssociationFunction association;
+        std::map<unsigned int, AssociationTrack> tracks;
+        
+        void getMatches(const std::vector<T>& objects, std::vector<MatchDistancePair>& all) {
+            const dlib::matrix<double, 0, 1>& weights = association.get_assignment_function().get_weights();
+            double bias = association.get_assignment_function().get_bias();
+            if (weights.size() != AssociationTrack::numFeatures) {
+                // nothing learned yet
+                Base::getMatches(objects, all);
+                return;
+            }
+            int n = objects.size();
+            int m = this->previous.size();
+            std::vector<AssociationDetection> dets(n);
+            for (int i=0; i<n; i++) {
+                dets[i] = toAssociationDetection(objects[i]);
+            }
+            AssociationTrack::feature_vector_type feats;
+            for (int j=0; j<m; j++) {
+                unsigned int label = this->previous[j].getLabel();
+                if (tracks.count(label) == 0) {
+                    tracks[label].update_track(toAssociationDetection(this->previous[j].object));
+                }
+                const AssociationTrack& track = tracks[label];
+                for (int i=0; i<n; i++) {
+                    track.get_similarity_features(dets[i], feats);
+                    float score = dlib::dot(weights, feats) + bias;
+                    if (score > 0) {
+                        // best scores first
+                        all.push_back(MatchDistancePair(MatchPair(i, j), -score));
+                    }
+                }
+            }
+        }
+    public:
+        bool setup(string associationFilePath) {
+            ofFile f(associationFilePath);
+            if (!f.exists()) {
+                ofLogError("ofxDLib::LearnedTracker","ASSOCIATION FILE MISSING!!!");
+                return false;
+            }
+            dlib::deserialize(f.getAbsolutePath()) >> association;
+            return true;
+        }
+        void setAssociationFunction(const AssociationFunction& association) {
+            this->association = association;
+        }
+        const AssociationFunction& getAssociationFunction() const {
+            return association;
+        }
+        const std::vector<unsigned int>& track(const std::vector<T>& objects) {
+            const std::vector<unsigned int>& labels = Base::track(objects);
+            for (int i=0; i<(int)this->current.size(); i++) {
+                const TrackedObject<T>& cur = this->current[i];
+                if (cur.getLastSeen() == 0) {
+                    tracks[cur.getLabel()].update_track(toAssociationDetection(cur.object));
+                } else {
+                    tracks[cur.getLabel()].propagate_track();
+                }
+            }
+            std::map<unsigned int, AssociationTrack>::iterator tracksItr = tracks.begin();
+            while (tracksItr != tracks.end()) {
+                if (!this->existsCurrent(tracksItr->first)) {
+                    tracks.erase(tracksItr++);
+                } else {
+                    ++tracksItr;
+                }
+            }
+            return labels;
+        }
+    };
+    
+    // records ground truth tracks, e.g. hand corrected Tracker output, and learns an AssociationFunction
+    class AssociationTrainer {
+    public:
+        typedef dlib::labeled_detection<AssociationDetection, unsigned long> LabeledDetection;
+        typedef std::vector<std::vector<LabeledDetection> > Sequence;
+    protected:
+        std::vector<Sequence> sequences;
+        float c;
+        unsigned int numThreads;
+    public:
+        AssociationTrainer()
+        :c(10)
+        ,numThreads(4) {
+            sequences.resize(1);
+        }
+        void setC(float c) {
+            this->c = c;
+        }
+        void setNumThreads(unsigned int numThreads) {
+            this->numThreads = numThreads;
+        }
+        // objects of one frame and their true identities
+        template <class T>
+        void addFrame(const std::vector<T>& objects, const std::vector<unsigned int>& labels) {
+            std::vector<LabeledDetection> frame(objects.size());
+            for (int i=0; i<objects.size(); i++) {
+                frame[i].det = toAssociationDetection(objects[i]);
+                frame[i].label = labels[i];
+            }
+            sequences.back().push_back(frame);
+        }
+        // start a new independent recording, labels don't carry over
+        void nextSequence() {
+            if (!sequences.back().empty()) {
+                sequences.push_back(Sequence());
+            }
+        }
+        size_t size() const {
+            size_t frames = 0;
+            for (auto & sequence : sequences) {
+                frames += sequence.size();
+            }
+            return frames;
+        }
+        AssociationFunction train() const {
+            std::vector<Sequence> samples;
+            for (auto & sequence : sequences) {
+                if (!sequence.empty()) samples.push_back(sequence);
+            }
+            dlib::structural_track_association_trainer trainer;
+            trainer.set_c(c);
+            trainer.set_num_threads(numThreads);
+            return trainer.train(samples);
+        }
+        // fraction of recorded detections the function associates to their true track
+        double test(const AssociationFunction& association) const {
+            std::vector<Sequence> samples;
+            for (auto & sequence : sequences) {
+                if (!sequence.empty()) samples.push_back(sequence);
+            }
+            return dlib::test_track_association_function(association, samples);
+        }
+        void save(string filePath) const {
+            dlib::serialize(ofToDataPath(filePath)) << sequences;
+        }
+        void load(string filePath) {
+            dlib::deserialize(ofToDataPath(filePath)) >> sequences;
+        }
+    };
+}
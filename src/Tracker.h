@@ -15,18 +15,49 @@
 #include "ofVec2f.h"
 #include "ofVec3f.h"
 #include "ofMath.h"
+#include "TrackingDistance.h"
+#include "dlib/filtering/kalman_filter.h"
+#include "dlib/serialize.h"
+
+// dlib style serialization of the OF types used by the trackers, these live in
+// the global namespace so dlib's container serializers find them
+inline void serialize(const ofVec2f& item, std::ostream& out) {
+    dlib::serialize(item.x, out);
+    dlib::serialize(item.y, out);
+}
+
+inline void deserialize(ofVec2f& item, std::istream& in) {
+    dlib::deserialize(item.x, in);
+    dlib::deserialize(item.y, in);
+}
+
+inline void serialize(const ofVec3f& item, std::ostream& out) {
+    dlib::serialize(item.x, out);
+    dlib::serialize(item.y, out);
+    dlib::serialize(item.z, out);
+}
+
+inline void deserialize(ofVec3f& item, std::istream& in) {
+    dlib::deserialize(item.x, in);
+    dlib::deserialize(item.y, in);
+    dlib::deserialize(item.z, in);
+}
+
+inline void serialize(const ofRectangle& item, std::ostream& out) {
+    dlib::serialize(item.x, out);
+    dlib::serialize(item.y, out);
+    dlib::serialize(item.width, out);
+    dlib::serialize(item.height, out);
+}
+
+inline void deserialize(ofRectangle& item, std::istream& in) {
+    dlib::deserialize(item.x, in);
+    dlib::deserialize(item.y, in);
+    dlib::deserialize(item.width, in);
+    dlib::deserialize(item.height, in);
+}
 
 namespace ofxDLib {
-    float trackingDistance(const ofRectangle& a, const ofRectangle& b) {
-        ofVec3f centerA = a.getCenter();
-        ofVec3f centerB = b.getCenter();
-        return centerA.distance(centerB);
-    }
-    
-    float trackingDistance(const ofVec2f& a, const ofVec2f& b) {
-        return a.distance(b);
-    }
-    
     template <class T>
     class TrackedObject {
     protected:
@@ -74,6 +105,21 @@ namespace ofxDLib {
         int getIndex() const {
             return index;
         }
+        
+        friend void serialize(const TrackedObject& item, std::ostream& out) {
+            dlib::serialize(item.lastSeen, out);
+            dlib::serialize(item.label, out);
+            dlib::serialize(item.age, out);
+            dlib::serialize(item.index, out);
+            serialize(item.object, out);
+        }
+        friend void deserialize(TrackedObject& item, std::istream& in) {
+            dlib::deserialize(item.lastSeen, in);
+            dlib::deserialize(item.label, in);
+            dlib::deserialize(item.age, in);
+            dlib::deserialize(item.index, in);
+            deserialize(item.object, in);
+        }
     };
     
     struct bySecond {
@@ -83,28 +129,39 @@ namespace ofxDLib {
         }
     };
     
-    template <class T>
+    // D is the distance policy, see TrackingDistance.h
+    template <class T, class D = TrackingDistance>
     class Tracker {
     protected:
+        typedef std::pair<int, int> MatchPair;
+        typedef std::pair<MatchPair, float> MatchDistancePair;
+        
         vector<TrackedObject<T> > previous, current;
         vector<unsigned int> currentLabels, previousLabels, newLabels, deadLabels;
         std::map<unsigned int, TrackedObject<T>*> previousLabelMap, currentLabelMap;
         
         unsigned int persistence, curLabel;
         float maximumDistance;
+        D distance;
         unsigned int getNewLabel() {
             return curLabel++;
         }
+        // collect all (object, previous) pairs close enough to be matched
+        virtual void getMatches(const std::vector<T>& objects, std::vector<MatchDistancePair>& all);
+        void buildLabelMaps();
         
     public:
-        Tracker<T>()
+        Tracker()
         :persistence(15)
         ,curLabel(0)
-        ,maximumDistance(64) {
+        ,maximumDistance(defaultMaximumDistance(D())) {
         }
         virtual ~Tracker(){};
         void setPersistence(unsigned int persistence);
+        // in the units of D, defaults to defaultMaximumDistance(D())
         void setMaximumDistance(float maximumDistance);
+        // for configuring stateful policies
+        D& getDistance();
         virtual const std::vector<unsigned int>& track(const std::vector<T>& objects);
         
         // organized in the order received by track()
@@ -122,36 +179,101 @@ namespace ofxDLib {
         bool existsPrevious(unsigned int label) const;
         int getAge(unsigned int label) const;
         int getLastSeen(unsigned int label) const;
+        
+        // labels and tracks survive a restart, the distance policy is not stored
+        friend void serialize(const Tracker& item, std::ostream& out) {
+            int version = 1;
+            dlib::serialize(version, out);
+            dlib::serialize(item.persistence, out);
+            dlib::serialize(item.curLabel, out);
+            dlib::serialize(item.maximumDistance, out);
+            dlib::serialize(item.currentLabels, out);
+            dlib::serialize(item.previousLabels, out);
+            dlib::serialize(item.newLabels, out);
+            dlib::serialize(item.deadLabels, out);
+            dlib::serialize(item.previous.size(), out);
+            for(int i = 0; i < (int)item.previous.size(); i++) {
+                serialize(item.previous[i], out);
+            }
+            dlib::serialize(item.current.size(), out);
+            for(int i = 0; i < (int)item.current.size(); i++) {
+                serialize(item.current[i], out);
+            }
+        }
+        friend void deserialize(Tracker& item, std::istream& in) {
+            int version = 0;
+            dlib::deserialize(version, in);
+            if(version != 1) {
+                throw dlib::serialization_error("Unexpected version found while deserializing ofxDLib::Tracker.");
+            }
+            dlib::deserialize(item.persistence, in);
+            dlib::deserialize(item.curLabel, in);
+            dlib::deserialize(item.maximumDistance, in);
+            dlib::deserialize(item.currentLabels, in);
+            dlib::deserialize(item.previousLabels, in);
+            dlib::deserialize(item.newLabels, in);
+            dlib::deserialize(item.deadLabels, in);
+            size_t size;
+            dlib::deserialize(size, in);
+            item.previous.clear();
+            for(int i = 0; i < (int)size; i++) {
+                item.previous.push_back(TrackedObject<T>(T(), 0, -1));
+                deserialize(item.previous.back(), in);
+            }
+            dlib::deserialize(size, in);
+            item.current.clear();
+            for(int i = 0; i < (int)size; i++) {
+                item.current.push_back(TrackedObject<T>(T(), 0, -1));
+                deserialize(item.current.back(), in);
+            }
+            item.buildLabelMaps();
+        }
     };
     
-    template <class T>
-    void Tracker<T>::setPersistence(unsigned int persistence) {
+    template <class T, class D>
+    void Tracker<T, D>::setPersistence(unsigned int persistence) {
         this->persistence = persistence;
     }
     
-    template <class T>
-    void Tracker<T>::setMaximumDistance(float maximumDistance) {
+    template <class T, class D>
+    void Tracker<T, D>::setMaximumDistance(float maximumDistance) {
         this->maximumDistance = maximumDistance;
     }
     
-    template <class T>
-    const std::vector<unsigned int>& Tracker<T>::track(const std::vector<T>& objects) {
-        previous = current;
+    template <class T, class D>
+    D& Tracker<T, D>::getDistance() {
+        return distance;
+    }
+    
+    template <class T, class D>
+    void Tracker<T, D>::getMatches(const std::vector<T>& objects, std::vector<MatchDistancePair>& all) {
         int n = objects.size();
         int m = previous.size();
-        
-        // build NxM distance matrix
-        typedef std::pair<int, int> MatchPair;
-        typedef std::pair<MatchPair, float> MatchDistancePair;
-        std::vector<MatchDistancePair> all;
+        std::vector<const T*> previousObjects(m);
+        for(int j = 0; j < m; j++) {
+            previousObjects[j] = &previous[j].object;
+        }
+        std::vector<float> distances;
+        trackingDistances(distance, objects, previousObjects, distances);
         for(int i = 0; i < n; i++) {
             for(int j = 0; j < m; j++) {
-                float curDistance = trackingDistance(objects[i], previous[j].object);
+                float curDistance = distances[i * m + j];
                 if(curDistance < maximumDistance) {
                     all.push_back(MatchDistancePair(MatchPair(i, j), curDistance));
                 }
             }
         }
+    }
+    
+    template <class T, class D>
+    const std::vector<unsigned int>& Tracker<T, D>::track(const std::vector<T>& objects) {
+        previous = current;
+        int n = objects.size();
+        int m = previous.size();
+        
+        // build NxM distance matrix
+        std::vector<MatchDistancePair> all;
+        getMatches(objects, all);
         
         // sort all possible matches by distance
         sort(all.begin(), all.end(), bySecond());
@@ -203,7 +325,13 @@ namespace ofxDLib {
             }
         }
         
-        // build label maps
+        buildLabelMaps();
+        
+        return currentLabels;
+    }
+    
+    template <class T, class D>
+    void Tracker<T, D>::buildLabelMaps() {
         currentLabelMap.clear();
         for(int i = 0; i < (int)current.size(); i++) {
             unsigned int label = current[i].getLabel();
@@ -214,77 +342,155 @@ namespace ofxDLib {
             unsigned int label = previous[i].getLabel();
             previousLabelMap[label] = &(previous[i]);
         }
-        
-        return currentLabels;
     }
     
-    template <class T>
-    const std::vector<unsigned int>& Tracker<T>::getCurrentLabels() const {
+    template <class T, class D>
+    const std::vector<unsigned int>& Tracker<T, D>::getCurrentLabels() const {
         return currentLabels;
     }
     
-    template <class T>
-    const std::vector<unsigned int>& Tracker<T>::getPreviousLabels() const {
+    template <class T, class D>
+    const std::vector<unsigned int>& Tracker<T, D>::getPreviousLabels() const {
         return previousLabels;
     }
     
-    template <class T>
-    const std::vector<unsigned int>& Tracker<T>::getNewLabels() const {
+    template <class T, class D>
+    const std::vector<unsigned int>& Tracker<T, D>::getNewLabels() const {
         return newLabels;
     }
     
-    template <class T>
-    const vector<unsigned int>& Tracker<T>::getDeadLabels() const {
+    template <class T, class D>
+    const vector<unsigned int>& Tracker<T, D>::getDeadLabels() const {
         return deadLabels;
     }
     
-    template <class T>
-    unsigned int Tracker<T>::getLabelFromIndex(unsigned int i) const {
+    template <class T, class D>
+    unsigned int Tracker<T, D>::getLabelFromIndex(unsigned int i) const {
         return currentLabels[i];
     }
     
-    template <class T>
-    int Tracker<T>::getIndexFromLabel(unsigned int label) const {
+    template <class T, class D>
+    int Tracker<T, D>::getIndexFromLabel(unsigned int label) const {
         return currentLabelMap.find(label)->second->getIndex();
     }
     
-    template <class T>
-    const T& Tracker<T>::getPrevious(unsigned int label) const {
+    template <class T, class D>
+    const T& Tracker<T, D>::getPrevious(unsigned int label) const {
         return previousLabelMap.find(label)->second->object;
     }
     
-    template <class T>
-    const T& Tracker<T>::getCurrent(unsigned int label) const {
+    template <class T, class D>
+    const T& Tracker<T, D>::getCurrent(unsigned int label) const {
         return currentLabelMap.find(label)->second->object;
     }
     
-    template <class T>
-    bool Tracker<T>::existsCurrent(unsigned int label) const {
+    template <class T, class D>
+    bool Tracker<T, D>::existsCurrent(unsigned int label) const {
         return currentLabelMap.count(label) > 0;
     }
     
-    template <class T>
-    bool Tracker<T>::existsPrevious(unsigned int label) const {
+    template <class T, class D>
+    bool Tracker<T, D>::existsPrevious(unsigned int label) const {
         return previousLabelMap.count(label) > 0;
     }
     
-    template <class T>
-    int Tracker<T>::getAge(unsigned int label) const{
+    template <class T, class D>
+    int Tracker<T, D>::getAge(unsigned int label) const{
         return currentLabelMap.find(label)->second->getAge();
     }
     
-    template <class T>
-    int Tracker<T>::getLastSeen(unsigned int label) const{
+    template <class T, class D>
+    int Tracker<T, D>::getLastSeen(unsigned int label) const{
         return currentLabelMap.find(label)->second->getLastSeen();
     }
     
-    class RectTracker : public Tracker<ofRectangle> {
+    template <class D = TrackingDistance>
+    class BasicRectTracker : public Tracker<ofRectangle, D> {
     protected:
+        typedef Tracker<ofRectangle, D> Base;
+        typedef typename Base::MatchPair MatchPair;
+        typedef typename Base::MatchDistancePair MatchDistancePair;
+        using Base::previous;
+        using Base::current;
+        using Base::maximumDistance;
+        
+        // constant velocity model, state is (x, y, vx, vy) of the center, measurement is (x, y)
+        typedef dlib::kalman_filter<4, 2> MotionFilter;
+        
         float smoothingRate;
+        bool motionPrediction;
+        float maximumMahalanobisDistance;
+        float processNoise, measurementNoise;
         std::map<unsigned int, ofRectangle> smoothed;
+        std::map<unsigned int, MotionFilter> filters;
+        
+        static dlib::matrix<double, 2, 1> toMeasurement(const ofRectangle& rect) {
+            dlib::matrix<double, 2, 1> z;
+            z = rect.x + rect.width / 2, rect.y + rect.height / 2;
+            return z;
+        }
+        MotionFilter createFilter(const ofRectangle& rect) const {
+            dlib::matrix<double, 4, 4> A, Q, P;
+            A = 1, 0, 1, 0,
+                0, 1, 0, 1,
+                0, 0, 1, 0,
+                0, 0, 0, 1;
+            dlib::matrix<double, 2, 4> H;
+            H = 1, 0, 0, 0,
+                0, 1, 0, 0;
+            Q = processNoise * dlib::identity_matrix<double>(4);
+            MotionFilter filter;
+            filter.set_transition_model(A);
+            filter.set_observation_model(H);
+            filter.set_process_noise(Q);
+            filter.set_measurement_noise(measurementNoise * dlib::identity_matrix<double>(2));
+            filter.update(toMeasurement(rect));
+            // the velocity is unknown until the second measurement, allow anything up to maximumDistance
+            P = 0;
+            P(0, 0) = P(1, 1) = measurementNoise;
+            P(2, 2) = P(3, 3) = maximumDistance * maximumDistance;
+            filter.set_estimation_error_covariance(P);
+            return filter;
+        }
+        void getMatches(const std::vector<ofRectangle>& objects, std::vector<MatchDistancePair>& all) {
+            if(!motionPrediction) {
+                Base::getMatches(objects, all);
+                return;
+            }
+            int n = objects.size();
+            int m = previous.size();
+            std::vector<dlib::matrix<double, 2, 1> > measurements(n);
+            for(int i = 0; i < n; i++) {
+                measurements[i] = toMeasurement(objects[i]);
+            }
+            for(int j = 0; j < m; j++) {
+                unsigned int label = previous[j].getLabel();
+                if(filters.count(label) == 0) {
+                    filters[label] = createFilter(previous[j].object);
+                }
+                const MotionFilter& filter = filters[label];
+                const dlib::matrix<double, 4, 4>& A = filter.get_transition_model();
+                const dlib::matrix<double, 2, 4>& H = filter.get_observation_model();
+                // innovation covariance of the predicted position
+                const dlib::matrix<double, 4, 4> P = A * filter.get_current_estimation_error_covariance() * dlib::trans(A) + filter.get_process_noise();
+                const dlib::matrix<double, 2, 2> S = dlib::inv(H * P * dlib::trans(H) + filter.get_measurement_noise());
+                const dlib::matrix<double, 2, 1> predicted = H * filter.get_predicted_next_state();
+                for(int i = 0; i < n; i++) {
+                    const dlib::matrix<double, 2, 1> residual = measurements[i] - predicted;
+                    float curDistance = std::sqrt(dlib::dot(residual, S * residual));
+                    if(curDistance < maximumMahalanobisDistance) {
+                        all.push_back(MatchDistancePair(MatchPair(i, j), curDistance));
+                    }
+                }
+            }
+        }
     public:
-        RectTracker()
-        :smoothingRate(.5) {
+        BasicRectTracker()
+        :smoothingRate(.5)
+        ,motionPrediction(false)
+        ,maximumMahalanobisDistance(3)
+        ,processNoise(1)
+        ,measurementNoise(16) {
         }
         void setSmoothingRate(float smoothingRate) {
             this->smoothingRate = smoothingRate;
@@ -292,18 +498,58 @@ namespace ofxDLib {
         float getSmoothingRate() const {
             return smoothingRate;
         }
+        // match against kalman predicted positions instead of the last seen ones,
+        // gated by maximumMahalanobisDistance instead of maximumDistance
+        void setMotionPrediction(bool motionPrediction) {
+            this->motionPrediction = motionPrediction;
+            if(!motionPrediction) {
+                filters.clear();
+            }
+        }
+        bool getMotionPrediction() const {
+            return motionPrediction;
+        }
+        void setMaximumMahalanobisDistance(float maximumMahalanobisDistance) {
+            this->maximumMahalanobisDistance = maximumMahalanobisDistance;
+        }
+        // variances in pixels^2 per frame, only take effect on new tracks
+        void setProcessNoise(float processNoise) {
+            this->processNoise = processNoise;
+        }
+        void setMeasurementNoise(float measurementNoise) {
+            this->measurementNoise = measurementNoise;
+        }
         const std::vector<unsigned int>& track(const std::vector<ofRectangle>& objects) {
-            const std::vector<unsigned int>& labels = Tracker<ofRectangle>::track(objects);
+            const std::vector<unsigned int>& labels = Base::track(objects);
+            // advance the filters, tracks that were not seen this frame only get predicted
+            if(motionPrediction) {
+                for(int i = 0; i < (int)current.size(); i++) {
+                    unsigned int label = current[i].getLabel();
+                    if(filters.count(label) == 0) {
+                        filters[label] = createFilter(current[i].object);
+                    } else if(current[i].getLastSeen() == 0) {
+                        filters[label].update(toMeasurement(current[i].object));
+                    } else {
+                        filters[label].update();
+                    }
+                }
+            }
             // add new objects, update old objects
             for(int i = 0; i < labels.size(); i++) {
                 unsigned int label = labels[i];
-                const ofRectangle& cur = getCurrent(label);
+                const ofRectangle& cur = this->getCurrent(label);
                 if(smoothed.count(label) > 0) {
                     ofRectangle& smooth = smoothed[label];
-                    smooth.x = ofLerp(smooth.x, cur.x, smoothingRate);
-                    smooth.y = ofLerp(smooth.y, cur.y, smoothingRate);
                     smooth.width = ofLerp(smooth.width, cur.width, smoothingRate);
                     smooth.height = ofLerp(smooth.height, cur.height, smoothingRate);
+                    if(motionPrediction) {
+                        const dlib::matrix<double, 4, 1>& state = filters[label].get_current_state();
+                        smooth.x = state(0) - smooth.width / 2;
+                        smooth.y = state(1) - smooth.height / 2;
+                    } else {
+                        smooth.x = ofLerp(smooth.x, cur.x, smoothingRate);
+                        smooth.y = ofLerp(smooth.y, cur.y, smoothingRate);
+                    }
                 } else {
                     smoothed[label] = cur;
                 }
@@ -311,22 +557,63 @@ namespace ofxDLib {
             std::map<unsigned int, ofRectangle>::iterator smoothedItr = smoothed.begin();
             while(smoothedItr != smoothed.end()) {
                 unsigned int label = smoothedItr->first;
-                if(!existsCurrent(label)) {
+                if(!this->existsCurrent(label)) {
                     smoothed.erase(smoothedItr++);
                 } else {
                     ++smoothedItr;
                 }
             }
+            std::map<unsigned int, MotionFilter>::iterator filterItr = filters.begin();
+            while(filterItr != filters.end()) {
+                unsigned int label = filterItr->first;
+                if(!this->existsCurrent(label)) {
+                    filters.erase(filterItr++);
+                } else {
+                    ++filterItr;
+                }
+            }
             return labels;
         }
         const ofRectangle& getSmoothed(unsigned int label) const {
             return smoothed.find(label)->second;
         }
+        
+        friend void serialize(const BasicRectTracker& item, std::ostream& out) {
+            int version = 1;
+            dlib::serialize(version, out);
+            serialize(static_cast<const Base&>(item), out);
+            dlib::serialize(item.smoothingRate, out);
+            dlib::serialize(item.motionPrediction, out);
+            dlib::serialize(item.maximumMahalanobisDistance, out);
+            dlib::serialize(item.processNoise, out);
+            dlib::serialize(item.measurementNoise, out);
+            dlib::serialize(item.smoothed, out);
+            dlib::serialize(item.filters, out);
+        }
+        friend void deserialize(BasicRectTracker& item, std::istream& in) {
+            int version = 0;
+            dlib::deserialize(version, in);
+            if(version != 1) {
+                throw dlib::serialization_error("Unexpected version found while deserializing ofxDLib::RectTracker.");
+            }
+            deserialize(static_cast<Base&>(item), in);
+            dlib::deserialize(item.smoothingRate, in);
+            dlib::deserialize(item.motionPrediction, in);
+            dlib::deserialize(item.maximumMahalanobisDistance, in);
+            dlib::deserialize(item.processNoise, in);
+            dlib::deserialize(item.measurementNoise, in);
+            dlib::deserialize(item.smoothed, in);
+            dlib::deserialize(item.filters, in);
+        }
        ofVec2f getVelocity(unsigned int i) const {
-            unsigned int label = getLabelFromIndex(i);
-            if(existsPrevious(label)) {
-                const ofRectangle& previous = getPrevious(label);
-                const ofRectangle& current = getCurrent(label);
+            unsigned int label = this->getLabelFromIndex(i);
+            std::map<unsigned int, MotionFilter>::const_iterator filterItr = filters.find(label);
+            if(filterItr != filters.end()) {
+                const dlib::matrix<double, 4, 1>& state = filterItr->second.get_current_state();
+                return ofVec2f(state(2), state(3));
+            } else if(this->existsPrevious(label)) {
+                const ofRectangle& previous = this->getPrevious(label);
+                const ofRectangle& current = this->getCurrent(label);
                 ofVec2f previousPosition(previous.x + previous.width / 2, previous.y + previous.height / 2);
                 ofVec2f currentPosition(current.x + current.width / 2, current.y + current.height / 2);
                 return currentPosition - previousPosition;
@@ -336,6 +623,8 @@ namespace ofxDLib {
         }
     };
     
+    typedef BasicRectTracker<> RectTracker;
+    
     typedef Tracker<ofVec2f> PointTracker;
     
     template <class T>
@@ -354,6 +643,10 @@ namespace ofxDLib {
         virtual void kill() {
             dead = true;
         }
+        // used by TrackerFollower when a dead follower is reused for a new label
+        void revive() {
+            dead = false;
+        }
         
         void setLabel(unsigned int label) {
             this->label = label;
@@ -369,46 +662,72 @@ namespace ofxDLib {
     typedef Follower<ofRectangle> RectFollower;
     typedef Follower<ofVec2f> PointFollower;
     
-    template <class T, class F>
-    class TrackerFollower : public Tracker<T> {
+    // followers are kept packed in getFollowers(), a dead one is swapped with the last
+    // and parked in a pool. New labels reuse parked followers, so setup() has to reset
+    // all per-track state while heavy members like images keep their allocations.
+    template <class T, class F, class D = TrackingDistance>
+    class TrackerFollower : public Tracker<T, D> {
     protected:
         std::vector<unsigned int> labels;
-        std::vector<F> followers;
+        std::vector<F> followers, recycled;
+        std::map<unsigned int, unsigned int> indexFromLabel;
     public:
         const std::vector<unsigned int>& track(const std::vector<T>& objects) {
-            Tracker<T>::track(objects);
+            Tracker<T, D>::track(objects);
             // kill missing, update old
             for(int i = 0; i < labels.size(); i++) {
                 unsigned int curLabel = labels[i];
                 F& curFollower = followers[i];
-                if(!Tracker<T>::existsCurrent(curLabel)) {
+                if(!Tracker<T, D>::existsCurrent(curLabel)) {
                     curFollower.kill();
                 } else {
-                    curFollower.update(Tracker<T>::getCurrent(curLabel));
+                    curFollower.update(Tracker<T, D>::getCurrent(curLabel));
                 }
             }
-            // add new
-            for(int i = 0; i < Tracker<T>::newLabels.size(); i++) {
-                unsigned int curLabel = Tracker<T>::newLabels[i];
-                labels.push_back(curLabel);
-                followers.push_back(F());
-                followers.back().setup(Tracker<T>::getCurrent(curLabel));
-                followers.back().setLabel(curLabel);
-            }
-            // remove dead
+            // remove dead, the last follower takes its place
             for(int i = labels.size() - 1; i >= 0; i--) {
                 if(followers[i].getDead()) {
-                    followers.erase(followers.begin() + i);
-                    labels.erase(labels.begin() + i);
+                    indexFromLabel.erase(labels[i]);
+                    int last = labels.size() - 1;
+                    if(i != last) {
+                        std::swap(followers[i], followers[last]);
+                        labels[i] = labels[last];
+                        indexFromLabel[labels[i]] = i;
+                    }
+                    recycled.push_back(std::move(followers.back()));
+                    followers.pop_back();
+                    labels.pop_back();
                 }
             }
+            // add new, reusing dead followers first
+            for(int i = 0; i < Tracker<T, D>::newLabels.size(); i++) {
+                unsigned int curLabel = Tracker<T, D>::newLabels[i];
+                indexFromLabel[curLabel] = labels.size();
+                labels.push_back(curLabel);
+                // only construct a follower when there is none to reuse
+                if(recycled.empty()) {
+                    followers.push_back(F());
+                } else {
+                    followers.push_back(std::move(recycled.back()));
+                    recycled.pop_back();
+                    followers.back().revive();
+                }
+                followers.back().setup(Tracker<T, D>::getCurrent(curLabel));
+                followers.back().setLabel(curLabel);
+            }
             return labels;
         }
         std::vector<F>& getFollowers() {
             return followers;
         }
+        bool existsFollower(unsigned int label) const {
+            return indexFromLabel.count(label) > 0;
+        }
+        F& getFollower(unsigned int label) {
+            return followers[indexFromLabel.find(label)->second];
+        }
     };
     
-    template <class F> class RectTrackerFollower : public TrackerFollower<ofRectangle, F> {};
-    template <class F> class PointTrackerFollower : public TrackerFollower<ofVec2f, F> {};
+    template <class F, class D = TrackingDistance> class RectTrackerFollower : public TrackerFollower<ofRectangle, F, D> {};
+    template <class F, class D = TrackingDistance> class PointTrackerFollower : public TrackerFollower<ofVec2f, F, D> {};
 }
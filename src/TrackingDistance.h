@@ -0,0 +1,220 @@
+//
+//  TrackingDistance.h
+//  distance policies used by Tracker to match objects between frames
+//
+//  a policy is a default constructible functor float(const T& a, const T& b),
+//  smaller is closer. Tracker fills its distance matrix through
+//  trackingDistances(), which calls the policy once per pair so it gets
+//  inlined, and is overloaded for the rectangle policies to fill whole rows
+//  in vectorisable loops. Objects further apart than
+//  Tracker::setMaximumDistance() are never matched, so that threshold is in
+//  the units of the policy. Tracker starts out with the policy's
+//  defaultMaximumDistance(), 64 pixels unless it is overloaded for the policy.
+//
+
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "ofRectangle.h"
+#include "ofVec2f.h"
+#include "ofVec3f.h"
+
+namespace ofxDLib {
+    inline float trackingDistance(const ofRectangle& a, const ofRectangle& b) {
+        ofVec3f centerA = a.getCenter();
+        ofVec3f centerB = b.getCenter();
+        return centerA.distance(centerB);
+    }
+    
+    inline float trackingDistance(const ofVec2f& a, const ofVec2f& b) {
+        return a.distance(b);
+    }
+    
+    // center distance in pixels, overload trackingDistance() next to your own type to track it
+    struct TrackingDistance {
+        template <class T>
+        float operator()(const T& a, const T& b) const {
+            return trackingDistance(a, b);
+        }
+    };
+    
+    // the gate Tracker uses until setMaximumDistance() is called. Overload it next to a
+    // policy whose distances aren't in pixels
+    template <class D>
+    float defaultMaximumDistance(const D&) {
+        return 64;
+    }
+    
+    inline const ofRectangle& trackingRectangle(const ofRectangle& r) {
+        return r;
+    }
+    
+    // 1 - intersection over union, 0 for identical and 1 for disjoint rectangles.
+    // Types other than ofRectangle need a trackingRectangle() overload. The default
+    // maximum distance of 0.7 matches rectangles that overlap with an IoU above 0.3.
+    struct IoUDistance {
+        template <class T>
+        float operator()(const T& a, const T& b) const {
+            const ofRectangle& ra = trackingRectangle(a);
+            const ofRectangle& rb = trackingRectangle(b);
+            // branchless, negative sizes are clamped instead of tested
+            float w = std::max(0.f, std::min(ra.x + ra.width, rb.x + rb.width) - std::max(ra.x, rb.x));
+            float h = std::max(0.f, std::min(ra.y + ra.height, rb.y + rb.height) - std::max(ra.y, rb.y));
+            float intersection = w * h;
+            float sum = ra.width * ra.height + rb.width * rb.height;
+            return 1 - intersection / std::max(sum - intersection, 1e-6f);
+        }
+    };
+    
+    // center distance relative to the mean side length of both rectangles,
+    // so one threshold works for small and large objects alike. The default
+    // maximum distance of 1 matches centers less than one side length apart.
+    struct ScaledDistance {
+        template <class T>
+        float operator()(const T& a, const T& b) const {
+            const ofRectangle& ra = trackingRectangle(a);
+            const ofRectangle& rb = trackingRectangle(b);
+            float dx = (ra.x + ra.width / 2) - (rb.x + rb.width / 2);
+            float dy = (ra.y + ra.height / 2) - (rb.y + rb.height / 2);
+            float scale = (ra.width + ra.height + rb.width + rb.height) / 4;
+            return std::sqrt(dx * dx + dy * dy) / std::max(scale, 1e-6f);
+        }
+    };
+    
+    inline float defaultMaximumDistance(const IoUDistance&) {
+        return 0.7f;
+    }
+    
+    inline float defaultMaximumDistance(const ScaledDistance&) {
+        return 1;
+    }
+    
+    // distance matrix between the new objects a and the previous objects b, row major:
+    // out[i * b.size() + j] = distance(a[i], *b[j]). Overload it for your own policy to
+    // compute whole rows at once.
+    template <class D, class T>
+    void trackingDistances(const D& distance, const std::vector<T>& a, const std::vector<const T*>& b, std::vector<float>& out) {
+        size_t n = a.size();
+        size_t m = b.size();
+        out.resize(n * m);
+        for(size_t i = 0; i < n; i++) {
+            for(size_t j = 0; j < m; j++) {
+                out[i * m + j] = distance(a[i], *b[j]);
+            }
+        }
+    }
+    
+    // the previous rectangles transposed into one array per coordinate, so the rows of the
+    // distance matrix are straight loops over floats the compiler can vectorise. The
+    // arithmetic is the same as in the policies, so the results are identical.
+    struct TrackingRectangles {
+        std::vector<float> x, y, width, height;
+        template <class T>
+        void assign(const std::vector<const T*>& objects) {
+            size_t m = objects.size();
+            x.resize(m);
+            y.resize(m);
+            width.resize(m);
+            height.resize(m);
+            for(size_t j = 0; j < m; j++) {
+                const ofRectangle& r = trackingRectangle(*objects[j]);
+                x[j] = r.x;
+                y[j] = r.y;
+                width[j] = r.width;
+                height[j] = r.height;
+            }
+        }
+    };
+    
+    template <class T>
+    void trackingDistances(const IoUDistance&, const std::vector<T>& a, const std::vector<const T*>& b, std::vector<float>& out) {
+        size_t n = a.size();
+        size_t m = b.size();
+        out.resize(n * m);
+        TrackingRectangles rects;
+        rects.assign(b);
+        const float* x = rects.x.data();
+        const float* y = rects.y.data();
+        const float* width = rects.width.data();
+        const float* height = rects.height.data();
+        for(size_t i = 0; i < n; i++) {
+            const ofRectangle& r = trackingRectangle(a[i]);
+            const float x0 = r.x, y0 = r.y, x1 = r.x + r.width, y1 = r.y + r.height, area = r.width * r.height;
+            float* row = out.data() + i * m;
+            for(size_t j = 0; j < m; j++) {
+                // values rather than references into the arrays, so min and max don't branch
+                const float bx = x[j], by = y[j], bw = width[j], bh = height[j];
+                float w = std::max(0.f, std::min(x1, bx + bw) - std::max(x0, bx));
+                float h = std::max(0.f, std::min(y1, by + bh) - std::max(y0, by));
+                float intersection = w * h;
+                float sum = area + bw * bh;
+                row[j] = 1 - intersection / std::max(sum - intersection, 1e-6f);
+            }
+        }
+    }
+    
+    template <class T>
+    void trackingDistances(const ScaledDistance&, const std::vector<T>& a, const std::vector<const T*>& b, std::vector<float>& out) {
+        size_t n = a.size();
+        size_t m = b.size();
+        out.resize(n * m);
+        TrackingRectangles rects;
+        rects.assign(b);
+        const float* x = rects.x.data();
+        const float* y = rects.y.data();
+        const float* width = rects.width.data();
+        const float* height = rects.height.data();
+        for(size_t i = 0; i < n; i++) {
+            const ofRectangle& r = trackingRectangle(a[i]);
+            const float cx = r.x + r.width / 2, cy = r.y + r.height / 2, size = r.width + r.height;
+            float* row = out.data() + i * m;
+            for(size_t j = 0; j < m; j++) {
+                const float bw = width[j], bh = height[j];
+                float dx = cx - (x[j] + bw / 2);
+                float dy = cy - (y[j] + bh / 2);
+                float scale = std::max((size + bw + bh) / 4, 1e-6f);
+                row[j] = std::sqrt(dx * dx + dy * dy) / scale;
+            }
+        }
+    }
+    
+    inline float squaredDifference(float a, float b) {
+        return (a - b) * (a - b);
+    }
+    
+    inline float squaredDifference(const ofVec2f& a, const ofVec2f& b) {
+        return a.squareDistance(b);
+    }
+    
+    inline float squaredDifference(const ofVec3f& a, const ofVec3f& b) {
+        return a.squareDistance(b);
+    }
+    
+    // euclidean distance between appearance descriptors, e.g. HOG features or landmarks.
+    // D is a functor returning a const reference to the descriptor of an object:
+    //
+    //  struct FaceLandmarks {
+    //      const vector<ofVec3f>& operator()(const Face& face) const { return face.landmarks; }
+    //  };
+    //  Tracker<Face, DescriptorDistance<FaceLandmarks> > tracker;
+    //
+    // The scale depends on the descriptor, so set the gate with setMaximumDistance(). The
+    // default of 64 allows n pixel landmarks to move about 64/sqrt(n) pixels each.
+    template <class D>
+    struct DescriptorDistance {
+        D descriptor;
+        template <class T>
+        float operator()(const T& a, const T& b) const {
+            const auto& da = descriptor(a);
+            const auto& db = descriptor(b);
+            size_t n = std::min(da.size(), db.size());
+            float sum = 0;
+            for(size_t i = 0; i < n; i++) {
+                sum += squaredDifference(da[i], db[i]);
+            }
+            return std::sqrt(sum);
+        }
+    };
+}
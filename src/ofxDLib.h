@@ -67,8 +67,40 @@ static void toDLib(const ofPixels& inPix, dlib::array2d<dlib::rgb_pixel>& outPix
         }
     }
 }
-    
-    
+//------------------------------------------------------------------------
+// converts only the part of inPix inside roi, roi is clipped to the pixels and its
+// clipped version is returned so coordinates can be mapped back
+static dlib::rectangle toDLib(const ofPixels& inPix, const dlib::rectangle& roi, dlib::array2d<dlib::rgb_pixel>& outPix){
+
+    int width = inPix.getWidth();
+    int height = inPix.getHeight();
+    dlib::rectangle area = roi.intersect(dlib::rectangle(0, 0, width-1, height-1));
+    outPix.set_size( area.height(), area.width() );
+    int chans = inPix.getNumChannels();
+    const unsigned char* data = inPix.getData();
+    for ( long n = 0; n < outPix.nr(); n++ )
+    {
+        const unsigned char* v =  &data[((n + area.top()) * width + area.left()) * chans];
+        for ( long m = 0; m < outPix.nc(); m++ )
+        {
+            if ( chans==1 )
+            {
+                unsigned char p = v[m];
+                dlib::assign_pixel( outPix[n][m], p );
+            }
+            else{
+                dlib::rgb_pixel p;
+                p.red = v[m*3];
+                p.green = v[m*3+1];
+                p.blue = v[m*3+2];
+                dlib::assign_pixel( outPix[n][m], p );
+            }
+        }
+    }
+    return area;
+}
+
+
 static bool toOf(const dlib::matrix<unsigned char>& inMat, ofPixels& outPix){
         
     int w = inMat.nc();